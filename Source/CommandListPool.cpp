@@ -0,0 +1,25 @@
+#include <CommandListPool.h>
+#include <State.h>
+
+namespace ICR
+{
+    CommandListPool::CommandListPool(D3D12_COMMAND_LIST_TYPE type) : mType(type), mCache(this) {}
+
+    ID3D12GraphicsCommandList* CommandListPool::Acquire() { return mCache.Acquire(gFence->GetCompletedValue()).commandList.Get(); }
+
+    void CommandListPool::Retire(uint64_t fenceValue) { mCache.Retire(fenceValue); }
+
+    uint32_t CommandListPool::GetCommandListCount() const { return mCache.GetCommandListCount(); }
+
+    void CommandListPool::Create(DeviceCommandList& commandList)
+    {
+        ThrowIfFailed(gLogicalDevice->CreateCommandAllocator(mType, IID_PPV_ARGS(&commandList.allocator)));
+        ThrowIfFailed(gLogicalDevice->CreateCommandList(0, mType, commandList.allocator.Get(), nullptr, IID_PPV_ARGS(&commandList.commandList)));
+    }
+
+    void CommandListPool::Reset(DeviceCommandList& commandList)
+    {
+        ThrowIfFailed(commandList.allocator->Reset());
+        ThrowIfFailed(commandList.commandList->Reset(commandList.allocator.Get(), nullptr));
+    }
+} // namespace ICR
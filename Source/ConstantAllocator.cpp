@@ -0,0 +1,111 @@
+#include <ConstantAllocator.h>
+#include <State.h>
+
+namespace ICR
+{
+    namespace
+    {
+        inline uint64_t AlignConstantSize(uint64_t size)
+        {
+            return (size + D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT - 1u) & ~(D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT - 1ull);
+        }
+    } // namespace
+
+    ConstantAllocator::ConstantAllocator(uint32_t frameCount, uint64_t initialPageSize) :
+        mpMappedData(nullptr),
+        mGPUAddress(0u),
+        mPageSize(0u),
+        mPages(std::max(frameCount, 1u), Page { 0u, 0u }),
+        mPageIndex(0u),
+        mStats()
+    {
+        CreateBuffer(initialPageSize);
+    }
+
+    ConstantAllocator::~ConstantAllocator() { ReleaseBuffer(); }
+
+    void ConstantAllocator::CreateBuffer(uint64_t pageSize)
+    {
+        mPageSize = AlignConstantSize(pageSize);
+
+        mBuffer = gResourceRegistry->Create(CD3DX12_RESOURCE_DESC::Buffer(mPageSize * mPages.size()),
+                                            0x0,
+                                            true,
+                                            ResourceRegistry::MemoryCategory::Constants);
+
+        mGPUAddress     = gResourceRegistry->Get(mBuffer)->GetGPUVirtualAddress();
+        mStats.pageSize = mPageSize;
+
+        SetDebugName(gResourceRegistry->Get(mBuffer), L"ConstantAllocator");
+
+        // Write-only from the CPU, mapped for its whole life.
+        D3D12_RANGE readRange = { 0, 0 };
+        ThrowIfFailed(gResourceRegistry->Get(mBuffer)->Map(0, &readRange, reinterpret_cast<void**>(&mpMappedData)));
+    }
+
+    void ConstantAllocator::ReleaseBuffer()
+    {
+        // Deferred by the registry, submissions reading from it may still be in flight. Left mapped: allocations the frame took
+        // before a growth are filled after it, and destroying the resource unmaps it.
+        gResourceRegistry->Release(mBuffer);
+
+        mpMappedData = nullptr;
+    }
+
+    void ConstantAllocator::BeginFrame()
+    {
+        mStats.frameUsedBytes = mPages[mPageIndex].offset;
+
+        mPageIndex = (mPageIndex + 1u) % static_cast<uint32_t>(mPages.size());
+
+        auto& page = mPages[mPageIndex];
+
+        // Without an event the call blocks until the fence reached the value.
+        if (gFence->GetCompletedValue() < page.fenceValue)
+        {
+            ThrowIfFailed(gFence->SetEventOnCompletion(page.fenceValue, nullptr));
+
+            mStats.waitCount++;
+        }
+
+        page.offset = 0u;
+    }
+
+    ConstantAllocator::Allocation ConstantAllocator::Allocate(uint64_t size)
+    {
+        const uint64_t alignedSize = AlignConstantSize(size);
+
+        if (mPages[mPageIndex].offset + alignedSize > mPageSize)
+        {
+            // Grow. Every page starts out empty in the new buffer. Allocations from the old one keep their CPU and GPU addresses,
+            // it stays mapped and alive until the GPU passed the frames reading it.
+            uint64_t pageSize = mPageSize * 2u;
+
+            while (pageSize < alignedSize)
+                pageSize *= 2u;
+
+            ReleaseBuffer();
+            CreateBuffer(pageSize);
+
+            for (auto& page : mPages)
+                page = { 0u, 0u };
+
+            mStats.growCount++;
+
+            spdlog::info("ConstantAllocator: Grew pages to {} KB.", pageSize / 1024u);
+        }
+
+        auto& page = mPages[mPageIndex];
+
+        // The next signal of the frame fence follows any submission that reads this allocation.
+        page.fenceValue = gFenceValue;
+
+        const uint64_t offset = mPageIndex * mPageSize + page.offset;
+
+        page.offset += alignedSize;
+
+        mStats.peakUsedBytes = std::max(mStats.peakUsedBytes, page.offset);
+
+        return { mpMappedData + offset, mGPUAddress + offset };
+    }
+} // namespace ICR
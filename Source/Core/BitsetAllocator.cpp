@@ -0,0 +1,211 @@
+#include <BitsetAllocator.h>
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+namespace ICR
+{
+    static constexpr uint64_t kFullWord = ~0ull;
+
+    static inline uint32_t RoundUpToPages(uint32_t count)
+    {
+        return (count + BitsetAllocator::kPageSize - 1u) / BitsetAllocator::kPageSize * BitsetAllocator::kPageSize;
+    }
+
+    // Mask of count bits starting at bit, which all have to fall into one word.
+    static inline uint64_t GetWordMask(uint32_t bit, uint32_t count) { return (count == 64u ? kFullWord : (1ull << count) - 1u) << bit; }
+
+    BitsetAllocator::BitsetAllocator(uint32_t initialCapacity, uint32_t maxCapacity) :
+        mMaxCapacity(RoundUpToPages(maxCapacity)),
+        mUsedCount(0u),
+        mHighWaterMark(0u),
+        mFirstFreeWord(0u)
+    {
+        if (initialCapacity > maxCapacity)
+            throw std::invalid_argument("BitsetAllocator: Initial capacity exceeds the maximum.");
+
+        mWords.resize(RoundUpToPages(initialCapacity) / kPageSize, 0u);
+    }
+
+    uint32_t BitsetAllocator::FindRange(uint32_t count) const
+    {
+        const uint32_t wordCount = static_cast<uint32_t>(mWords.size());
+
+        if (count == 1u)
+        {
+            for (uint32_t wordIndex = mFirstFreeWord; wordIndex < wordCount; wordIndex++)
+            {
+                if (mWords[wordIndex] != kFullWord)
+                    return wordIndex * kPageSize + static_cast<uint32_t>(std::countr_zero(~mWords[wordIndex]));
+            }
+
+            return kInvalidIndex;
+        }
+
+        uint32_t runStart  = 0u;
+        uint32_t runLength = 0u;
+
+        for (uint32_t wordIndex = mFirstFreeWord; wordIndex < wordCount; wordIndex++)
+        {
+            const uint64_t word = mWords[wordIndex];
+
+            if (word == kFullWord)
+            {
+                runLength = 0u;
+                continue;
+            }
+
+            if (word == 0u)
+            {
+                if (runLength == 0u)
+                    runStart = wordIndex * kPageSize;
+
+                runLength += kPageSize;
+
+                if (runLength >= count)
+                    return runStart;
+
+                continue;
+            }
+
+            for (uint32_t bit = 0u; bit < kPageSize; bit++)
+            {
+                if ((word >> bit) & 1u)
+                {
+                    runLength = 0u;
+                    continue;
+                }
+
+                if (runLength == 0u)
+                    runStart = wordIndex * kPageSize + bit;
+
+                if (++runLength >= count)
+                    return runStart;
+            }
+        }
+
+        return kInvalidIndex;
+    }
+
+    bool BitsetAllocator::Grow(uint32_t minimumCapacity)
+    {
+        const uint32_t capacity = GetCapacity();
+
+        uint32_t grownCapacity = std::max(capacity * 2u, kPageSize);
+
+        while (grownCapacity < minimumCapacity && grownCapacity < mMaxCapacity)
+            grownCapacity *= 2u;
+
+        grownCapacity = std::min(grownCapacity, mMaxCapacity);
+
+        if (grownCapacity <= capacity)
+            return false;
+
+        // New pages start out free, so a free run at the end of the old capacity continues into them.
+        mWords.resize(grownCapacity / kPageSize, 0u);
+
+        return true;
+    }
+
+    void BitsetAllocator::SetRange(uint32_t firstIndex, uint32_t count, bool used)
+    {
+        while (count > 0u)
+        {
+            const uint32_t bit       = firstIndex % kPageSize;
+            const uint32_t wordCount = std::min(kPageSize - bit, count);
+            const uint64_t mask      = GetWordMask(bit, wordCount);
+
+            if (used)
+                mWords[firstIndex / kPageSize] |= mask;
+            else
+                mWords[firstIndex / kPageSize] &= ~mask;
+
+            firstIndex += wordCount;
+            count -= wordCount;
+        }
+    }
+
+    uint32_t BitsetAllocator::Allocate(uint32_t count)
+    {
+        if (count == 0u || count > mMaxCapacity)
+            return kInvalidIndex;
+
+        uint32_t firstIndex = FindRange(count);
+
+        // Grow until it fits, the range may start in the old capacity.
+        while (firstIndex == kInvalidIndex)
+        {
+            if (!Grow(GetCapacity() + count))
+                return kInvalidIndex;
+
+            firstIndex = FindRange(count);
+        }
+
+        SetRange(firstIndex, count, true);
+
+        mUsedCount += count;
+        mHighWaterMark = std::max(mHighWaterMark, mUsedCount);
+
+        while (mFirstFreeWord < mWords.size() && mWords[mFirstFreeWord] == kFullWord)
+            mFirstFreeWord++;
+
+        return firstIndex;
+    }
+
+    void BitsetAllocator::Free(uint32_t firstIndex, uint32_t count)
+    {
+        if (count == 0u || firstIndex >= GetCapacity() || count > GetCapacity() - firstIndex)
+            throw std::runtime_error("BitsetAllocator: Freed indices out of range.");
+
+        // Validate the whole range before touching it.
+        for (uint32_t index = firstIndex, remaining = count; remaining > 0u;)
+        {
+            const uint32_t bit       = index % kPageSize;
+            const uint32_t wordCount = std::min(kPageSize - bit, remaining);
+            const uint64_t mask      = GetWordMask(bit, wordCount);
+
+            if ((mWords[index / kPageSize] & mask) != mask)
+                throw std::runtime_error("BitsetAllocator: Freed indices that are not allocated.");
+
+            index += wordCount;
+            remaining -= wordCount;
+        }
+
+        SetRange(firstIndex, count, false);
+
+        mUsedCount -= count;
+        mFirstFreeWord = std::min(mFirstFreeWord, firstIndex / kPageSize);
+    }
+
+    bool BitsetAllocator::IsAllocated(uint32_t index) const
+    {
+        return index < GetCapacity() && ((mWords[index / kPageSize] >> (index % kPageSize)) & 1u) != 0u;
+    }
+
+    BitsetAllocator::Stats BitsetAllocator::GetStats() const
+    {
+        Stats stats = {};
+        {
+            stats.capacity      = GetCapacity();
+            stats.maxCapacity   = mMaxCapacity;
+            stats.usedCount     = mUsedCount;
+            stats.highWaterMark = mHighWaterMark;
+        }
+
+        uint32_t runLength = 0u;
+
+        for (uint32_t index = 0u; index < stats.capacity; index++)
+        {
+            runLength = IsAllocated(index) ? 0u : runLength + 1u;
+
+            stats.largestFreeRange = std::max(stats.largestFreeRange, runLength);
+        }
+
+        const uint32_t freeCount = stats.capacity - stats.usedCount;
+
+        stats.fragmentation = freeCount > 0u ? 1.0f - static_cast<float>(stats.largestFreeRange) / static_cast<float>(freeCount) : 0.0f;
+
+        return stats;
+    }
+} // namespace ICR
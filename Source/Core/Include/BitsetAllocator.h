@@ -0,0 +1,61 @@
+#ifndef BITSET_ALLOCATOR_H
+#define BITSET_ALLOCATOR_H
+
+#include <cstdint>
+#include <vector>
+
+namespace ICR
+{
+    // Allocator of contiguous index ranges (descriptor tables, single descriptors) tracked by one bit per index. Capacity is
+    // committed in pages of 64 indices, one word of the bitset each, and grows by doubling up to a maximum when nothing fits.
+    // Single indices come from the first word with a clear bit, found through a hint that only moves back on frees, so that
+    // they are O(1) amortized. Ranges skip full and empty words at once. Not thread-safe.
+    class BitsetAllocator
+    {
+    public:
+
+        static constexpr uint32_t kInvalidIndex = UINT32_MAX;
+        static constexpr uint32_t kPageSize     = 64u;
+
+        struct Stats
+        {
+            uint32_t capacity;         // Committed, a multiple of the page size.
+            uint32_t maxCapacity;
+            uint32_t usedCount;
+            uint32_t highWaterMark;    // Most indices in use at once.
+            uint32_t largestFreeRange; // Within the committed capacity.
+            float    fragmentation;    // 1 - largest free range / free indices, zero when the free space is one range.
+        };
+
+        // Capacities are rounded up to whole pages, throws std::invalid_argument if the initial one exceeds the maximum.
+        BitsetAllocator(uint32_t initialCapacity, uint32_t maxCapacity);
+
+        // Returns the first index of count contiguous free indices, or kInvalidIndex when they do not fit the maximum capacity.
+        uint32_t Allocate(uint32_t count = 1u);
+
+        // Throws std::runtime_error if any of the indices is out of range or not allocated.
+        void Free(uint32_t firstIndex, uint32_t count = 1u);
+
+        bool IsAllocated(uint32_t index) const;
+
+        inline uint32_t GetCapacity() const { return static_cast<uint32_t>(mWords.size()) * kPageSize; }
+        inline uint32_t GetUsedCount() const { return mUsedCount; }
+
+        // Scans the bitset for the free range stats.
+        Stats GetStats() const;
+
+    private:
+
+        uint32_t FindRange(uint32_t count) const;
+        bool     Grow(uint32_t minimumCapacity);
+        void     SetRange(uint32_t firstIndex, uint32_t count, bool used);
+
+        std::vector<uint64_t> mWords; // Set bits are allocated.
+        uint32_t              mMaxCapacity;
+        uint32_t              mUsedCount;
+        uint32_t              mHighWaterMark;
+        uint32_t              mFirstFreeWord; // No clear bit in the words before.
+    };
+} // namespace ICR
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef RENDER_GRAPH_COMPILER_H
+#define RENDER_GRAPH_COMPILER_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace ICR
+{
+    // Device-independent resource states, the renderer maps these to D3D12_RESOURCE_STATES.
+    enum class ResourceState : uint8_t
+    {
+        Common,
+        RenderTarget,
+        ShaderResource
+    };
+
+    struct ResourceBarrier
+    {
+        enum class Split : uint8_t
+        {
+            None,
+            Begin,
+            End
+        };
+
+        uint32_t      resource;
+        ResourceState before;
+        ResourceState after;
+        Split         split;
+
+        bool operator==(const ResourceBarrier&) const = default;
+    };
+
+    // Plans the resource barriers for a frame of render graph levels. Resources are plain IDs and the compiler never
+    // touches a device, so the emitted barrier lists can be checked on the CPU. States are tracked across frames.
+    class RenderGraphCompiler
+    {
+    public:
+
+        struct PassAccess
+        {
+            std::vector<uint32_t> reads;
+            std::vector<uint32_t> writes;
+        };
+
+        struct Plan
+        {
+            // Barriers to record ahead of each level, in level order.
+            std::vector<std::vector<ResourceBarrier>> levelBarriers;
+
+            // Barriers to record after the last level, ahead of the exit reads.
+            std::vector<ResourceBarrier> exitBarriers;
+
+            // Aliased resources taking over their memory in each level (at their first use in the frame). They need an aliasing
+            // barrier ahead of the level's transitions, and start out with undefined contents.
+            std::vector<std::vector<uint32_t>> levelActivations;
+        };
+
+        // Registers a resource (or overrides its tracked state, e.g. after it was re-created).
+        void SetState(uint32_t resource, ResourceState state);
+
+        // Resources that were never registered are assumed to be in the common state.
+        ResourceState GetState(uint32_t resource) const;
+
+        // Aliased resources share memory with others that may be live in between their uses, so their transitions are
+        // never split across levels, and they are activated every frame.
+        void SetAliased(uint32_t resource);
+
+        void Reset();
+
+        // Plans one frame: levels in execution order (passes within a level must be independent), followed by exitReads
+        // that are sampled after the graph. Transitions with at least one idle level in between are split, everything
+        // else is batched ahead of the level that needs it.
+        Plan Compile(const std::vector<std::vector<PassAccess>>& levels, const std::vector<uint32_t>& exitReads);
+
+    private:
+
+        std::unordered_map<uint32_t, ResourceState> mStates;
+        std::unordered_set<uint32_t>                mAliased;
+    };
+} // namespace ICR
+
+#endif
@@ -0,0 +1,196 @@
+#ifndef RENDER_GRAPH_RECORDER_H
+#define RENDER_GRAPH_RECORDER_H
+
+#include <RenderGraphCompiler.h>
+
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace ICR
+{
+    // Device side of a command list cache: creates command lists (with whatever they record from) and resets them once the
+    // GPU is done with their previous recording. Called from the recording threads.
+    template <typename CommandList>
+    class CommandListFactory
+    {
+    public:
+
+        virtual ~CommandListFactory() = default;
+
+        // Creates an open command list.
+        virtual void Create(CommandList& commandList) = 0;
+
+        // Reopens a command list whose previous recording the GPU finished.
+        virtual void Reset(CommandList& commandList) = 0;
+    };
+
+    // Hands out open command lists to worker threads. Each thread records into lists of its own, so parallel recording never
+    // shares one, and a list is only reset once the GPU passed the fence value it was retired with.
+    template <typename CommandList>
+    class CommandListCache
+    {
+    public:
+
+        explicit CommandListCache(CommandListFactory<CommandList>* pFactory) : mpFactory(pFactory) {}
+
+        // Returns an open command list owned by the calling thread, stays valid as long as the cache.
+        CommandList& Acquire(uint64_t completedFenceValue);
+
+        // Marks every list acquired since the last call as in flight until fenceValue is signaled.
+        // Call once the lists are submitted and no thread is recording.
+        void Retire(uint64_t fenceValue);
+
+        uint32_t GetCommandListCount() const;
+
+    private:
+
+        static constexpr uint64_t kRecording = UINT64_MAX;
+
+        struct Entry
+        {
+            CommandList commandList;
+            uint64_t    fenceValue;
+        };
+
+        CommandListFactory<CommandList>*                   mpFactory;
+        tbb::enumerable_thread_specific<std::deque<Entry>> mThreadEntries;
+    };
+
+    // Device side of recording render graph levels, called from several threads at once with the command list of the level.
+    template <typename CommandList>
+    class LevelRecorder
+    {
+    public:
+
+        virtual ~LevelRecorder() = default;
+
+        // State every list needs before recording anything (viewport, descriptor heaps, root signature).
+        virtual void Begin(CommandList& commandList) = 0;
+
+        // Aliasing barriers of resources taking over their memory in the level.
+        virtual void RecordAliasing(CommandList& commandList, const std::vector<uint32_t>& resources) = 0;
+
+        virtual void RecordBarriers(CommandList& commandList, const std::vector<ResourceBarrier>& barriers) = 0;
+
+        // Activated resources start out with undefined contents, discarded after their transitions.
+        virtual void RecordDiscards(CommandList& commandList, const std::vector<uint32_t>& resources) = 0;
+
+        virtual void RecordPasses(CommandList& commandList, size_t levelIndex) = 0;
+
+        virtual void End(CommandList& commandList) = 0;
+    };
+
+    // Records each level into its own command list in parallel, the passes of a level are independent. The plan may lead with
+    // levelOffset levels recorded elsewhere (e.g. clears), the exit barriers follow the last level if requested. Returns the
+    // lists in level order.
+    template <typename CommandList>
+    std::vector<CommandList*> RecordLevels(CommandListCache<CommandList>&   cache,
+                                           LevelRecorder<CommandList>&      recorder,
+                                           const RenderGraphCompiler::Plan& plan,
+                                           size_t                           levelOffset,
+                                           size_t                           levelCount,
+                                           bool                             recordExitBarriers,
+                                           uint64_t                         completedFenceValue);
+
+    // Implementation
+    // -------------------------------------------------
+
+    template <typename CommandList>
+    CommandList& CommandListCache<CommandList>::Acquire(uint64_t completedFenceValue)
+    {
+        auto& entries = mThreadEntries.local();
+
+        for (auto& entry : entries)
+        {
+            if (entry.fenceValue == kRecording || entry.fenceValue > completedFenceValue)
+                continue;
+
+            mpFactory->Reset(entry.commandList);
+
+            entry.fenceValue = kRecording;
+
+            return entry.commandList;
+        }
+
+        // Everything this thread owns is still in use, grow the cache.
+        auto& entry      = entries.emplace_back();
+        entry.fenceValue = kRecording;
+
+        mpFactory->Create(entry.commandList);
+
+        return entry.commandList;
+    }
+
+    template <typename CommandList>
+    void CommandListCache<CommandList>::Retire(uint64_t fenceValue)
+    {
+        for (auto& entries : mThreadEntries)
+        {
+            for (auto& entry : entries)
+            {
+                if (entry.fenceValue == kRecording)
+                    entry.fenceValue = fenceValue;
+            }
+        }
+    }
+
+    template <typename CommandList>
+    uint32_t CommandListCache<CommandList>::GetCommandListCount() const
+    {
+        uint32_t commandListCount = 0u;
+
+        for (const auto& entries : mThreadEntries)
+            commandListCount += static_cast<uint32_t>(entries.size());
+
+        return commandListCount;
+    }
+
+    template <typename CommandList>
+    std::vector<CommandList*> RecordLevels(CommandListCache<CommandList>&   cache,
+                                           LevelRecorder<CommandList>&      recorder,
+                                           const RenderGraphCompiler::Plan& plan,
+                                           size_t                           levelOffset,
+                                           size_t                           levelCount,
+                                           bool                             recordExitBarriers,
+                                           uint64_t                         completedFenceValue)
+    {
+        std::vector<CommandList*> levelCommandLists(levelCount);
+
+        tbb::parallel_for(size_t(0),
+                          levelCount,
+                          [&](size_t levelIndex)
+                          {
+                              auto& commandList = cache.Acquire(completedFenceValue);
+
+                              recorder.Begin(commandList);
+
+                              const auto& activations = plan.levelActivations[levelOffset + levelIndex];
+
+                              if (!activations.empty())
+                                  recorder.RecordAliasing(commandList, activations);
+
+                              if (!plan.levelBarriers[levelOffset + levelIndex].empty())
+                                  recorder.RecordBarriers(commandList, plan.levelBarriers[levelOffset + levelIndex]);
+
+                              if (!activations.empty())
+                                  recorder.RecordDiscards(commandList, activations);
+
+                              recorder.RecordPasses(commandList, levelIndex);
+
+                              if (recordExitBarriers && levelIndex == levelCount - 1 && !plan.exitBarriers.empty())
+                                  recorder.RecordBarriers(commandList, plan.exitBarriers);
+
+                              recorder.End(commandList);
+
+                              levelCommandLists[levelIndex] = &commandList;
+                          });
+
+        return levelCommandLists;
+    }
+} // namespace ICR
+
+#endif
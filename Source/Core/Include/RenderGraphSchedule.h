@@ -0,0 +1,73 @@
+#ifndef RENDER_GRAPH_SCHEDULE_H
+#define RENDER_GRAPH_SCHEDULE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ICR
+{
+    // A pass writes a single output and samples up to four inputs. Inputs that are not the output of another pass
+    // (media, video, ...) are ignored by the schedule.
+    struct PassDeclaration
+    {
+        int              outputID;
+        std::vector<int> inputIDs;
+        bool             final = false; // Executes last, and its output is read after the graph (presented).
+    };
+
+    // Execution schedule of a graph of pass declarations. Passes run in declaration order with the final pass last, so
+    // an input produced earlier in that order is a dependency within the frame, while self-references and outputs read
+    // before they are written sample the previous frame (history). Passes whose output never reaches the final pass, in
+    // this frame or a later one, are culled: they are left out of the levels and have no lifetime.
+    class RenderGraphSchedule
+    {
+    public:
+
+        struct Lifetime
+        {
+            bool   history;    // Read across frames, needs to be double-buffered and outlive the frame.
+            size_t firstLevel; // Level writing the output.
+            size_t lastLevel;  // Last level reading it within the frame, levels.size() for the final output.
+        };
+
+        // Throws std::runtime_error for duplicate outputs or more than one final pass.
+        RenderGraphSchedule(const std::vector<PassDeclaration>& passes);
+
+        // Passes grouped into levels: every pass only depends on passes in earlier levels. Indices into the declarations.
+        inline const std::vector<std::vector<size_t>>& GetLevels() const { return mLevels; }
+
+        // Passes that are not executed, in declaration order. Nothing is culled without a final pass.
+        inline const std::vector<size_t>& GetCulledPasses() const { return mCulledPasses; }
+
+        // Per pass, the inputs it samples from the previous frame.
+        inline const std::vector<std::vector<int>>& GetHistoryInputIDs() const { return mHistoryInputIDs; }
+
+        // Per pass, the lifetime of its output (undefined for culled passes).
+        inline const std::vector<Lifetime>& GetLifetimes() const { return mLifetimes; }
+
+        bool IsHistoryInput(size_t passIndex, int inputID) const;
+        bool IsCulled(size_t passIndex) const;
+
+    private:
+
+        std::vector<std::vector<size_t>> mLevels;
+        std::vector<std::vector<int>>    mHistoryInputIDs;
+        std::vector<Lifetime>            mLifetimes;
+        std::vector<size_t>              mCulledPasses;
+    };
+
+    struct TransientAllocation
+    {
+        uint64_t size;
+        size_t   firstLevel;
+        size_t   lastLevel;
+        uint64_t heapOffset; // Output of PlaceTransientAllocations.
+    };
+
+    // Places allocations into a shared heap so that allocations alive in the same level never overlap in memory.
+    // Largest first, each at the lowest aligned offset that fits (alignment must be a power of two). Returns the heap size.
+    uint64_t PlaceTransientAllocations(std::vector<TransientAllocation>& allocations, uint64_t alignment);
+} // namespace ICR
+
+#endif
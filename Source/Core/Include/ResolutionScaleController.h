@@ -0,0 +1,41 @@
+#ifndef RESOLUTION_SCALE_CONTROLLER_H
+#define RESOLUTION_SCALE_CONTROLLER_H
+
+namespace ICR
+{
+    // PI controller steering the internal resolution scale (per axis) towards a target frame time. The error is normalized by the
+    // target, so the gains do not depend on it. The integral carries the steady-state scale and is clamped to the scale range,
+    // so that it does not wind up while the scale is saturated (e.g. a cheap shader already at full resolution).
+    class ResolutionScaleController
+    {
+    public:
+
+        struct Params
+        {
+            double targetFrameTime;
+            double proportionalGain;
+            double integralGain; // Per second.
+            double minScale;
+            double maxScale;
+        };
+
+        ResolutionScaleController(const Params& params);
+
+        // Feeds the measured frame time (same unit as the target) after a frame that took deltaTime seconds, returns the new scale.
+        double Update(double frameTime, double deltaTime);
+
+        void Reset(double scale);
+
+        inline void          SetParams(const Params& params) { mParams = params; }
+        inline const Params& GetParams() const { return mParams; }
+        inline double        GetScale() const { return mScale; }
+
+    private:
+
+        Params mParams;
+        double mIntegral;
+        double mScale;
+    };
+} // namespace ICR
+
+#endif
@@ -0,0 +1,515 @@
+#ifndef RESOURCE_TABLE_H
+#define RESOURCE_TABLE_H
+
+#include <SlotAllocator.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ICR
+{
+    // indexResource is a generational slot handle (see SlotAllocator): unique among live resources, and rejected by the
+    // table once the resource is released.
+    struct ResourceHandle
+    {
+        uint32_t indexResource               = UINT32_MAX;
+        uint32_t indexDescriptorTexture2D    = UINT32_MAX;
+        uint32_t indexDescriptorRenderTarget = UINT32_MAX;
+        uint32_t indexDescriptorConstants    = UINT32_MAX;
+        uint32_t indexDescriptorRawBuffer    = UINT32_MAX;
+    };
+
+    // Descriptor views a resource can be created with, one descriptor each. Requested as a mask of 1 << view.
+    enum class ResourceView : uint32_t
+    {
+        Texture2D,
+        RenderTarget,
+        Constants,
+        Count
+    };
+
+    static constexpr size_t kResourceViewCount = static_cast<size_t>(ResourceView::Count);
+
+    // What memory is spent on. Every resource and render target heap is tagged with one, the accounting follows the memory
+    // until it is destroyed (so deferred releases still count).
+    enum class MemoryCategory
+    {
+        Other,
+        PassOutputs, // Transient heaps and single-buffered outputs.
+        History,     // Double-buffered outputs read across frames.
+        Media,
+        Staging,     // Upload and readback buffers.
+        Constants,
+        SwapChain,
+        Count
+    };
+
+    static constexpr size_t kMemoryCategoryCount = static_cast<size_t>(MemoryCategory::Count);
+
+    struct MemoryCategoryStats
+    {
+        uint32_t count;
+        uint64_t bytes;
+        uint64_t peakBytes;
+    };
+
+    // Device side of a resource table. The owner creates the device objects and hands them to the table, which calls back to
+    // give them descriptor views and to destroy them once nothing references them anymore. Called from any thread.
+    template <typename Resource>
+    class ResourceFactory
+    {
+    public:
+
+        virtual ~ResourceFactory() = default;
+
+        // Allocates a descriptor in the heap of the view, writes the view of the resource into it and returns its index.
+        virtual uint32_t CreateView(const Resource& resource, ResourceView view) = 0;
+
+        // Frees descriptors of views (heapType 1 << view) and of tables released through the table (heapType as passed there).
+        virtual void FreeDescriptors(uint32_t heapType, uint32_t firstIndex, uint32_t count) = 0;
+
+        virtual void Destroy(Resource& resource) = 0;
+    };
+
+    // Device-independent bookkeeping of the resource registry, so that it runs without a device: generational handles over
+    // structure-of-arrays slots, the descriptor views of every resource, memory accounting per category, and destruction
+    // deferred until the GPU passed every frame that may still reference a resource. Creation and release are thread-safe.
+    // Slots are allocated lock-free and the per-slot storage is preallocated, so a thread only ever writes the slots it owns.
+    template <typename Resource>
+    class ResourceTable
+    {
+    public:
+
+        struct DeferredReleaseStats
+        {
+            uint32_t pendingCount;
+            uint64_t pendingBytes;
+            uint64_t reclaimedCount;
+            uint64_t reclaimedBytes;
+        };
+
+        struct MemoryStats
+        {
+            std::array<MemoryCategoryStats, kMemoryCategoryCount> categories;
+            uint64_t                                              trackedBytes;
+            uint64_t                                              peakTrackedBytes;
+        };
+
+        ResourceTable(uint32_t capacity, ResourceFactory<Resource>* pFactory);
+
+        // Takes over the resource, creates the views in viewMask (bits 1 << ResourceView) and accounts size bytes to the
+        // category. Throws std::runtime_error when every slot is taken.
+        ResourceHandle Add(Resource&& resource, uint32_t viewMask, MemoryCategory category, uint64_t size);
+
+        // Throws std::runtime_error for invalid handles, and for stale ones whose resource was released.
+        inline const Resource& Get(const ResourceHandle& handle) const { return mResources[GetSlot(handle)]; }
+        inline uint64_t        GetMemorySize(const ResourceHandle& handle) const { return mMemorySizes[GetSlot(handle)]; }
+
+        inline uint32_t GetLiveCount() const { return mSlots.GetLiveCount(); }
+
+        // Retires the handle right away, but defers destroying the resource and its descriptors until the GPU is done with
+        // every frame that may still reference it (see ProcessDeferredReleases).
+        void Release(const ResourceHandle& handle);
+
+        // Destroys the resource right away, for when the caller waited for the device.
+        void ReleaseImmediate(const ResourceHandle& handle);
+
+        // For device objects without a handle (e.g. heaps that resources are placed into): their memory is accounted from
+        // creation on, and they are released like the resources of handles.
+        void TrackMemory(MemoryCategory category, uint64_t size);
+        void Release(Resource&& resource, MemoryCategory category, uint64_t size);
+
+        // Defers freeing a descriptor table like the views of a released resource.
+        void ReleaseDescriptorTable(uint32_t heapType, uint32_t firstIndex, uint32_t count);
+
+        // Called by the render thread after every fence wait: destroys the deferred releases whose fence value completed, and
+        // tags the ones released since the last call with nextFenceValue, the next value signaled after any work that could
+        // still reference them.
+        void ProcessDeferredReleases(uint64_t completedFenceValue, uint64_t nextFenceValue);
+
+        // Destroys every deferred release, the device must be idle.
+        inline void FlushDeferredReleases() { ProcessDeferredReleases(kUntagged, kUntagged); }
+
+        DeferredReleaseStats GetDeferredReleaseStats();
+
+        MemoryStats GetMemoryStats();
+
+        // Moves the memory of a resource to another category, for resources that change hands (e.g. pooled render targets).
+        void SetMemoryCategory(const ResourceHandle& handle, MemoryCategory category);
+
+        // Attributes the peak of the tracked memory to a scope (e.g. the shader being rendered) from now on, until the next call.
+        void SetMemoryScope(const std::string& scope);
+
+        std::unordered_map<std::string, uint64_t> GetMemoryScopePeaks();
+
+        // Calls function(resource, category, size) for every live resource. Nothing may be added or released meanwhile.
+        template <typename Function>
+        void ForEachLive(Function&& function) const
+        {
+            for (uint32_t slot = 0u; slot < mSlots.GetCapacity(); slot++)
+            {
+                if (mLive[slot])
+                    function(mResources[slot], mMemoryCategories[slot], mMemorySizes[slot]);
+            }
+        }
+
+    private:
+
+        // Not yet tagged with a fence value.
+        static constexpr uint64_t kUntagged = UINT64_MAX;
+
+        struct DeferredRelease
+        {
+            uint64_t                                 fenceValue;
+            bool                                     hasResource; // Descriptor table releases carry no resource (and no memory).
+            Resource                                 resource;
+            std::array<uint32_t, kResourceViewCount> descriptors;
+            uint32_t                                 descriptorTableHeapType;
+            uint32_t                                 descriptorTable;
+            uint32_t                                 descriptorTableSize;
+            MemoryCategory                           memoryCategory;
+            uint64_t                                 memorySize;
+        };
+
+        static inline uint32_t& GetDescriptorIndex(ResourceHandle& handle, ResourceView view)
+        {
+            switch (view)
+            {
+                case ResourceView::Texture2D   : return handle.indexDescriptorTexture2D;
+                case ResourceView::RenderTarget: return handle.indexDescriptorRenderTarget;
+                default                        : return handle.indexDescriptorConstants;
+            }
+        }
+
+        inline uint32_t GetSlot(const ResourceHandle& handle) const
+        {
+            if (!mSlots.IsValid(handle.indexResource))
+                throw std::runtime_error("ResourceTable: Stale or invalid resource handle.");
+
+            return SlotAllocator::GetIndex(handle.indexResource);
+        }
+
+        DeferredRelease CreateDeferredRelease() const;
+
+        // Moves the slot's storage out and retires its handle.
+        DeferredRelease DetachSlot(const ResourceHandle& handle);
+
+        void Destroy(DeferredRelease& deferredRelease);
+        void UntrackMemory(MemoryCategory category, uint64_t size);
+
+        ResourceFactory<Resource>* mpFactory;
+        SlotAllocator              mSlots;
+
+        // Structure of arrays indexed by slot, sized once to the capacity.
+        std::vector<Resource>                                  mResources;
+        std::array<std::vector<uint32_t>, kResourceViewCount> mDescriptors;
+        std::vector<MemoryCategory>                            mMemoryCategories;
+        std::vector<uint64_t>                                  mMemorySizes;
+        std::vector<uint8_t>                                   mLive;
+
+        // Ordered by fence value, with the untagged releases at the back.
+        std::mutex                  mDeferredReleasesMutex;
+        std::deque<DeferredRelease> mDeferredReleases;
+        uint64_t                    mReclaimedCount;
+        uint64_t                    mReclaimedBytes;
+
+        std::mutex                                            mMemoryMutex;
+        std::array<MemoryCategoryStats, kMemoryCategoryCount> mMemoryCategoryStats;
+        uint64_t                                              mTrackedBytes;
+        uint64_t                                              mPeakTrackedBytes;
+        uint64_t*                                             mpMemoryScopePeak; // Entry of the current scope, nullptr without one.
+        std::unordered_map<std::string, uint64_t>             mMemoryScopePeaks;
+    };
+
+    // Implementation
+    // -------------------------------------------------
+
+    template <typename Resource>
+    ResourceTable<Resource>::ResourceTable(uint32_t capacity, ResourceFactory<Resource>* pFactory) :
+        mpFactory(pFactory),
+        mSlots(capacity),
+        mReclaimedCount(0u),
+        mReclaimedBytes(0u),
+        mMemoryCategoryStats(),
+        mTrackedBytes(0u),
+        mPeakTrackedBytes(0u),
+        mpMemoryScopePeak(nullptr)
+    {
+        // Never resized afterwards, so that threads filling different slots do not race.
+        mResources.resize(capacity);
+        mMemoryCategories.resize(capacity, MemoryCategory::Other);
+        mMemorySizes.resize(capacity, 0u);
+        mLive.resize(capacity, 0u);
+
+        for (auto& descriptors : mDescriptors)
+            descriptors.resize(capacity, UINT32_MAX);
+    }
+
+    template <typename Resource>
+    ResourceHandle ResourceTable<Resource>::Add(Resource&& resource, uint32_t viewMask, MemoryCategory category, uint64_t size)
+    {
+        ResourceHandle handle;
+        handle.indexResource = mSlots.Allocate();
+
+        const uint32_t slot = SlotAllocator::GetIndex(handle.indexResource);
+
+        mResources[slot]        = std::move(resource);
+        mMemoryCategories[slot] = category;
+        mMemorySizes[slot]      = size;
+        mLive[slot]             = 1u;
+
+        TrackMemory(category, size);
+
+        // The table keeps its own copy of the descriptor indices, so that a release does not depend on the caller's handle
+        // being up to date.
+        for (size_t viewIndex = 0u; viewIndex < kResourceViewCount; viewIndex++)
+        {
+            if ((viewMask & (1u << viewIndex)) == 0u)
+                continue;
+
+            const auto view = static_cast<ResourceView>(viewIndex);
+
+            mDescriptors[viewIndex][slot] = mpFactory->CreateView(mResources[slot], view);
+
+            GetDescriptorIndex(handle, view) = mDescriptors[viewIndex][slot];
+        }
+
+        return handle;
+    }
+
+    template <typename Resource>
+    typename ResourceTable<Resource>::DeferredRelease ResourceTable<Resource>::CreateDeferredRelease() const
+    {
+        DeferredRelease deferredRelease         = {};
+        deferredRelease.fenceValue              = kUntagged;
+        deferredRelease.hasResource             = false;
+        deferredRelease.descriptorTableHeapType = 0u;
+        deferredRelease.descriptorTable         = UINT32_MAX;
+        deferredRelease.descriptorTableSize     = 0u;
+        deferredRelease.memoryCategory          = MemoryCategory::Other;
+        deferredRelease.memorySize              = 0u;
+
+        deferredRelease.descriptors.fill(UINT32_MAX);
+
+        return deferredRelease;
+    }
+
+    template <typename Resource>
+    typename ResourceTable<Resource>::DeferredRelease ResourceTable<Resource>::DetachSlot(const ResourceHandle& handle)
+    {
+        const uint32_t slot = GetSlot(handle);
+
+        DeferredRelease deferredRelease = CreateDeferredRelease();
+        deferredRelease.hasResource     = true;
+        deferredRelease.resource        = std::move(mResources[slot]);
+        deferredRelease.memoryCategory  = mMemoryCategories[slot];
+        deferredRelease.memorySize      = mMemorySizes[slot];
+
+        for (size_t viewIndex = 0u; viewIndex < kResourceViewCount; viewIndex++)
+        {
+            deferredRelease.descriptors[viewIndex] = mDescriptors[viewIndex][slot];
+            mDescriptors[viewIndex][slot]          = UINT32_MAX;
+        }
+
+        mResources[slot]        = {};
+        mMemoryCategories[slot] = MemoryCategory::Other;
+        mMemorySizes[slot]      = 0u;
+        mLive[slot]             = 0u;
+
+        // Retires the handle, a later use or second release of it throws.
+        mSlots.Free(handle.indexResource);
+
+        return deferredRelease;
+    }
+
+    template <typename Resource>
+    void ResourceTable<Resource>::Destroy(DeferredRelease& deferredRelease)
+    {
+        for (size_t viewIndex = 0u; viewIndex < kResourceViewCount; viewIndex++)
+        {
+            if (deferredRelease.descriptors[viewIndex] != UINT32_MAX)
+                mpFactory->FreeDescriptors(1u << viewIndex, deferredRelease.descriptors[viewIndex], 1u);
+        }
+
+        if (deferredRelease.descriptorTable != UINT32_MAX)
+            mpFactory->FreeDescriptors(deferredRelease.descriptorTableHeapType, deferredRelease.descriptorTable, deferredRelease.descriptorTableSize);
+
+        if (deferredRelease.hasResource)
+        {
+            UntrackMemory(deferredRelease.memoryCategory, deferredRelease.memorySize);
+
+            mpFactory->Destroy(deferredRelease.resource);
+        }
+    }
+
+    template <typename Resource>
+    void ResourceTable<Resource>::Release(const ResourceHandle& handle)
+    {
+        auto deferredRelease = DetachSlot(handle);
+
+        std::lock_guard<std::mutex> deferredReleasesLock(mDeferredReleasesMutex);
+        mDeferredReleases.push_back(std::move(deferredRelease));
+    }
+
+    template <typename Resource>
+    void ResourceTable<Resource>::ReleaseImmediate(const ResourceHandle& handle)
+    {
+        auto deferredRelease = DetachSlot(handle);
+
+        Destroy(deferredRelease);
+    }
+
+    template <typename Resource>
+    void ResourceTable<Resource>::Release(Resource&& resource, MemoryCategory category, uint64_t size)
+    {
+        DeferredRelease deferredRelease = CreateDeferredRelease();
+        deferredRelease.hasResource     = true;
+        deferredRelease.resource        = std::move(resource);
+        deferredRelease.memoryCategory  = category;
+        deferredRelease.memorySize      = size;
+
+        std::lock_guard<std::mutex> deferredReleasesLock(mDeferredReleasesMutex);
+        mDeferredReleases.push_back(std::move(deferredRelease));
+    }
+
+    template <typename Resource>
+    void ResourceTable<Resource>::ReleaseDescriptorTable(uint32_t heapType, uint32_t firstIndex, uint32_t count)
+    {
+        DeferredRelease deferredRelease         = CreateDeferredRelease();
+        deferredRelease.descriptorTableHeapType = heapType;
+        deferredRelease.descriptorTable         = firstIndex;
+        deferredRelease.descriptorTableSize     = count;
+
+        std::lock_guard<std::mutex> deferredReleasesLock(mDeferredReleasesMutex);
+        mDeferredReleases.push_back(std::move(deferredRelease));
+    }
+
+    template <typename Resource>
+    void ResourceTable<Resource>::ProcessDeferredReleases(uint64_t completedFenceValue, uint64_t nextFenceValue)
+    {
+        std::lock_guard<std::mutex> deferredReleasesLock(mDeferredReleasesMutex);
+
+        while (!mDeferredReleases.empty() && mDeferredReleases.front().fenceValue <= completedFenceValue)
+        {
+            auto& deferredRelease = mDeferredReleases.front();
+
+            mReclaimedCount++;
+            mReclaimedBytes += deferredRelease.memorySize;
+
+            Destroy(deferredRelease);
+
+            mDeferredReleases.pop_front();
+        }
+
+        for (auto& deferredRelease : mDeferredReleases)
+        {
+            if (deferredRelease.fenceValue == kUntagged)
+                deferredRelease.fenceValue = nextFenceValue;
+        }
+    }
+
+    template <typename Resource>
+    typename ResourceTable<Resource>::DeferredReleaseStats ResourceTable<Resource>::GetDeferredReleaseStats()
+    {
+        std::lock_guard<std::mutex> deferredReleasesLock(mDeferredReleasesMutex);
+
+        DeferredReleaseStats stats = {};
+        {
+            stats.pendingCount   = static_cast<uint32_t>(mDeferredReleases.size());
+            stats.reclaimedCount = mReclaimedCount;
+            stats.reclaimedBytes = mReclaimedBytes;
+        }
+
+        for (const auto& deferredRelease : mDeferredReleases)
+            stats.pendingBytes += deferredRelease.memorySize;
+
+        return stats;
+    }
+
+    template <typename Resource>
+    void ResourceTable<Resource>::TrackMemory(MemoryCategory category, uint64_t size)
+    {
+        std::lock_guard<std::mutex> memoryLock(mMemoryMutex);
+
+        auto& categoryStats = mMemoryCategoryStats[static_cast<size_t>(category)];
+
+        categoryStats.count++;
+        categoryStats.bytes += size;
+        categoryStats.peakBytes = std::max(categoryStats.peakBytes, categoryStats.bytes);
+
+        mTrackedBytes += size;
+        mPeakTrackedBytes = std::max(mPeakTrackedBytes, mTrackedBytes);
+
+        if (mpMemoryScopePeak)
+            *mpMemoryScopePeak = std::max(*mpMemoryScopePeak, mTrackedBytes);
+    }
+
+    template <typename Resource>
+    void ResourceTable<Resource>::UntrackMemory(MemoryCategory category, uint64_t size)
+    {
+        std::lock_guard<std::mutex> memoryLock(mMemoryMutex);
+
+        auto& categoryStats = mMemoryCategoryStats[static_cast<size_t>(category)];
+
+        categoryStats.count--;
+        categoryStats.bytes -= size;
+
+        mTrackedBytes -= size;
+    }
+
+    template <typename Resource>
+    typename ResourceTable<Resource>::MemoryStats ResourceTable<Resource>::GetMemoryStats()
+    {
+        std::lock_guard<std::mutex> memoryLock(mMemoryMutex);
+
+        return { mMemoryCategoryStats, mTrackedBytes, mPeakTrackedBytes };
+    }
+
+    template <typename Resource>
+    void ResourceTable<Resource>::SetMemoryCategory(const ResourceHandle& handle, MemoryCategory category)
+    {
+        const uint32_t slot = GetSlot(handle);
+
+        if (mMemoryCategories[slot] == category)
+            return;
+
+        UntrackMemory(mMemoryCategories[slot], mMemorySizes[slot]);
+
+        mMemoryCategories[slot] = category;
+
+        TrackMemory(category, mMemorySizes[slot]);
+    }
+
+    template <typename Resource>
+    void ResourceTable<Resource>::SetMemoryScope(const std::string& scope)
+    {
+        std::lock_guard<std::mutex> memoryLock(mMemoryMutex);
+
+        if (scope.empty())
+        {
+            mpMemoryScopePeak = nullptr;
+            return;
+        }
+
+        // Entries of unordered maps stay put, the pointer survives rehashes.
+        mpMemoryScopePeak  = &mMemoryScopePeaks[scope];
+        *mpMemoryScopePeak = std::max(*mpMemoryScopePeak, mTrackedBytes);
+    }
+
+    template <typename Resource>
+    std::unordered_map<std::string, uint64_t> ResourceTable<Resource>::GetMemoryScopePeaks()
+    {
+        std::lock_guard<std::mutex> memoryLock(mMemoryMutex);
+
+        return mMemoryScopePeaks;
+    }
+} // namespace ICR
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef RING_ALLOCATOR_H
+#define RING_ALLOCATOR_H
+
+#include <cstdint>
+#include <deque>
+
+namespace ICR
+{
+    // Offset bookkeeping for a ring of memory that the GPU reads from (staging, constants). Allocations are handed out
+    // linearly, grouped into submissions tagged with a fence value, and the space of a submission comes back in order once
+    // its fence value completed. An allocation never straddles the end of the ring, the tail end is skipped instead.
+    class RingAllocator
+    {
+    public:
+
+        static constexpr uint64_t kInvalidOffset = UINT64_MAX;
+
+        RingAllocator(uint64_t capacity);
+
+        // Returns the offset of size bytes aligned to alignment (a power of two), or kInvalidOffset when the free space does
+        // not fit it (reclaim, or grow into a new ring).
+        uint64_t Allocate(uint64_t size, uint64_t alignment);
+
+        // Everything allocated since the last submit is in use until fenceValue completes. Throws std::invalid_argument when the
+        // fence value is below the previous submission's.
+        void Submit(uint64_t fenceValue);
+
+        // Frees the space of submissions up to and including completedFenceValue.
+        void Reclaim(uint64_t completedFenceValue);
+
+        inline uint64_t GetCapacity() const { return mCapacity; }
+        inline uint64_t GetUsedSize() const { return mUsedSize; } // Including alignment padding and skipped tail ends.
+        inline bool     HasPendingAllocations() const { return mPendingSize != 0u; }
+        inline bool     IsIdle() const { return mUsedSize == 0u; }
+
+    private:
+
+        struct Submission
+        {
+            uint64_t fenceValue;
+            uint64_t endOffset;
+            uint64_t size;
+        };
+
+        uint64_t               mCapacity;
+        uint64_t               mHead;
+        uint64_t               mTail;
+        uint64_t               mUsedSize;
+        uint64_t               mPendingSize;
+        std::deque<Submission> mSubmissions;
+    };
+} // namespace ICR
+
+#endif
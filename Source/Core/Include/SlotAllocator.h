@@ -0,0 +1,55 @@
+#ifndef SLOT_ALLOCATOR_H
+#define SLOT_ALLOCATOR_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace ICR
+{
+    // Lock-free allocator of slots in a fixed-capacity table, handing out generational 32-bit handles: the low bits hold the
+    // slot index and the high bits the slot's generation, which is bumped on every allocation and every free (odd while live).
+    // A handle kept past its free no longer matches the generation and is rejected, until the generation wraps around (every
+    // 2048 reuses of the same slot). Free slots form a Treiber stack, its head is tagged with a counter so that a concurrent
+    // pop and push cannot ABA.
+    class SlotAllocator
+    {
+    public:
+
+        static constexpr uint32_t kIndexBits      = 20u;
+        static constexpr uint32_t kGenerationBits = 32u - kIndexBits;
+        static constexpr uint32_t kIndexMask      = (1u << kIndexBits) - 1u;
+        static constexpr uint32_t kMaxCapacity    = kIndexMask; // All index bits set is reserved, so no handle is UINT32_MAX.
+        static constexpr uint32_t kInvalidHandle  = UINT32_MAX;
+
+        // Throws std::invalid_argument for a capacity of zero or above kMaxCapacity.
+        SlotAllocator(uint32_t capacity);
+
+        // Throws std::runtime_error when every slot is taken.
+        uint32_t Allocate();
+
+        // Throws std::runtime_error for a stale or invalid handle (including a second free of the same handle).
+        void Free(uint32_t handle);
+
+        bool IsValid(uint32_t handle) const;
+
+        static inline uint32_t GetIndex(uint32_t handle) { return handle & kIndexMask; }
+
+        inline uint32_t GetCapacity() const { return mCapacity; }
+        inline uint32_t GetLiveCount() const { return mLiveCount.load(std::memory_order_relaxed); }
+
+    private:
+
+        static constexpr uint32_t kEmpty = UINT32_MAX;
+
+        static inline uint64_t PackHead(uint32_t tag, uint32_t index) { return (static_cast<uint64_t>(tag) << 32u) | index; }
+
+        uint32_t                                 mCapacity;
+        std::unique_ptr<std::atomic<uint32_t>[]> mGenerations;
+        std::unique_ptr<std::atomic<uint32_t>[]> mNextFree;
+        std::atomic<uint64_t>                    mFreeHead;
+        std::atomic<uint32_t>                    mLiveCount;
+    };
+} // namespace ICR
+
+#endif
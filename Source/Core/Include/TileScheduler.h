@@ -0,0 +1,62 @@
+#ifndef TILE_SCHEDULER_H
+#define TILE_SCHEDULER_H
+
+#include <cstdint>
+
+namespace ICR
+{
+    struct Tile
+    {
+        uint32_t x;
+        uint32_t y;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    // Hands out the tiles of an image row by row, sizing them so that the cost of each tile stays close to a target. The cost
+    // per pixel is learned from the reported tiles (smoothed, so a single slow tile does not collapse the tile size).
+    class TileScheduler
+    {
+    public:
+
+        struct Params
+        {
+            uint32_t width;
+            uint32_t height;
+            double   targetTileCost; // Same unit as the reported costs.
+            uint32_t initialTileSize;
+            uint32_t minTileSize;
+            uint32_t maxTileSize;
+        };
+
+        TileScheduler(const Params& params);
+
+        // Returns false once the whole image was handed out.
+        bool Next(Tile& tile);
+
+        // Reports the measured cost of a tile returned by Next, the following tiles are sized after it.
+        void Report(const Tile& tile, double cost);
+
+        // Edge length of a square tile meeting the target at the current cost estimate.
+        inline uint32_t GetTileSize() const { return mTileSize; }
+        inline uint32_t GetTileCount() const { return mTileCount; }
+        inline double   GetCostPerPixel() const { return mCostPerPixel; }
+        inline double   GetProgress() const
+        {
+            return static_cast<double>(mReportedPixelCount) / (static_cast<double>(mParams.width) * mParams.height);
+        }
+
+    private:
+
+        Params   mParams;
+        uint32_t mCursorX;
+        uint32_t mCursorY;
+        uint32_t mRowHeight;
+        uint32_t mTileSize;
+        uint32_t mTileCount;
+        uint64_t mReportedPixelCount;
+        double   mCostPerPixel; // Negative until the first report.
+    };
+} // namespace ICR
+
+#endif
@@ -0,0 +1,116 @@
+#include <RenderGraphCompiler.h>
+
+#include <map>
+#include <stdexcept>
+#include <string>
+
+namespace ICR
+{
+    void RenderGraphCompiler::SetState(uint32_t resource, ResourceState state) { mStates[resource] = state; }
+
+    ResourceState RenderGraphCompiler::GetState(uint32_t resource) const
+    {
+        auto state = mStates.find(resource);
+
+        return state != mStates.end() ? state->second : ResourceState::Common;
+    }
+
+    void RenderGraphCompiler::SetAliased(uint32_t resource) { mAliased.insert(resource); }
+
+    void RenderGraphCompiler::Reset()
+    {
+        mStates.clear();
+        mAliased.clear();
+    }
+
+    RenderGraphCompiler::Plan RenderGraphCompiler::Compile(const std::vector<std::vector<PassAccess>>& levels, const std::vector<uint32_t>& exitReads)
+    {
+        struct Use
+        {
+            size_t        level;
+            ResourceState state;
+        };
+
+        const size_t exitLevel = levels.size();
+
+        // Collect the state each resource needs per level, ordered by resource so the plan is deterministic.
+        std::map<uint32_t, std::vector<Use>> resourceUses;
+
+        auto AddUse = [&](uint32_t resource, size_t level, ResourceState state)
+        {
+            auto& uses = resourceUses[resource];
+
+            if (!uses.empty() && uses.back().level == level)
+            {
+                if (uses.back().state != state)
+                    throw std::runtime_error("RenderGraphCompiler: Resource " + std::to_string(resource) + " is both read and written in level " +
+                                             std::to_string(level) + ".");
+                return;
+            }
+
+            uses.push_back({ level, state });
+        };
+
+        for (size_t levelIndex = 0; levelIndex < levels.size(); levelIndex++)
+        {
+            for (const auto& pass : levels[levelIndex])
+            {
+                for (auto resource : pass.writes)
+                    AddUse(resource, levelIndex, ResourceState::RenderTarget);
+
+                for (auto resource : pass.reads)
+                    AddUse(resource, levelIndex, ResourceState::ShaderResource);
+            }
+        }
+
+        for (auto resource : exitReads)
+            AddUse(resource, exitLevel, ResourceState::ShaderResource);
+
+        // Walk each resource's uses and emit a transition wherever the state changes.
+        Plan plan;
+        plan.levelBarriers.resize(levels.size());
+        plan.levelActivations.resize(levels.size());
+
+        auto GetBatch = [&](size_t level) -> std::vector<ResourceBarrier>&
+        { return level == exitLevel ? plan.exitBarriers : plan.levelBarriers[level]; };
+
+        for (const auto& [resource, uses] : resourceUses)
+        {
+            auto state = GetState(resource);
+
+            const bool splittable = !mAliased.contains(resource);
+
+            // Whatever shared the memory since the last frame may have overwritten it.
+            if (!splittable && uses.front().level != exitLevel)
+                plan.levelActivations[uses.front().level].push_back(resource);
+
+            // First level after the previous use, zero ahead of the first use in this frame.
+            size_t nextIdleLevel = 0u;
+
+            for (const auto& use : uses)
+            {
+                if (use.state != state)
+                {
+                    // The exit reads are recorded into a separate submission, split barriers must not straddle it.
+                    if (splittable && use.level > nextIdleLevel && use.level != exitLevel)
+                    {
+                        GetBatch(nextIdleLevel).push_back({ resource, state, use.state, ResourceBarrier::Split::Begin });
+                        GetBatch(use.level).push_back({ resource, state, use.state, ResourceBarrier::Split::End });
+                    }
+                    else
+                    {
+                        GetBatch(use.level).push_back({ resource, state, use.state, ResourceBarrier::Split::None });
+                    }
+
+                    state = use.state;
+                }
+
+                nextIdleLevel = use.level + 1u;
+            }
+
+            mStates[resource] = state;
+        }
+
+        return plan;
+    }
+} // namespace ICR
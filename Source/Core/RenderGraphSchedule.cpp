@@ -0,0 +1,245 @@
+#include <RenderGraphSchedule.h>
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace ICR
+{
+    RenderGraphSchedule::RenderGraphSchedule(const std::vector<PassDeclaration>& passes)
+    {
+        const size_t passCount = passes.size();
+
+        // Execution order: declaration order with the final pass moved last.
+        std::vector<size_t> executionOrder(passCount);
+        std::iota(executionOrder.begin(), executionOrder.end(), size_t(0));
+
+        std::stable_partition(executionOrder.begin(), executionOrder.end(), [&](size_t passIndex) { return !passes[passIndex].final; });
+
+        if (std::count_if(passes.begin(), passes.end(), [](const PassDeclaration& pass) { return pass.final; }) > 1)
+            throw std::runtime_error("RenderGraphSchedule: More than one final pass.");
+
+        std::vector<size_t> executionPositions(passCount);
+
+        for (size_t position = 0; position < passCount; position++)
+            executionPositions[executionOrder[position]] = position;
+
+        // Map each output to the pass producing it.
+        std::unordered_map<int, size_t> producers;
+
+        for (size_t passIndex = 0; passIndex < passCount; passIndex++)
+        {
+            if (!producers.emplace(passes[passIndex].outputID, passIndex).second)
+                throw std::runtime_error("RenderGraphSchedule: Output " + std::to_string(passes[passIndex].outputID) + " is written twice.");
+        }
+
+        // Dependency resolution.
+        // ------------------------------------------------
+
+        std::vector<std::vector<size_t>> consumers(passCount);
+        std::vector<uint32_t>            dependencyCounts(passCount, 0u);
+
+        mHistoryInputIDs.assign(passCount, {});
+
+        for (size_t passIndex = 0; passIndex < passCount; passIndex++)
+        {
+            for (int inputID : passes[passIndex].inputIDs)
+            {
+                auto producer = producers.find(inputID);
+
+                // Skip inputs that are not provided from other passes.
+                if (producer == producers.end())
+                    continue;
+
+                // Self-referential inputs, and outputs read before they are written this frame, come from the previous frame.
+                if (executionPositions[producer->second] >= executionPositions[passIndex])
+                {
+                    mHistoryInputIDs[passIndex].push_back(inputID);
+                    continue;
+                }
+
+                consumers[producer->second].push_back(passIndex);
+                dependencyCounts[passIndex]++;
+            }
+        }
+
+        // Culling.
+        // ------------------------------------------------
+
+        // Walk back from the final pass across every input edge, same-frame and history alike: a pass only feeding itself,
+        // or other unreachable passes, never contributes to a presented image.
+        std::vector<bool> reachable(passCount, true);
+
+        auto finalPass = std::find_if(passes.begin(), passes.end(), [](const PassDeclaration& pass) { return pass.final; });
+
+        if (finalPass != passes.end())
+        {
+            reachable.assign(passCount, false);
+
+            std::vector<size_t> pendingPasses = { static_cast<size_t>(finalPass - passes.begin()) };
+
+            reachable[pendingPasses.back()] = true;
+
+            while (!pendingPasses.empty())
+            {
+                const size_t passIndex = pendingPasses.back();
+                pendingPasses.pop_back();
+
+                for (int inputID : passes[passIndex].inputIDs)
+                {
+                    auto producer = producers.find(inputID);
+
+                    if (producer == producers.end() || reachable[producer->second])
+                        continue;
+
+                    reachable[producer->second] = true;
+                    pendingPasses.push_back(producer->second);
+                }
+            }
+        }
+
+        for (size_t passIndex = 0; passIndex < passCount; passIndex++)
+        {
+            if (!reachable[passIndex])
+                mCulledPasses.push_back(passIndex);
+        }
+
+        // Scheduling.
+        // ------------------------------------------------
+
+        // Kahn's algorithm run in waves: every pass in a level only depends on passes in earlier levels, so the passes
+        // of a level are independent of each other. Execution order is kept within a level. Dependencies only point
+        // forward in execution order, so there are no cycles.
+        std::vector<size_t> readyPasses;
+
+        for (size_t passIndex = 0; passIndex < passCount; passIndex++)
+        {
+            if (dependencyCounts[passIndex] == 0u && reachable[passIndex])
+                readyPasses.push_back(passIndex);
+        }
+
+        std::vector<size_t> passLevels(passCount);
+
+        while (!readyPasses.empty())
+        {
+            std::sort(readyPasses.begin(), readyPasses.end(), [&](size_t a, size_t b) { return executionPositions[a] < executionPositions[b]; });
+
+            std::vector<size_t> nextReadyPasses;
+
+            for (auto passIndex : readyPasses)
+            {
+                passLevels[passIndex] = mLevels.size();
+
+                for (auto consumerIndex : consumers[passIndex])
+                {
+                    if (--dependencyCounts[consumerIndex] == 0u && reachable[consumerIndex])
+                        nextReadyPasses.push_back(consumerIndex);
+                }
+            }
+
+            mLevels.push_back(std::move(readyPasses));
+
+            readyPasses = std::move(nextReadyPasses);
+        }
+
+        // Lifetime analysis.
+        // ------------------------------------------------
+
+        mLifetimes.assign(passCount, {});
+
+        for (size_t passIndex = 0; passIndex < passCount; passIndex++)
+        {
+            if (!reachable[passIndex])
+                continue;
+
+            mLifetimes[passIndex].history    = false;
+            mLifetimes[passIndex].firstLevel = passLevels[passIndex];
+            mLifetimes[passIndex].lastLevel  = passes[passIndex].final ? mLevels.size() : passLevels[passIndex];
+        }
+
+        for (size_t passIndex = 0; passIndex < passCount; passIndex++)
+        {
+            if (!reachable[passIndex])
+                continue;
+
+            for (int inputID : passes[passIndex].inputIDs)
+            {
+                auto producer = producers.find(inputID);
+
+                if (producer == producers.end())
+                    continue;
+
+                auto& lifetime = mLifetimes[producer->second];
+
+                // Read across frames, so both the current and the previous frame's output have to stay alive.
+                if (IsHistoryInput(passIndex, inputID))
+                    lifetime.history = true;
+                else
+                    lifetime.lastLevel = std::max(lifetime.lastLevel, passLevels[passIndex]);
+            }
+        }
+    }
+
+    bool RenderGraphSchedule::IsHistoryInput(size_t passIndex, int inputID) const
+    {
+        const auto& historyInputIDs = mHistoryInputIDs[passIndex];
+
+        return std::find(historyInputIDs.begin(), historyInputIDs.end(), inputID) != historyInputIDs.end();
+    }
+
+    bool RenderGraphSchedule::IsCulled(size_t passIndex) const
+    {
+        return std::binary_search(mCulledPasses.begin(), mCulledPasses.end(), passIndex);
+    }
+
+    uint64_t PlaceTransientAllocations(std::vector<TransientAllocation>& allocations, uint64_t alignment)
+    {
+        std::vector<TransientAllocation*> placementOrder;
+
+        for (auto& allocation : allocations)
+            placementOrder.push_back(&allocation);
+
+        std::stable_sort(placementOrder.begin(),
+                         placementOrder.end(),
+                         [](const TransientAllocation* a, const TransientAllocation* b) { return a->size > b->size; });
+
+        auto AlignUp = [&](uint64_t offset) { return (offset + alignment - 1) & ~(alignment - 1); };
+
+        uint64_t heapSize = 0u;
+
+        for (size_t placedCount = 0; placedCount < placementOrder.size(); placedCount++)
+        {
+            auto* pAllocation = placementOrder[placedCount];
+
+            pAllocation->heapOffset = 0u;
+
+            // Bump past every placed allocation that collides, until none does. Offsets only grow, so this terminates.
+            for (bool moved = true; moved;)
+            {
+                moved = false;
+
+                for (size_t placedIndex = 0; placedIndex < placedCount; placedIndex++)
+                {
+                    const auto* pPlaced = placementOrder[placedIndex];
+
+                    bool overlapsInTime = pPlaced->firstLevel <= pAllocation->lastLevel && pAllocation->firstLevel <= pPlaced->lastLevel;
+
+                    bool overlapsInMemory = pPlaced->heapOffset < pAllocation->heapOffset + pAllocation->size &&
+                                            pAllocation->heapOffset < pPlaced->heapOffset + pPlaced->size;
+
+                    if (overlapsInTime && overlapsInMemory)
+                    {
+                        pAllocation->heapOffset = AlignUp(pPlaced->heapOffset + pPlaced->size);
+                        moved                   = true;
+                    }
+                }
+            }
+
+            heapSize = std::max(heapSize, pAllocation->heapOffset + pAllocation->size);
+        }
+
+        return heapSize;
+    }
+} // namespace ICR
@@ -0,0 +1,34 @@
+#include <ResolutionScaleController.h>
+
+#include <algorithm>
+
+namespace ICR
+{
+    ResolutionScaleController::ResolutionScaleController(const Params& params) :
+        mParams(params),
+        mIntegral(params.maxScale),
+        mScale(params.maxScale)
+    {
+    }
+
+    double ResolutionScaleController::Update(double frameTime, double deltaTime)
+    {
+        if (mParams.targetFrameTime <= 0.0 || frameTime <= 0.0)
+            return mScale;
+
+        // Positive with headroom left, negative when over budget.
+        const double error = (mParams.targetFrameTime - frameTime) / mParams.targetFrameTime;
+
+        mIntegral = std::clamp(mIntegral + mParams.integralGain * error * deltaTime, mParams.minScale, mParams.maxScale);
+
+        mScale = std::clamp(mIntegral + mParams.proportionalGain * error, mParams.minScale, mParams.maxScale);
+
+        return mScale;
+    }
+
+    void ResolutionScaleController::Reset(double scale)
+    {
+        mIntegral = std::clamp(scale, mParams.minScale, mParams.maxScale);
+        mScale    = mIntegral;
+    }
+} // namespace ICR
@@ -0,0 +1,80 @@
+#include <RingAllocator.h>
+
+#include <stdexcept>
+
+namespace ICR
+{
+    RingAllocator::RingAllocator(uint64_t capacity) : mCapacity(capacity), mHead(0u), mTail(0u), mUsedSize(0u), mPendingSize(0u) {}
+
+    uint64_t RingAllocator::Allocate(uint64_t size, uint64_t alignment)
+    {
+        if (size == 0u || size > mCapacity)
+            return kInvalidOffset;
+
+        // Restart at the front whenever the ring drained, so that large allocations find contiguous space.
+        if (mUsedSize == 0u)
+            mHead = mTail = 0u;
+
+        const uint64_t alignedHead = (mHead + alignment - 1u) & ~(alignment - 1u);
+
+        uint64_t offset;
+        uint64_t usedSize;
+
+        if (mHead > mTail || mUsedSize == 0u)
+        {
+            // Free space is [head, capacity) followed by [0, tail).
+            if (alignedHead + size <= mCapacity)
+            {
+                offset   = alignedHead;
+                usedSize = alignedHead - mHead + size;
+            }
+            else if (size <= mTail)
+            {
+                offset   = 0u;
+                usedSize = mCapacity - mHead + size;
+            }
+            else
+                return kInvalidOffset;
+        }
+        else
+        {
+            // Wrapped (or full, with head == tail): free space is [head, tail).
+            if (mUsedSize == mCapacity || alignedHead + size > mTail)
+                return kInvalidOffset;
+
+            offset   = alignedHead;
+            usedSize = alignedHead - mHead + size;
+        }
+
+        mHead = offset + size;
+        mUsedSize += usedSize;
+        mPendingSize += usedSize;
+
+        return offset;
+    }
+
+    void RingAllocator::Submit(uint64_t fenceValue)
+    {
+        if (mPendingSize == 0u)
+            return;
+
+        // Space comes back in submission order, a lower fence value would hold on to it until the previous one completed.
+        if (!mSubmissions.empty() && fenceValue < mSubmissions.back().fenceValue)
+            throw std::invalid_argument("RingAllocator: Submitted fence values must not decrease.");
+
+        mSubmissions.push_back({ fenceValue, mHead, mPendingSize });
+
+        mPendingSize = 0u;
+    }
+
+    void RingAllocator::Reclaim(uint64_t completedFenceValue)
+    {
+        while (!mSubmissions.empty() && mSubmissions.front().fenceValue <= completedFenceValue)
+        {
+            mTail = mSubmissions.front().endOffset;
+            mUsedSize -= mSubmissions.front().size;
+
+            mSubmissions.pop_front();
+        }
+    }
+} // namespace ICR
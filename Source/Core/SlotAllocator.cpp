@@ -0,0 +1,91 @@
+#include <SlotAllocator.h>
+
+#include <stdexcept>
+
+namespace ICR
+{
+    static constexpr uint32_t kGenerationMask = (1u << SlotAllocator::kGenerationBits) - 1u;
+
+    static inline uint32_t GetGeneration(uint32_t handle) { return handle >> SlotAllocator::kIndexBits; }
+
+    SlotAllocator::SlotAllocator(uint32_t capacity) : mCapacity(capacity), mLiveCount(0u)
+    {
+        if (capacity == 0u || capacity > kMaxCapacity)
+            throw std::invalid_argument("SlotAllocator: Capacity out of range.");
+
+        mGenerations = std::make_unique<std::atomic<uint32_t>[]>(capacity);
+        mNextFree    = std::make_unique<std::atomic<uint32_t>[]>(capacity);
+
+        // Lowest indices on top, so a fresh allocator hands out slots in order.
+        for (uint32_t index = 0u; index < capacity; index++)
+        {
+            mGenerations[index].store(0u, std::memory_order_relaxed);
+            mNextFree[index].store(index + 1u < capacity ? index + 1u : kEmpty, std::memory_order_relaxed);
+        }
+
+        mFreeHead.store(PackHead(0u, 0u), std::memory_order_release);
+    }
+
+    uint32_t SlotAllocator::Allocate()
+    {
+        uint64_t head = mFreeHead.load(std::memory_order_acquire);
+
+        for (;;)
+        {
+            const uint32_t index = static_cast<uint32_t>(head);
+
+            if (index == kEmpty)
+                throw std::runtime_error("SlotAllocator: Maximum number of slots reached.");
+
+            // May read the link of a slot another thread just popped, the tag then fails the exchange below.
+            const uint32_t next = mNextFree[index].load(std::memory_order_relaxed);
+
+            if (mFreeHead.compare_exchange_weak(head, PackHead(static_cast<uint32_t>(head >> 32u) + 1u, next), std::memory_order_acq_rel))
+            {
+                mLiveCount.fetch_add(1u, std::memory_order_relaxed);
+
+                // The slot is owned from here on. Free slots have an even generation, so no handle ever matches one.
+                const uint32_t generation = (mGenerations[index].load(std::memory_order_relaxed) + 1u) & kGenerationMask;
+
+                mGenerations[index].store(generation, std::memory_order_release);
+
+                return (generation << kIndexBits) | index;
+            }
+        }
+    }
+
+    void SlotAllocator::Free(uint32_t handle)
+    {
+        const uint32_t index = GetIndex(handle);
+
+        if (handle == kInvalidHandle || index >= mCapacity)
+            throw std::runtime_error("SlotAllocator: Invalid handle.");
+
+        // Retiring the generation is what claims the free, so of two racing frees of one handle only one succeeds.
+        uint32_t generation = GetGeneration(handle);
+
+        const bool live = (generation & 1u) != 0u;
+
+        if (!live || !mGenerations[index].compare_exchange_strong(generation, (generation + 1u) & kGenerationMask, std::memory_order_acq_rel))
+            throw std::runtime_error("SlotAllocator: Stale handle.");
+
+        mLiveCount.fetch_sub(1u, std::memory_order_relaxed);
+
+        uint64_t head = mFreeHead.load(std::memory_order_relaxed);
+
+        do
+        {
+            mNextFree[index].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+        } while (!mFreeHead.compare_exchange_weak(head, PackHead(static_cast<uint32_t>(head >> 32u) + 1u, index), std::memory_order_acq_rel));
+    }
+
+    bool SlotAllocator::IsValid(uint32_t handle) const
+    {
+        const uint32_t index = GetIndex(handle);
+
+        if (handle == kInvalidHandle || index >= mCapacity)
+            return false;
+
+        return mGenerations[index].load(std::memory_order_acquire) == GetGeneration(handle);
+    }
+} // namespace ICR
@@ -0,0 +1,86 @@
+#include <TileScheduler.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace ICR
+{
+    // Weight of the latest tile in the cost per pixel estimate.
+    constexpr double kCostSmoothing = 0.5;
+
+    TileScheduler::TileScheduler(const Params& params) :
+        mParams(params),
+        mCursorX(0u),
+        mCursorY(0u),
+        mRowHeight(0u),
+        mTileSize(std::clamp(params.initialTileSize, params.minTileSize, params.maxTileSize)),
+        mTileCount(0u),
+        mReportedPixelCount(0u),
+        mCostPerPixel(-1.0)
+    {
+    }
+
+    bool TileScheduler::Next(Tile& tile)
+    {
+        if (mCursorY >= mParams.height)
+            return false;
+
+        // Remainders smaller than the minimum are merged into the last tile of a row (or the last row), instead of trailing
+        // behind as slivers.
+        auto Extent = [&](uint32_t size, uint32_t remaining)
+        { return remaining - std::min(size, remaining) < mParams.minTileSize ? remaining : size; };
+
+        if (mCursorX == 0u)
+            mRowHeight = Extent(mTileSize, mParams.height - mCursorY);
+
+        // Keep the tile area at what a square tile would cover, so that the cost stays on target in short rows.
+        auto tileWidth = std::clamp((mTileSize * mTileSize) / std::max(mRowHeight, 1u), mParams.minTileSize, mParams.maxTileSize);
+
+        tile.x      = mCursorX;
+        tile.y      = mCursorY;
+        tile.width  = Extent(tileWidth, mParams.width - mCursorX);
+        tile.height = mRowHeight;
+
+        mCursorX += tile.width;
+
+        if (mCursorX >= mParams.width)
+        {
+            mCursorX = 0u;
+            mCursorY += mRowHeight;
+        }
+
+        mTileCount++;
+
+        return true;
+    }
+
+    void TileScheduler::Report(const Tile& tile, double cost)
+    {
+        const auto pixelCount = static_cast<uint64_t>(tile.width) * tile.height;
+
+        mReportedPixelCount += pixelCount;
+
+        if (pixelCount == 0u)
+            return;
+
+        const auto tileCostPerPixel = cost / static_cast<double>(pixelCount);
+
+        if (mCostPerPixel < 0.0)
+            mCostPerPixel = tileCostPerPixel;
+        else
+            mCostPerPixel = (1.0 - kCostSmoothing) * mCostPerPixel + kCostSmoothing * tileCostPerPixel;
+
+        if (mCostPerPixel <= 0.0)
+        {
+            mTileSize = mParams.maxTileSize;
+            return;
+        }
+
+        // Grow at most 2x per tile, an underestimated cost must not turn into a tile that blows past the target.
+        auto tileSize = std::sqrt(mParams.targetTileCost / mCostPerPixel);
+
+        tileSize = std::min(tileSize, 2.0 * mTileSize);
+
+        mTileSize = std::clamp(static_cast<uint32_t>(tileSize), mParams.minTileSize, mParams.maxTileSize);
+    }
+} // namespace ICR
@@ -7,13 +7,12 @@
 
 namespace ICR
 {
-    DescriptorHeap::DescriptorHeap(Type type) : mType(type), mMaxDescriptors(1024u)
+    DescriptorHeap::DescriptorHeap(Type type) : mType(type), mBaseAddressGPU({ 0u })
     {
-        for (uint32_t i = 0; i < mMaxDescriptors; ++i)
-            mFreeIndices.push(i);
+        // Capacity committed to the allocator up front, it grows from there on demand.
+        uint32_t initialDescriptors = 1024u;
 
-        D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
-        heapDesc.NumDescriptors             = mMaxDescriptors;
+        mPageDesc = {};
 
         switch (mType)
         {
@@ -21,27 +20,47 @@ namespace ICR
             case Constants:
             case RawBuffer:
             {
-                heapDesc.Type   = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-                heapDesc.Flags  = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-                mDescriptorSize = gLogicalDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+                mPageDesc.Type  = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+                mPageDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+                mMaxDescriptors = mType == Texture2D ? 65536u : 1024u;
+                mPageSize       = mMaxDescriptors;
                 break;
             }
 
             case RenderTarget:
             {
-                heapDesc.Type   = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
-                heapDesc.Flags  = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
-                mDescriptorSize = gLogicalDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+                mPageDesc.Type  = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
+                mPageDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+                mMaxDescriptors = 65536u;
+                mPageSize       = 256u;
+                break;
+            }
+
+            case Sampler:
+            {
+                mPageDesc.Type     = D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER;
+                mPageDesc.Flags    = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+                mMaxDescriptors    = D3D12_MAX_SHADER_VISIBLE_SAMPLER_HEAP_SIZE;
+                mPageSize          = mMaxDescriptors;
+                initialDescriptors = 256u;
+                break;
             }
         }
 
-        ThrowIfFailed(gLogicalDevice->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&mHeap)));
+        mPageDesc.NumDescriptors = mPageSize;
+        mDescriptorSize          = gLogicalDevice->GetDescriptorHandleIncrementSize(mPageDesc.Type);
 
-        mBaseAddressCPU = mHeap->GetCPUDescriptorHandleForHeapStart();
+        mAllocator = std::make_unique<BitsetAllocator>(initialDescriptors, mMaxDescriptors);
+
+        mPages.reserve(mMaxDescriptors / mPageSize);
+        mPageAddressesCPU.resize(mMaxDescriptors / mPageSize);
+
+        while (mPages.size() * mPageSize < mAllocator->GetCapacity())
+            CreatePage();
 
         // GPU Addressed only necessary for shader-visible descriptors.
         if (mType != Type::RenderTarget)
-            mBaseAddressGPU = mHeap->GetGPUDescriptorHandleForHeapStart();
+            mBaseAddressGPU = mPages.front()->GetGPUDescriptorHandleForHeapStart();
 
         // Create corresponding descriptor table for root signature creation.
         if (mType != Type::RenderTarget)
@@ -65,6 +84,12 @@ namespace ICR
                     break;
                 }
 
+                case Sampler:
+                {
+                    mTable.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER;
+                    break;
+                }
+
                 case RenderTarget:
                 {
                     // Not needed.
@@ -80,10 +105,8 @@ namespace ICR
         }
     }
 
-    void DescriptorHeap::CreateView(ResourceHandle* pResourceHandle)
+    uint32_t DescriptorHeap::CreateView(ID3D12Resource* pResource)
     {
-        auto* pResource = gResourceRegistry->Get(*pResourceHandle);
-
         auto resourceInfo = pResource->GetDesc();
 
         switch (mType)
@@ -97,9 +120,9 @@ namespace ICR
                 infoSRV.Texture2D.MostDetailedMip       = 0;
                 infoSRV.Texture2D.MipLevels             = resourceInfo.MipLevels;
 
-                pResourceHandle->indexDescriptorTexture2D = Allocate();
-                gLogicalDevice->CreateShaderResourceView(pResource, &infoSRV, GetAddressCPU(pResourceHandle->indexDescriptorTexture2D));
-                break;
+                const uint32_t index = Allocate();
+                gLogicalDevice->CreateShaderResourceView(pResource, &infoSRV, GetAddressCPU(index));
+                return index;
             }
 
             case RenderTarget:
@@ -110,9 +133,9 @@ namespace ICR
                 infoRTV.Texture2D.MipSlice            = 0;
                 infoRTV.Texture2D.PlaneSlice          = 0;
 
-                pResourceHandle->indexDescriptorRenderTarget = Allocate();
-                gLogicalDevice->CreateRenderTargetView(pResource, &infoRTV, GetAddressCPU(pResourceHandle->indexDescriptorRenderTarget));
-                break;
+                const uint32_t index = Allocate();
+                gLogicalDevice->CreateRenderTargetView(pResource, &infoRTV, GetAddressCPU(index));
+                return index;
             }
 
             case Constants:
@@ -121,12 +144,62 @@ namespace ICR
                 infoCBV.BufferLocation                  = pResource->GetGPUVirtualAddress();
                 infoCBV.SizeInBytes                     = static_cast<UINT>(resourceInfo.Width);
 
-                pResourceHandle->indexDescriptorConstants = Allocate();
-                gLogicalDevice->CreateConstantBufferView(&infoCBV, GetAddressCPU(pResourceHandle->indexDescriptorConstants));
-                break;
+                const uint32_t index = Allocate();
+                gLogicalDevice->CreateConstantBufferView(&infoCBV, GetAddressCPU(index));
+                return index;
             }
 
-            default: break;
+            default: throw std::invalid_argument("DescriptorHeap: No views of resources in this heap type.");
         }
     }
+
+    void DescriptorHeap::CreatePage()
+    {
+        ComPtr<ID3D12DescriptorHeap> page;
+        ThrowIfFailed(gLogicalDevice->CreateDescriptorHeap(&mPageDesc, IID_PPV_ARGS(&page)));
+
+        mPageAddressesCPU[mPages.size()] = page->GetCPUDescriptorHandleForHeapStart();
+
+        mPages.push_back(std::move(page));
+    }
+
+    uint32_t DescriptorHeap::AllocateTable(uint32_t count)
+    {
+        // A table has to be contiguous in one heap.
+        if (count > mPageSize)
+            throw std::invalid_argument("DescriptorHeap: Descriptor table larger than a heap page.");
+
+        std::lock_guard<std::mutex> allocatorLock(mAllocatorMutex);
+
+        uint32_t firstIndex = mAllocator->Allocate(count);
+
+        if (firstIndex == BitsetAllocator::kInvalidIndex)
+            throw std::runtime_error("DescriptorHeap: Maximum number of descriptors reached.");
+
+        // Only CPU-only heaps have more than one page, and only single descriptors are allocated from them.
+        if (firstIndex / mPageSize != (firstIndex + count - 1u) / mPageSize)
+        {
+            mAllocator->Free(firstIndex, count);
+            throw std::invalid_argument("DescriptorHeap: Descriptor table spans heap pages.");
+        }
+
+        while (mPages.size() * mPageSize < mAllocator->GetCapacity())
+            CreatePage();
+
+        return firstIndex;
+    }
+
+    void DescriptorHeap::FreeTable(uint32_t firstIndex, uint32_t count)
+    {
+        std::lock_guard<std::mutex> allocatorLock(mAllocatorMutex);
+
+        mAllocator->Free(firstIndex, count);
+    }
+
+    BitsetAllocator::Stats DescriptorHeap::GetStats()
+    {
+        std::lock_guard<std::mutex> allocatorLock(mAllocatorMutex);
+
+        return mAllocator->GetStats();
+    }
 } // namespace ICR
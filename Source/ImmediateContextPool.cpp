@@ -0,0 +1,95 @@
+#include <ImmediateContextPool.h>
+#include <State.h>
+
+namespace ICR
+{
+    ImmediateContextPool::ImmediateContextPool(ID3D12CommandQueue* pQueue, D3D12_COMMAND_LIST_TYPE type) :
+        mQueue(pQueue),
+        mType(type),
+        mFenceValue(0u),
+        mStats()
+    {
+        ThrowIfFailed(gLogicalDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&mFence)));
+    }
+
+    ImmediateContextPool::~ImmediateContextPool() { Wait(mFenceValue); }
+
+    ID3D12GraphicsCommandList* ImmediateContextPool::Acquire()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mStats.acquireCount++;
+
+        const uint64_t completedFenceValue = mFence->GetCompletedValue();
+
+        for (auto& context : mContexts)
+        {
+            if (context.fenceValue == kRecording || context.fenceValue > completedFenceValue)
+                continue;
+
+            ThrowIfFailed(context.allocator->Reset());
+            ThrowIfFailed(context.commandList->Reset(context.allocator.Get(), nullptr));
+
+            context.fenceValue = kRecording;
+
+            return context.commandList.Get();
+        }
+
+        // Everything is in flight or recording, grow the pool.
+        Context context    = {};
+        context.fenceValue = kRecording;
+
+        ThrowIfFailed(gLogicalDevice->CreateCommandAllocator(mType, IID_PPV_ARGS(&context.allocator)));
+        ThrowIfFailed(gLogicalDevice->CreateCommandList(0, mType, context.allocator.Get(), nullptr, IID_PPV_ARGS(&context.commandList)));
+
+        mContexts.push_back(std::move(context));
+
+        mStats.contextCount++;
+
+        return mContexts.back().commandList.Get();
+    }
+
+    uint64_t ImmediateContextPool::Submit(ID3D12GraphicsCommandList* pCmd)
+    {
+        ThrowIfFailed(pCmd->Close());
+
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        auto context = std::find_if(mContexts.begin(), mContexts.end(), [&](const Context& entry) { return entry.commandList.Get() == pCmd; });
+
+        if (context == mContexts.end() || context->fenceValue != kRecording)
+            throw std::runtime_error("ImmediateContextPool: Submitted a command list that was not acquired.");
+
+        ID3D12CommandList* ppCommandLists[] = { pCmd };
+        mQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
+
+        ThrowIfFailed(mQueue->Signal(mFence.Get(), ++mFenceValue));
+
+        context->fenceValue = mFenceValue;
+
+        mStats.submitCount++;
+
+        return mFenceValue;
+    }
+
+    bool ImmediateContextPool::IsComplete(uint64_t token) const { return mFence->GetCompletedValue() >= token; }
+
+    void ImmediateContextPool::Wait(uint64_t token)
+    {
+        if (IsComplete(token))
+            return;
+
+        // Without an event the call blocks until the fence reached the value.
+        ThrowIfFailed(mFence->SetEventOnCompletion(token, nullptr));
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStats.waitCount++;
+    }
+
+    ImmediateContextPool::Stats ImmediateContextPool::GetStats()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        return mStats;
+    }
+} // namespace ICR
@@ -0,0 +1,44 @@
+#ifndef COMMAND_LIST_POOL_H
+#define COMMAND_LIST_POOL_H
+
+#include <RenderGraphRecorder.h>
+
+namespace ICR
+{
+    struct DeviceCommandList
+    {
+        ComPtr<ID3D12CommandAllocator>    allocator;
+        ComPtr<ID3D12GraphicsCommandList> commandList;
+    };
+
+    // Hands out open command lists to worker threads. Each thread records from its own set of allocators, so parallel
+    // recording never shares an allocator, and an allocator is only reset once the GPU has finished executing it.
+    class CommandListPool : private CommandListFactory<DeviceCommandList>
+    {
+    public:
+
+        CommandListPool(D3D12_COMMAND_LIST_TYPE type);
+
+        // Returns a reset, open command list owned by the calling thread.
+        ID3D12GraphicsCommandList* Acquire();
+
+        // Marks every list acquired since the last call as in flight until fenceValue is signaled on gFence.
+        // Call on the render thread once the lists are submitted and no thread is recording.
+        void Retire(uint64_t fenceValue);
+
+        uint32_t GetCommandListCount() const;
+
+        // The lists themselves, for recording through RecordLevels.
+        inline CommandListCache<DeviceCommandList>& GetCache() { return mCache; }
+
+    private:
+
+        void Create(DeviceCommandList& commandList) override;
+        void Reset(DeviceCommandList& commandList) override;
+
+        D3D12_COMMAND_LIST_TYPE             mType;
+        CommandListCache<DeviceCommandList> mCache;
+    };
+} // namespace ICR
+
+#endif
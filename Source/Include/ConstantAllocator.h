@@ -0,0 +1,75 @@
+#ifndef CONSTANT_ALLOCATOR_H
+#define CONSTANT_ALLOCATOR_H
+
+#include <ResourceRegistry.h>
+
+namespace ICR
+{
+    // Linear allocator for per-frame constants, bound through root constant buffer views. A persistently mapped upload buffer is
+    // split into one page per frame in flight, allocations bump through the current page at the constant buffer placement
+    // alignment, and a page is only rewound once the GPU passed the last submission that could read from it. Pages that run out
+    // of space double the buffer, the old one stays mapped and is released through the registry once the GPU is done with it, so
+    // allocations taken before a growth can still be filled afterwards.
+    // Not thread-safe, allocate from the render thread.
+    class ConstantAllocator
+    {
+    public:
+
+        struct Allocation
+        {
+            void*                     pData;
+            D3D12_GPU_VIRTUAL_ADDRESS gpuAddress;
+        };
+
+        struct Stats
+        {
+            uint64_t pageSize;
+            uint64_t frameUsedBytes; // Allocated during the previous frame.
+            uint64_t peakUsedBytes;
+            uint64_t waitCount;
+            uint32_t growCount;
+        };
+
+        ConstantAllocator(uint32_t frameCount, uint64_t initialPageSize);
+        ~ConstantAllocator();
+
+        // Moves on to the next page, waiting for the GPU if it still reads from it. Call once per frame ahead of any allocation.
+        void BeginFrame();
+
+        // The memory is write-combined and only valid for the current frame, it must be filled before the submission reading it.
+        Allocation Allocate(uint64_t size);
+
+        template <typename T>
+        inline Allocation Allocate(const T& data)
+        {
+            auto allocation = Allocate(sizeof(T));
+
+            memcpy(allocation.pData, &data, sizeof(T));
+
+            return allocation;
+        }
+
+        inline Stats GetStats() const { return mStats; }
+
+    private:
+
+        struct Page
+        {
+            uint64_t offset;
+            uint64_t fenceValue; // Signaled on gFence after the last submission that may read from the page.
+        };
+
+        void CreateBuffer(uint64_t pageSize);
+        void ReleaseBuffer();
+
+        ResourceHandle            mBuffer;
+        uint8_t*                  mpMappedData;
+        D3D12_GPU_VIRTUAL_ADDRESS mGPUAddress;
+        uint64_t                  mPageSize;
+        std::vector<Page>         mPages;
+        uint32_t                  mPageIndex;
+        Stats                     mStats;
+    };
+} // namespace ICR
+
+#endif
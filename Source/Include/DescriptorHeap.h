@@ -1,12 +1,15 @@
 #ifndef DESCRIPTOR_HEAP
 #define DESCRIPTOR_HEAP
 
+#include <BitsetAllocator.h>
+
 namespace ICR
 {
-    struct ResourceHandle;
-
     typedef uint32_t DescriptorHeapFlags;
 
+    // Descriptors and contiguous descriptor tables allocated from a bitset that commits capacity page by page. Shader-visible
+    // heaps are reserved at their maximum size up front, since only one of them can be bound and moving it would invalidate
+    // tables referenced by recorded command lists. Render target views are CPU-only and grow in heap pages instead.
     class DescriptorHeap
     {
     public:
@@ -16,42 +19,29 @@ namespace ICR
             Texture2D    = 1 << 0,
             RenderTarget = 1 << 1,
             Constants    = 1 << 2,
-            RawBuffer    = 1 << 3
+            RawBuffer    = 1 << 3,
+            Sampler      = 1 << 4
         };
 
         DescriptorHeap(Type);
 
-        void CreateView(ResourceHandle*);
-        void ReleaseView(ResourceHandle*);
-
-        void CreateView(ID3D12Resource* pResource);
-        void ReleaseView(ID3D12Resource* pResource);
-
-        inline uint32_t Allocate()
-        {
-            if (mFreeIndices.empty())
-                throw std::runtime_error("BindlessDescriptorHeap: Maximum number of descriptors reached.");
-
-            uint32_t index = mFreeIndices.front();
-            mFreeIndices.pop();
+        // Allocates a descriptor and writes the view of the resource the heap type stands for into it, returns its index.
+        uint32_t CreateView(ID3D12Resource* pResource);
 
-            return index;
-        }
-
-        inline void Free(uint32_t index)
-        {
-            if (index >= mMaxDescriptors)
-                throw std::runtime_error("BindlessDescriptorHeap: No descriptors to free.");
+        // Allocate and Free are called by the resource registry from any thread.
+        inline uint32_t Allocate() { return AllocateTable(1u); }
+        inline void     Free(uint32_t index) { FreeTable(index, 1u); }
 
-            mFreeIndices.push(index);
-        }
+        // Contiguous ranges for descriptor tables. Thread-safe like the above.
+        uint32_t AllocateTable(uint32_t count);
+        void     FreeTable(uint32_t firstIndex, uint32_t count);
 
         inline D3D12_CPU_DESCRIPTOR_HANDLE GetAddressCPU(uint32_t index) const
         {
             if (index >= mMaxDescriptors)
                 throw std::invalid_argument("Index out of range.");
 
-            return CD3DX12_CPU_DESCRIPTOR_HANDLE(mBaseAddressCPU, index, mDescriptorSize);
+            return CD3DX12_CPU_DESCRIPTOR_HANDLE(mPageAddressesCPU[index / mPageSize], index % mPageSize, mDescriptorSize);
         }
 
         inline D3D12_GPU_DESCRIPTOR_HANDLE GetAddressGPU(uint32_t index) const
@@ -64,21 +54,29 @@ namespace ICR
 
         inline D3D12_GPU_DESCRIPTOR_HANDLE GetBaseAddressGPU() const { return mBaseAddressGPU; }
 
-        inline ID3D12DescriptorHeap*          GetHeap() const { return mHeap.Get(); }
+        // The shader-visible heap, or the first page of a CPU-only one.
+        inline ID3D12DescriptorHeap*          GetHeap() const { return mPages.front().Get(); }
         inline const D3D12_DESCRIPTOR_RANGE1& GetTable() const { return mTable; }
         inline const CD3DX12_ROOT_PARAMETER1* GetRootParameter() const { return &mRootParameter; }
 
+        BitsetAllocator::Stats GetStats();
+
     private:
 
-        ComPtr<ID3D12DescriptorHeap> mHeap;
-        D3D12_DESCRIPTOR_RANGE1      mTable;
-        CD3DX12_ROOT_PARAMETER1      mRootParameter;
-        Type                         mType;
-        D3D12_CPU_DESCRIPTOR_HANDLE  mBaseAddressCPU;
-        D3D12_GPU_DESCRIPTOR_HANDLE  mBaseAddressGPU;
-        uint32_t                     mMaxDescriptors;
-        uint32_t                     mDescriptorSize;
-        std::queue<int>              mFreeIndices;
+        void CreatePage();
+
+        std::vector<ComPtr<ID3D12DescriptorHeap>> mPages; // Reserved up front, so that growing never moves the addresses.
+        std::vector<D3D12_CPU_DESCRIPTOR_HANDLE>  mPageAddressesCPU;
+        D3D12_DESCRIPTOR_HEAP_DESC                mPageDesc;
+        D3D12_DESCRIPTOR_RANGE1                   mTable;
+        CD3DX12_ROOT_PARAMETER1                   mRootParameter;
+        Type                                      mType;
+        D3D12_GPU_DESCRIPTOR_HANDLE               mBaseAddressGPU;
+        uint32_t                                  mMaxDescriptors;
+        uint32_t                                  mPageSize;
+        uint32_t                                  mDescriptorSize;
+        std::unique_ptr<BitsetAllocator>          mAllocator;
+        std::mutex                                mAllocatorMutex;
     };
 } // namespace ICR
 
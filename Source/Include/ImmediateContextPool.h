@@ -0,0 +1,72 @@
+#ifndef IMMEDIATE_CONTEXT_POOL_H
+#define IMMEDIATE_CONTEXT_POOL_H
+
+namespace ICR
+{
+    // Reusable contexts (command allocator + list) for one-shot GPU work outside of the frame, replacing a fresh allocator, list,
+    // fence and event per submission. A submission hands back a completion token, a value of the pool's fence on its queue,
+    // that can be polled or waited for. Contexts go back to the pool once their token completed. Thread-safe.
+    class ImmediateContextPool
+    {
+    public:
+
+        struct Stats
+        {
+            uint32_t contextCount;  // Created over the pool's life, the rest of the acquisitions were reuses.
+            uint64_t acquireCount;
+            uint64_t submitCount;
+            uint64_t waitCount;
+        };
+
+        ImmediateContextPool(ID3D12CommandQueue* pQueue, D3D12_COMMAND_LIST_TYPE type);
+
+        // Waits for everything submitted.
+        ~ImmediateContextPool();
+
+        // Returns an open command list of an idle context, a new context only if all of them are in flight.
+        ID3D12GraphicsCommandList* Acquire();
+
+        // Closes and submits a list from Acquire, returns its completion token.
+        uint64_t Submit(ID3D12GraphicsCommandList* pCmd);
+
+        bool IsComplete(uint64_t token) const;
+
+        // Blocks until the work of the token completed.
+        void Wait(uint64_t token);
+
+        // Records, submits and waits.
+        inline void Execute(const std::function<void(ID3D12GraphicsCommandList*)>& recordCommands)
+        {
+            auto* pCmd = Acquire();
+
+            recordCommands(pCmd);
+
+            Wait(Submit(pCmd));
+        }
+
+        inline uint64_t GetCompletedToken() const { return mFence->GetCompletedValue(); }
+
+        Stats GetStats();
+
+    private:
+
+        static constexpr uint64_t kRecording = UINT64_MAX;
+
+        struct Context
+        {
+            ComPtr<ID3D12CommandAllocator>    allocator;
+            ComPtr<ID3D12GraphicsCommandList> commandList;
+            uint64_t                          fenceValue;
+        };
+
+        std::mutex                 mMutex;
+        ComPtr<ID3D12CommandQueue> mQueue;
+        D3D12_COMMAND_LIST_TYPE    mType;
+        ComPtr<ID3D12Fence>        mFence;
+        uint64_t                   mFenceValue;
+        std::vector<Context>       mContexts;
+        Stats                      mStats;
+    };
+} // namespace ICR
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef MEDIA_CACHE_H
+#define MEDIA_CACHE_H
+
+#include <ResourceRegistry.h>
+
+namespace ICR
+{
+    // Process-wide cache of decoded ShaderToy media (noise textures, stock images, etc.) keyed by the API "src" path.
+    // Entries are reference counted by the render graphs using them, and unreferenced entries are kept around until
+    // the memory budget forces them out in least-recently-used order.
+    class MediaCache
+    {
+    public:
+
+        struct Media
+        {
+            std::string          src;
+            int                  width  = 0;
+            int                  height = 0;
+            DXGI_FORMAT          format = DXGI_FORMAT_R8G8B8A8_UNORM;
+            std::vector<uint8_t> pixels;
+            ResourceHandle       resource;
+            uint32_t             referenceCount = 0u;
+            uint64_t             lastUseTick    = 0u;
+        };
+
+        struct Stats
+        {
+            uint64_t hits;
+            uint64_t misses;
+            uint64_t evictions;
+            uint64_t memorySize;
+            uint32_t entryCount;
+            uint32_t referencedEntryCount;
+        };
+
+        MediaCache();
+        ~MediaCache();
+
+        // Returns a referenced entry for the media, downloading, decoding and uploading it on a miss (nullptr if that failed).
+        const Media* Acquire(const std::string& src);
+
+        // Drops a reference obtained with Acquire. The entry stays cached until evicted.
+        void Release(const std::string& src);
+
+        // Evicts unreferenced entries until the cache fits the budget.
+        void Trim();
+
+        // Evicts all unreferenced entries.
+        void Clear();
+
+        Stats GetStats() const;
+
+        int mBudgetMB;
+
+    private:
+
+        uint64_t GetMemorySize(const Media& media) const;
+
+        // Decode the downloaded bytes into pMedia, HDR / EXR images keep their range as RGBA16F.
+        bool Decode(const std::vector<uint8_t>& data, Media* pMedia) const;
+
+        void TrimLocked(uint64_t budget);
+
+        mutable std::mutex                                      mMutex;
+        std::unordered_map<std::string, std::unique_ptr<Media>> mEntries;
+        uint64_t                                                mTick;
+        uint64_t                                                mMemorySize;
+        uint64_t                                                mHits;
+        uint64_t                                                mMisses;
+        uint64_t                                                mEvictions;
+    };
+} // namespace ICR
+
+#endif
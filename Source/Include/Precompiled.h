@@ -14,6 +14,7 @@
 #include <dxgidebug.h>
 #include <directsr.h>
 #include <DirectXMath.h>
+#include <DirectXPackedVector.h>
 #include <wrl.h>
 
 #include <D3D12MemAlloc.h>
@@ -42,6 +43,8 @@
 #include <magic_enum/magic_enum.hpp>
 
 #include <stb_image.h>
+#include <stb_image_write.h>
+#include <tinyexr.h>
 
 #include <tbb/tbb.h>
 #include <taskflow/taskflow.hpp>
@@ -49,8 +52,14 @@
 #include <nlohmann/json.hpp>
 
 #include <Windows.h>
+#include <intrin.h>
+#include <immintrin.h>
 #include <format>
 #include <set>
+#include <queue>
+#include <list>
+#include <random>
+#include <regex>
 #include <fstream>
 
 #include <spirv_to_dxil.h>
@@ -4,6 +4,14 @@
 #include <Util.h>
 #include <RenderInput.h>
 #include <ResourceRegistry.h>
+#include <VideoStream.h>
+#include <CommandListPool.h>
+#include <ConstantAllocator.h>
+#include <RenderTargetPool.h>
+#include <RenderGraphCompiler.h>
+#include <RenderGraphSchedule.h>
+#include <TileScheduler.h>
+#include <ResolutionScaleController.h>
 
 namespace ICR
 {
@@ -15,6 +23,25 @@ namespace ICR
         {
         public:
 
+            // Output precision of buffer passes, the image pass always writes RGBA8. Auto uses the format picked by
+            // the precision verification of the render graph, full precision until one was picked.
+            enum class OutputPrecision
+            {
+                Auto,
+                RGBA32F,
+                RGBA16F,
+                R11G11B10F
+            };
+
+            // How often a buffer pass renders. Skipped frames keep its output (current and history) as it was last rendered,
+            // and the pass sees its own frame counter and time delta (iFrame, iTimeDelta) spanning its updates.
+            enum class UpdateRate
+            {
+                EveryFrame,
+                EveryNthFrame,
+                OnDemand
+            };
+
             struct Args
             {
                 ID3D12RootSignature*  pRootSignature;
@@ -23,29 +50,173 @@ namespace ICR
             };
 
             RenderPass(const Args& args);
+            ~RenderPass();
 
+            // Writes the input views (both frame indices) into the pass's table in the global Texture2D heap, allocated on first
+            // use. Rewritten in place on re-allocations, nothing reading the table may be in flight.
             void CreateInputResourceDescriptorTable(const std::unordered_map<int, std::array<ResourceHandle, 2>>& resourceCache);
 
-            void CreateOutputTargets();
+            // Output targets are allocated by the render graph, single-buffered outputs use the same handle in both slots.
+            void SetOutputTargets(const std::array<ResourceHandle, 2>& outputTargets);
+            void ReleaseOutputTargets();
+
+            // Hands the output targets over to the caller (e.g. back into the pool) instead of releasing them.
+            std::array<ResourceHandle, 2> DetachOutputTargets();
+
+            // Inputs sampled from the previous frame (self-references and outputs of passes scheduled later).
+            inline void SetHistoryInputIDs(const std::vector<int>& historyInputIDs) { mHistoryInputIDs = historyInputIDs; }
+            inline bool IsHistoryInput(int inputID) const
+            {
+                return std::find(mHistoryInputIDs.begin(), mHistoryInputIDs.end(), inputID) != mHistoryInputIDs.end();
+            }
+
+            // Both switch the PSO to the resulting output format (compiled on first use), the output targets have to be re-allocated.
+            void SetOutputPrecision(OutputPrecision outputPrecision);
+            void SetAutoOutputFormat(DXGI_FORMAT autoOutputFormat);
+
+            // Changing between every frame and a decimated rate changes how the output is backed, the targets have to be re-allocated.
+            void SetUpdateRate(UpdateRate updateRate, int updateInterval);
+
+            // Renders in the next graph execution regardless of the update rate.
+            inline void RequestUpdate() { mUpdateRequested = true; }
+
+            // The output targets were (re-)created or cleared, both slots match and the pass renders in the next execution.
+            void ResetUpdates();
+
+            // Decides whether a decimated pass renders in the upcoming graph execution, deltaTime is the time that execution spans.
+            void AdvanceFrame(float deltaTime);
 
             void Dispatch(ID3D12GraphicsCommandList* pCmd);
 
+            inline const std::string&                  GetName() const { return mName; }
             inline const int&                          GetOutputID() const { return mOutputID; }
             inline const std::vector<int>&             GetInputIDs() const { return mInputIDs; }
             inline const std::vector<uint32_t>&        GetSPIRV() const { return mSPIRV; }
+            inline const std::vector<uint8_t>&         GetDXIL() const { return mDXIL; }
             inline const std::array<ResourceHandle, 2> GetOutputResources() const { return mOutputTargets; }
+            inline OutputPrecision                     GetOutputPrecision() const { return mOutputPrecision; }
+            inline bool                                IsIntermediate() const { return mIntermediateRenderPass; }
+            inline UpdateRate                          GetUpdateRate() const { return mUpdateRate; }
+            inline int                                 GetUpdateInterval() const { return mUpdateInterval; }
+            inline bool                                IsDecimated() const { return mUpdateRate != UpdateRate::EveryFrame; }
+            inline bool                                IsSkipped() const { return mSkipped; }
+            inline bool                                IsOutputStale() const { return mOutputStale; }
+            inline int                                 GetUpdateCount() const { return mUpdateCount; }
+            inline float                               GetUpdateDeltaTime() const { return mUpdateDeltaTime; }
+            DXGI_FORMAT                                GetOutputFormat() const;
 
         private:
 
-            int                           mOutputID;
-            std::vector<int>              mInputIDs;
-            ComPtr<ID3D12PipelineState>   mPSO;
-            ComPtr<ID3D12DescriptorHeap>  mInputSamplerDescriptorHeap;
-            ComPtr<ID3D12DescriptorHeap>  mInputResourceDescriptorHeap;
-            std::vector<uint32_t>         mSPIRV;
-            std::array<ResourceHandle, 2> mOutputTargets;
-            std::unordered_map<int, int>  mInputToChannelMap;
-            bool                          mIntermediateRenderPass;
+            void UpdatePipelineState();
+
+            std::string                                                  mName;
+            int                                                          mOutputID;
+            std::vector<int>                                             mInputIDs;
+            std::vector<int>                                             mHistoryInputIDs;
+            ID3D12RootSignature*                                         mpRootSignature;
+            std::vector<uint8_t>                                         mDXIL;
+            std::unordered_map<DXGI_FORMAT, ComPtr<ID3D12PipelineState>> mPipelineStates; // Per output format.
+            ID3D12PipelineState*                                         mpPipelineState;
+            OutputPrecision                                              mOutputPrecision;
+            DXGI_FORMAT                                                  mAutoOutputFormat;
+            uint32_t                                                     mSamplerTable; // Shared, in the registry's Sampler heap.
+            uint32_t                                                     mInputTable;   // Channels of frame index 0, then 1.
+            std::vector<uint32_t>                                        mSPIRV;
+            std::array<ResourceHandle, 2>                                mOutputTargets;
+            std::unordered_map<int, int>                                 mInputToChannelMap;
+            bool                                                         mIntermediateRenderPass;
+            UpdateRate                                                   mUpdateRate;
+            int                                                          mUpdateInterval;
+            bool                                                         mUpdateRequested;
+            bool                                                         mSkipped;
+            bool                                                         mOutputStale; // History slot is newer than current.
+            int                                                          mFramesSinceUpdate;
+            float                                                        mTimeSinceUpdate;
+            int                                                          mUpdateCount;
+            float                                                        mUpdateDeltaTime;
+        };
+
+        // Fully built render graph for a single shader at a single resolution. Owns every pass (PSO, targets, descriptor tables)
+        // and a reference to its media, so that it can be parked in the render graph cache and restored without any rebuild work.
+        struct RenderGraph
+        {
+            using LevelAccesses = std::vector<std::vector<RenderGraphCompiler::PassAccess>>;
+
+            struct VideoChannel
+            {
+                int                          inputID;
+                int                          channel;
+                std::unique_ptr<VideoStream> stream;
+            };
+
+            ~RenderGraph();
+
+            // How a pass output is backed: double-buffered when it is read across frames, otherwise a single target
+            // placed into the transient heap, aliasing outputs whose lifetimes (in levels) do not overlap. Decimated passes
+            // keep their output over skipped frames, so they never alias. Exact targets are all placed into the heap.
+            struct OutputAllocation
+            {
+                RenderPass*             pRenderPass;
+                bool                    history;
+                bool                    persistent; // Single target of its own.
+                bool                    placed;     // In the transient heap, otherwise drawn from the render target pool.
+                uint64_t                size;       // At the capacity.
+                std::array<uint64_t, 2> heapOffsets; // Of placed outputs, the second one for the other buffer of history.
+                size_t                  firstLevel;
+                size_t                  lastLevel;
+            };
+
+            // Schedules the passes into levels of mutually independent passes, dispatched in order every frame, and resolves
+            // which inputs are sampled from the previous frame.
+            void Compile();
+
+            // (Re-)allocates the output memory at the capacity, creates the targets in it and collects the resources each level
+            // reads and writes.
+            void AllocateOutputTargets();
+            void ReleaseOutputTargets();
+
+            // Keeps the output memory while the resolution fits its capacity, and does not drop too far below it, otherwise
+            // re-allocates it with some headroom. Exact targets are re-created at the new resolution in place. Returns whether the
+            // memory was re-allocated.
+            bool Resize(const DirectX::XMINT2& newResolution);
+
+            // Creates the placed targets in the transient heap, at the resolution for exact targets, otherwise at the capacity.
+            void CreatePlacedOutputTargets();
+            void RecreatePlacedOutputTargets();
+
+            // Builds the input tables and level accesses of the current targets, and restarts their barrier tracking.
+            void PrepareOutputTargets(const std::vector<std::pair<uint32_t, ResourceState>>& pooledStates);
+
+            // Rendered fraction of the output targets, (1, 1) without dynamic resolution.
+            DirectX::XMFLOAT2 GetRenderScale() const;
+
+            // Approximate memory footprint used for the render graph cache budgets.
+            uint64_t GetDeviceMemorySize() const;
+
+            // What the output targets would take if every one of them was double-buffered.
+            uint64_t GetDoubleBufferedMemorySize() const;
+            uint64_t GetHostMemorySize() const;
+
+            std::string                                            shaderID;
+            DirectX::XMINT2                                        resolution;
+            DirectX::XMINT2                                        renderResolution; // Rendered sub-rect of the targets, see Render().
+            DirectX::XMINT2                                        capacity = { 0, 0 }; // Size the output memory is allocated for.
+            bool                                                   dynamicResolution = false; // Renders a sub-rect, see Resize().
+            bool                                                   exactTargets = false; // Targets at exactly the resolution.
+            std::unique_ptr<RenderGraphSchedule>                   schedule;
+            std::vector<std::vector<RenderPass*>>                  levels;
+            std::vector<RenderPass*>                               culledRenderPasses; // Not reaching the final pass, never run.
+            std::array<LevelAccesses, 2>                           levelAccesses; // Indexed by the current frame index.
+            std::vector<OutputAllocation>                          outputAllocations;
+            ComPtr<D3D12MA::Allocation>                            transientHeap;
+            RenderGraphCompiler                                    barrierCompiler;
+            std::vector<ResourceHandle>                            pendingClears;
+            std::string                                            commonShaderGLSL;
+            std::vector<std::unique_ptr<RenderPass>>               renderPasses;
+            RenderPass*                                            pFinalRenderPass = nullptr;
+            std::unordered_map<int, std::array<ResourceHandle, 2>> resourceCache;
+            std::vector<std::string>                               mediaSources;
+            std::vector<VideoChannel>                              videoChannels;
         };
 
         enum AsyncCompileShaderToyStatus
@@ -58,7 +229,7 @@ namespace ICR
 
         struct alignas(16) Constants
         {
-            DirectX::XMFLOAT4 iAppParams0;
+            DirectX::XMFLOAT4 iAppParams0 = { 1.0f, 1.0f, 0.0f, 0.0f };
 
             DirectX::XMFLOAT3 iResolution;
             float             _padding0;
@@ -83,6 +254,20 @@ namespace ICR
             DirectX::XMFLOAT4 padding[5];
         };
 
+        // Render of a single frame at a resolution beyond the viewport, in tiles streamed back into an image. Render() works
+        // through the tiles in place of the interactive frames until it finishes.
+        struct TiledRender
+        {
+            DirectX::XMINT2                       resolution;
+            bool                                  tileTargets; // Targets are tile-sized, otherwise full-size and scissored.
+            int                                   frameCount; // Accumulated per tile, the last one is kept.
+            float                                 time;
+            std::unique_ptr<TileScheduler>        scheduler;
+            ResourceHandle                        readbackBuffer;
+            std::vector<uint8_t>                  image; // RGBA8.
+            std::chrono::steady_clock::time_point start;
+        };
+
         RenderInputShaderToy();
         ~RenderInputShaderToy();
 
@@ -94,29 +279,60 @@ namespace ICR
 
     private:
 
+        void LoadShaderToy();
         bool CompileShaderToy(const std::string& shaderID);
-        bool BuildRenderGraph(const nlohmann::json& parsedShaderToy);
+        bool BuildRenderGraph(const std::string& shaderID, const nlohmann::json& parsedShaderToy);
+
+        // Records one execution of the graph into pooled command lists, returns the barriers that make the final output readable
+        // after them. These are recorded at the end of the graph when requested, for executions that are not presented.
+        // With decimation, passes skipped by their update rate are left out, and the updating ones read their own constants
+        // (by render pass index) instead of the shared ones.
+        std::vector<ResourceBarrier> RecordRenderGraph(std::vector<ID3D12CommandList*>&                 graphCommandLists,
+                                                       D3D12_GPU_VIRTUAL_ADDRESS                        constantsAddress,
+                                                       const std::vector<ConstantAllocator::Allocation>& renderPassConstants,
+                                                       const D3D12_RECT&                                scissor,
+                                                       bool                                             updateVideo,
+                                                       bool                                             recordExitBarriers,
+                                                       bool                                             decimate);
+
+        // Picks the cheapest output format for each buffer pass on auto precision that keeps the presented image above the PSNR
+        // threshold, compared against rendering everything at full precision. Blocks on the GPU, run as a pre-render task.
+        void                 VerifyOutputPrecision();
+        std::vector<uint8_t> RenderPrecisionTestWindow();
+
+        bool StartTiledRender();
+        void RenderTiles();
+        void FinishTiledRender(bool cancel);
+
+        // Render graph cache (LRU, most recently used at the front).
+        bool RestoreCachedRenderGraph(const std::string& shaderID);
+        void RetireRenderGraph();
+        void TrimRenderGraphCache();
 
 #ifdef _DEBUG
         nlohmann::json mShaderAPIRequestResult;
 #endif
 
-        ResourceHandle mUBO;
-        void*          mpUBOData;
-
-        tf::Taskflow                                           mRenderGraph;
-        std::string                                            mCommonShaderGLSL;
-        ID3D12GraphicsCommandList*                             mpActiveCommandList;
-        std::vector<std::unique_ptr<RenderPass>>               mRenderPasses;
-        RenderPass*                                            mpFinalRenderPass;
-        std::string                                            mShaderID;
-        bool                                                   mInitialized;
-        ComPtr<ID3D12PipelineState>                            mPSO;
-        ComPtr<ID3D12RootSignature>                            mRootSignature;
-        std::atomic<AsyncCompileShaderToyStatus>               mAsyncCompileStatus;
-        bool                                                   mUserRequestUnload;
-        std::unordered_map<int, std::array<ResourceHandle, 2>> mResourceCache;
-        std::vector<ResourceHandle>                            mMediaResources;
+        std::unique_ptr<RenderGraph>             mRenderGraph;
+        std::list<std::unique_ptr<RenderGraph>>  mRenderGraphCache;
+        int                                      mRenderGraphCacheBudgetDeviceMB;
+        int                                      mRenderGraphCacheBudgetHostMB;
+        float                                    mOutputPrecisionThresholdPSNR;
+        int                                      mIterationsPerFrame;
+        std::unique_ptr<TiledRender>             mTiledRender;
+        int                                      mTiledRenderResolution[2];
+        int                                      mTiledRenderFrameCount;
+        float                                    mTiledRenderTargetTileMs;
+        bool                                     mTiledRenderConfirmMultiPass;
+        bool                                     mDynamicResolution;
+        ResolutionScaleController                mResolutionScaleController;
+        std::unique_ptr<CommandListPool>         mCommandListPool;
+        std::string                              mShaderID;
+        bool                                     mInitialized;
+        ComPtr<ID3D12PipelineState>              mPSO;
+        ComPtr<ID3D12RootSignature>              mRootSignature;
+        std::atomic<AsyncCompileShaderToyStatus> mAsyncCompileStatus;
+        bool                                     mUserRequestUnload;
     };
 } // namespace ICR
 
@@ -0,0 +1,106 @@
+#ifndef RENDER_TARGET_POOL_H
+#define RENDER_TARGET_POOL_H
+
+#include <ResourceRegistry.h>
+#include <RenderGraphCompiler.h>
+
+namespace ICR
+{
+    // Keeps the render targets and transient heaps of released render graphs around for the next ones, so that shader switches
+    // and resizes stop creating committed resources once the pool is warm. Targets are matched by format, size and flags and
+    // keep their descriptor views, heaps are matched by size. Nothing is ever handed back to the registry on return unless the
+    // free memory exceeds the cap, the free entries unused for the longest go first then. Entries that were not reused for a
+    // while are trimmed once per frame. Thread-safe, render graphs are built on the task group.
+    class RenderTargetPool
+    {
+    public:
+
+        struct Stats
+        {
+            uint32_t freeTargetCount;
+            uint32_t freeHeapCount;
+            uint64_t freeBytes;
+            uint64_t acquireCount;
+            uint64_t hitCount;
+            uint64_t trimCount; // Entries released by age or by the memory cap.
+            uint64_t maxFreeBytes;
+            uint32_t maxAgeFrames;
+        };
+
+        RenderTargetPool(uint64_t maxFreeBytes, uint32_t maxAgeFrames);
+        ~RenderTargetPool();
+
+        // Returns a free target of the description, or creates one. A pooled target comes back in the state its last owner left
+        // it in (pState), and with whatever it held, new owners have to clear or overwrite it.
+        ResourceHandle Acquire(const CD3DX12_RESOURCE_DESC&     resourceInfo,
+                               DescriptorHeapFlags              descriptorHeapFlags,
+                               ResourceRegistry::MemoryCategory category,
+                               ResourceState*                   pState);
+
+        // Hands a target back along with its current state. Work still in flight on the queue may use it, later users of the
+        // pool record their work behind it.
+        void Release(const ResourceHandle& handle, ResourceState state);
+
+        // Same for transient heaps, resources placed into a returned heap have to be released along with it. Only heaps of the
+        // default placement alignment are pooled, which any heap returned satisfies.
+        ComPtr<D3D12MA::Allocation> AcquireHeap(const D3D12_RESOURCE_ALLOCATION_INFO& allocationInfo);
+        void                        ReleaseHeap(ComPtr<D3D12MA::Allocation>&& heap);
+
+        // Ages the free entries by a frame and releases the ones older than the maximum age. Call once per frame.
+        void BeginFrame();
+
+        // Releases every free entry.
+        void Clear();
+
+        void SetMaxFreeBytes(uint64_t maxFreeBytes);
+        void SetMaxAgeFrames(uint32_t maxAgeFrames);
+
+        Stats GetStats();
+
+    private:
+
+        struct Key
+        {
+            DXGI_FORMAT          format;
+            uint64_t             width;
+            uint32_t             height;
+            D3D12_RESOURCE_FLAGS flags;
+            DescriptorHeapFlags  descriptorHeapFlags;
+
+            bool operator==(const Key&) const = default;
+        };
+
+        struct KeyHash
+        {
+            size_t operator()(const Key& key) const;
+        };
+
+        struct FreeTarget
+        {
+            ResourceHandle handle;
+            ResourceState  state;
+            uint64_t       size;
+            uint64_t       releaseFrame;
+        };
+
+        struct FreeHeap
+        {
+            ComPtr<D3D12MA::Allocation> heap;
+            uint64_t                    releaseFrame;
+        };
+
+        // Releases free entries to the registry, the ones released to the pool before the frame first, until the free memory
+        // fits the cap. Called with the mutex held.
+        void Trim(uint64_t olderThanFrame, uint64_t maxFreeBytes);
+
+        std::mutex                                                mMutex;
+        std::unordered_map<Key, std::vector<FreeTarget>, KeyHash> mFreeTargets;
+        std::unordered_map<uint64_t, std::vector<FreeHeap>>       mFreeHeaps; // By size.
+        uint64_t                                                  mMaxFreeBytes;
+        uint32_t                                                  mMaxAgeFrames;
+        uint64_t                                                  mFrame;
+        Stats                                                     mStats;
+    };
+} // namespace ICR
+
+#endif
@@ -2,87 +2,174 @@
 #define RESOURCE_REGISTRY_H
 
 #include <DescriptorHeap.h>
+#include <ResourceTable.h>
 
 namespace ICR
 {
-    struct ResourceHandle
+    // What the registry's table holds per resource. Render target heaps are released through the table as well, with only the
+    // allocation set.
+    struct DeviceResource
     {
-        uint32_t indexResource               = UINT_MAX;
-        uint32_t indexDescriptorTexture2D    = UINT_MAX;
-        uint32_t indexDescriptorRenderTarget = UINT_MAX;
-        uint32_t indexDescriptorConstants    = UINT_MAX;
-        uint32_t indexDescriptorRawBuffer    = UINT_MAX;
+        ComPtr<ID3D12Resource>      primitive;
+        ComPtr<D3D12MA::Allocation> primitiveAlloc; // Null for externally created and placed resources.
     };
 
-    class ResourceRegistry
+    // Creates the device resources and their views, the bookkeeping of handles, deferred releases and memory is the table's
+    // (see ResourceTable). Creation and release are thread-safe (e.g. render graph builds on the task group while the render
+    // thread resizes the swap chain).
+    class ResourceRegistry : private ResourceFactory<DeviceResource>
     {
     public:
 
-        struct Resource
+        using MemoryCategory       = ICR::MemoryCategory;
+        using MemoryCategoryStats  = ICR::MemoryCategoryStats;
+        using DeferredReleaseStats = ResourceTable<DeviceResource>::DeferredReleaseStats;
+
+        static constexpr size_t kMemoryCategoryCount = ICR::kMemoryCategoryCount;
+
+        struct MemoryStats
         {
-            ComPtr<ID3D12Resource>      primitive;
-            ComPtr<D3D12MA::Allocation> primitiveAlloc;
+            std::array<MemoryCategoryStats, kMemoryCategoryCount> categories;
+            uint64_t                                              trackedBytes;
+            uint64_t                                              peakTrackedBytes;
+            uint64_t                                              allocatorBytes;      // Through D3D12MA, all but the swap chain.
+            uint64_t                                              allocatorBlockBytes; // Device heaps D3D12MA suballocates from.
+            uint64_t                                              localUsageBytes;     // Process-wide, as reported by the OS.
+            uint64_t                                              localBudgetBytes;
+            uint64_t                                              nonLocalUsageBytes;
+            uint64_t                                              nonLocalBudgetBytes;
         };
 
         ResourceRegistry();
 
         // Creates a device resource with bound memory and returns a handle.
-        ResourceHandle Create(const CD3DX12_RESOURCE_DESC& resourceInfo, DescriptorHeapFlags descriptorHeapFlags, bool hostVisible = false);
+        ResourceHandle Create(const CD3DX12_RESOURCE_DESC& resourceInfo,
+                              DescriptorHeapFlags          descriptorHeapFlags,
+                              bool                         hostVisible = false,
+                              MemoryCategory               category    = MemoryCategory::Other);
 
         // Optional version that can wrap an existing D3D12 resource with a handle + descriptor views.
-        ResourceHandle Create(ID3D12Resource* pResource, DescriptorHeapFlags descriptorHeapFlags);
+        ResourceHandle Create(ID3D12Resource* pResource, DescriptorHeapFlags descriptorHeapFlags, MemoryCategory category = MemoryCategory::Other);
 
-        // Same as above but copies data to the created with staging buffer.
+        // Same as above but uploads data into the created resource through gUploadQueue. The copy is only recorded, it has
+        // to be flushed and completed (UploadQueue::Finish) before the resource is used.
         ResourceHandle CreateWithData(const CD3DX12_RESOURCE_DESC& resourceInfo,
                                       DescriptorHeapFlags          descriptorHeapFlags,
                                       const void*                  data,
-                                      size_t                       size);
+                                      size_t                       size,
+                                      MemoryCategory               category = MemoryCategory::Other);
 
-        void BindDescriptorHeaps(ID3D12GraphicsCommandList* pCmd, DescriptorHeapFlags descriptorHeapFlags);
+        // Version taking data for the subresources of the resource, starting at the first one.
+        ResourceHandle CreateWithData(const CD3DX12_RESOURCE_DESC&  resourceInfo,
+                                      DescriptorHeapFlags           descriptorHeapFlags,
+                                      const D3D12_SUBRESOURCE_DATA* pSubresources,
+                                      uint32_t                      subresourceCount,
+                                      MemoryCategory                category = MemoryCategory::Other);
 
-        // Frees a resource with a provided handle.
-        void Release(const ResourceHandle& handle);
+        // Creates a buffer in host memory that copies can be written into and read back from (starts as a copy destination).
+        ResourceHandle CreateReadback(uint64_t size);
 
-        inline uint32_t Allocate()
-        {
-            if (mFreeIndices.empty())
-                throw std::runtime_error("BindlessDescriptorHeap: Maximum number of descriptors reached.");
+        // Allocates render target memory that the caller owns and can place (aliasing) resources into. Accounted as pass
+        // outputs, the resources placed into it take no memory of their own.
+        ComPtr<D3D12MA::Allocation> AllocateRenderTargetHeap(const D3D12_RESOURCE_ALLOCATION_INFO& allocationInfo);
 
-            uint32_t index = mFreeIndices.front();
+        // Hands a heap from AllocateRenderTargetHeap back, it is destroyed with the deferred releases.
+        void ReleaseRenderTargetHeap(ComPtr<D3D12MA::Allocation>&& heap);
 
-            mFreeIndices.pop();
+        // Creates a resource placed at an offset into a heap from AllocateRenderTargetHeap, the heap must outlive it.
+        ResourceHandle CreatePlaced(const CD3DX12_RESOURCE_DESC& resourceInfo,
+                                    DescriptorHeapFlags          descriptorHeapFlags,
+                                    D3D12MA::Allocation*         pHeap,
+                                    uint64_t                     heapOffset);
 
-            return index;
-        }
+        void BindDescriptorHeaps(ID3D12GraphicsCommandList* pCmd, DescriptorHeapFlags descriptorHeapFlags);
 
-        inline void Free(uint32_t index)
+        // Returns the first index of a table in the sampler heap holding the samplers. Identical tables are shared and live
+        // as long as the registry, there are only a few distinct ones.
+        uint32_t GetSamplerTable(const D3D12_SAMPLER_DESC* pSamplers, uint32_t samplerCount);
+
+        inline uint32_t GetSamplerTableCount()
         {
-            if (index >= mMaxAllocations)
-                throw std::runtime_error("BindlessDescriptorHeap: No descriptors to free.");
+            std::lock_guard<std::mutex> samplerTablesLock(mSamplerTablesMutex);
 
-            mFreeIndices.push(index);
+            return static_cast<uint32_t>(mSamplerTables.size());
         }
 
-        inline ID3D12Resource* Get(const ResourceHandle& handle) const
+        // Hands a table from DescriptorHeap::AllocateTable back, it is freed with the deferred releases.
+        void ReleaseDescriptorTable(DescriptorHeap::Type type, uint32_t firstIndex, uint32_t count);
+
+        // Retires the handle right away, but defers destroying the resource and its descriptors until the GPU is done with
+        // every frame that may still reference it (see ProcessDeferredReleases).
+        void Release(const ResourceHandle& handle);
+
+        // Destroys the resource right away, for when the caller waited for the device and needs it gone (e.g. swap chain
+        // buffers before ResizeBuffers).
+        void ReleaseImmediate(const ResourceHandle& handle);
+
+        // Called by the render thread after every fence wait: destroys the deferred releases whose fence value completed, and
+        // tags the ones released since the last call with nextFenceValue, the next value signaled after any work that could
+        // still reference them.
+        void ProcessDeferredReleases(uint64_t completedFenceValue, uint64_t nextFenceValue);
+
+        // Destroys every deferred release, the device must be idle.
+        inline void FlushDeferredReleases() { mTable.FlushDeferredReleases(); }
+
+        inline DeferredReleaseStats GetDeferredReleaseStats() { return mTable.GetDeferredReleaseStats(); }
+
+        // Throws std::runtime_error for invalid handles, and for stale ones whose resource was released.
+        inline ID3D12Resource* Get(const ResourceHandle& handle) const { return mTable.Get(handle).primitive.Get(); }
+
+        // Size of the memory backing a resource (zero for externally created resources).
+        inline uint64_t GetAllocationSize(const ResourceHandle& handle) const
         {
-            if (handle.indexResource == UINT_MAX)
-                throw std::runtime_error("ResourceRegistry: Invalid resource handle.");
+            const auto& primitiveAlloc = mTable.Get(handle).primitiveAlloc;
 
-            return mResources[handle.indexResource].primitive.Get();
+            return primitiveAlloc ? primitiveAlloc->GetSize() : 0u;
         }
 
+        inline uint32_t GetLiveResourceCount() const { return mTable.GetLiveCount(); }
+
         inline DescriptorHeap* GetDescriptorHeap(DescriptorHeap::Type type) const { return mDescriptorHeaps.at(type).get(); }
 
+        // Per-category accounting of the resources and heaps, next to what D3D12MA and the OS report.
+        MemoryStats GetMemoryStats();
+
+        // Moves the memory of a resource to another category, for resources that change hands (e.g. pooled render targets).
+        inline void SetMemoryCategory(const ResourceHandle& handle, MemoryCategory category) { mTable.SetMemoryCategory(handle, category); }
+
+        // Attributes the peak of the tracked memory to a scope (e.g. the shader being rendered) from now on, until the next call.
+        inline void SetMemoryScope(const std::string& scope) { mTable.SetMemoryScope(scope); }
+
+        inline std::unordered_map<std::string, uint64_t> GetMemoryScopePeaks() { return mTable.GetMemoryScopePeaks(); }
+
+        // The memory stats, the peak of every scope and the detailed D3D12MA statistics, for dumping to disk.
+        nlohmann::json GetMemoryReport();
+
+        // Logs every resource that is still alive, call once everything should have been released and the device is idle.
+        // Returns the number of leaked resources.
+        uint32_t ReportLeaks();
+
     private:
 
-        void AddResourceToDescriptorHeaps(ResourceHandle& handle, DescriptorHeapFlags descriptorHeapFlags);
+        // Views go to the descriptor heap of the same type, DescriptorHeap::Type and the view bits are the same.
+        static_assert(DescriptorHeap::Type::Texture2D == 1u << static_cast<uint32_t>(ResourceView::Texture2D));
+        static_assert(DescriptorHeap::Type::RenderTarget == 1u << static_cast<uint32_t>(ResourceView::RenderTarget));
+        static_assert(DescriptorHeap::Type::Constants == 1u << static_cast<uint32_t>(ResourceView::Constants));
+
+        uint32_t CreateView(const DeviceResource& resource, ResourceView view) override;
+        void     FreeDescriptors(uint32_t heapType, uint32_t firstIndex, uint32_t count) override;
+        void     Destroy(DeviceResource& resource) override;
+
+        ComPtr<D3D12MA::Allocator> mAllocator;
 
-        ResourceHandle                                                            mStagingBuffer;
-        uint32_t                                                                  mMaxAllocations;
-        ComPtr<D3D12MA::Allocator>                                                mAllocator;
-        std::vector<Resource>                                                     mResources;
-        std::queue<int>                                                           mFreeIndices;
         std::unordered_map<DescriptorHeap::Type, std::unique_ptr<DescriptorHeap>> mDescriptorHeaps;
+
+        // Keyed by the raw bytes of the sampler descriptions.
+        std::mutex                                mSamplerTablesMutex;
+        std::unordered_map<std::string, uint32_t> mSamplerTables;
+
+        // Declared last, the resources it holds go before the allocator and the heaps.
+        ResourceTable<DeviceResource> mTable;
     };
 } // namespace ICR
 
@@ -8,6 +8,10 @@ namespace ICR
 {
     class Blitter;
     class ResourceRegistry;
+    class MediaCache;
+    class UploadQueue;
+    class ConstantAllocator;
+    class RenderTargetPool;
 
     struct ResourceHandle;
 
@@ -60,6 +64,9 @@ namespace ICR
     extern MovingAverage                                     gDeltaTimeMovingAverage;
     extern ScrollingBuffer                                   gDeltaTimeBuffer;
     extern ScrollingBuffer                                   gDeltaTimeMovingAverageBuffer;
+    extern int                                               gPerformanceGraphMode;
+    extern float                                             gResolutionScale;
+    extern ScrollingBuffer                                   gResolutionScaleBuffer;
     extern int                                               gSyncInterval;
     extern uint32_t                                          gUpdateFlags;
     extern DirectX::XMINT2                                   gBackBufferSize;
@@ -75,6 +82,10 @@ namespace ICR
     extern std::unordered_map<std::string, ComPtr<ID3DBlob>> gShaderDXIL;
     extern std::unique_ptr<Blitter>                          gBlitter;
     extern std::unique_ptr<ResourceRegistry>                 gResourceRegistry;
+    extern std::unique_ptr<MediaCache>                       gMediaCache;
+    extern std::unique_ptr<UploadQueue>                      gUploadQueue;
+    extern std::unique_ptr<ConstantAllocator>                gConstantAllocator;
+    extern std::unique_ptr<RenderTargetPool>                 gRenderTargetPool;
 
 } // namespace ICR
 
@@ -0,0 +1,79 @@
+#ifndef UPLOAD_QUEUE_H
+#define UPLOAD_QUEUE_H
+
+#include <ImmediateContextPool.h>
+#include <ResourceRegistry.h>
+#include <RingAllocator.h>
+
+namespace ICR
+{
+    // Batches CPU to GPU uploads: data is copied into a persistently mapped staging ring and the copies are recorded into one
+    // open command list, which goes out on a copy queue in a single submission per Flush. The ring grows into a larger buffer
+    // when an upload does not fit, the old one is released once the copies reading from it completed.
+    // Thread-safe, uploads from several threads share the open batch.
+    class UploadQueue
+    {
+    public:
+
+        struct Stats
+        {
+            uint64_t uploadCount;
+            uint64_t uploadBytes;
+            uint64_t submissionCount;
+            uint64_t waitCount;
+            uint64_t stagingCapacity;
+            uint32_t stagingGrowCount;
+        };
+
+        UploadQueue(uint64_t initialStagingCapacity);
+        ~UploadQueue();
+
+        // Copies the subresources into staging and records their copies into the open batch. The destination must be in the
+        // common state (buffers or textures the GPU is not using yet) and stay alive until the batch completed.
+        void Upload(ID3D12Resource* pDestination, uint32_t firstSubresource, const D3D12_SUBRESOURCE_DATA* pSubresources, uint32_t subresourceCount);
+
+        // Submits the open batch and returns its completion token, or the last submitted one if nothing was pending.
+        uint64_t Flush();
+
+        // Blocks until the batch with the token completed.
+        void Wait(uint64_t token);
+
+        // Submits and waits for everything uploaded so far.
+        inline void Finish() { Wait(Flush()); }
+
+        Stats GetStats();
+
+        inline ImmediateContextPool::Stats GetContextStats() { return mContexts->GetStats(); }
+
+    private:
+
+        struct StagingBuffer
+        {
+            ResourceHandle resource;
+            uint8_t*       pMappedData;
+            uint64_t       fenceValue; // Last batch reading from it, for retired buffers.
+        };
+
+        static constexpr uint64_t kUntagged = UINT64_MAX;
+
+        void CreateStagingBuffer(uint64_t capacity);
+
+        // Returns an offset into the current staging buffer, growing it if needed.
+        uint64_t AllocateStaging(uint64_t size, uint64_t alignment);
+
+        void OpenBatch();
+        void Reclaim();
+
+        std::mutex                            mMutex;
+        ComPtr<ID3D12CommandQueue>            mQueue;
+        std::unique_ptr<ImmediateContextPool> mContexts;
+        uint64_t                              mFenceValue; // Token of the last submitted batch.
+        ID3D12GraphicsCommandList*            mpCommandList; // Open batch, nullptr when there is none.
+        StagingBuffer                         mStagingBuffer;
+        std::unique_ptr<RingAllocator>        mStagingRing;
+        std::vector<StagingBuffer>            mRetiredStagingBuffers;
+        Stats                                 mStats;
+    };
+} // namespace ICR
+
+#endif
@@ -239,12 +239,17 @@ namespace ICR
     // Cross compiles a SPIR-V module to DXIL.
     bool CrossCompileSPIRVToDXIL(const std::string& entryPoint, const std::vector<uint32_t>& spirv, std::vector<uint8_t>& dxil);
 
-    void ExecuteCommandListAndWait(ID3D12Device*                                   pDevice,
-                                   ID3D12CommandQueue*                             pCommandQueue,
-                                   std::function<void(ID3D12GraphicsCommandList*)> recordCommandsFunc);
-
     void LoadShaderByteCodes(std::unordered_map<std::string, ComPtr<ID3DBlob>>& shaderByteCodes);
 
+    // Converts 32-bit floats to IEEE half floats. Uses F16C when the CPU supports it and splits large inputs across threads.
+    void ConvertFloatToHalf(const float* pSrc, uint16_t* pDst, size_t count);
+
+    // Scalar reference for the above.
+    void ConvertFloatToHalfScalar(const float* pSrc, uint16_t* pDst, size_t count);
+
+    // Times the scalar, single-threaded F16C and parallel F16C conversions and logs the results.
+    void BenchmarkFloatToHalf(size_t count);
+
 } // namespace ICR
 
 #endif
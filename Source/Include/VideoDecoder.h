@@ -0,0 +1,34 @@
+#ifndef VIDEO_DECODER_H
+#define VIDEO_DECODER_H
+
+namespace ICR
+{
+    // Interface for anything that can produce a sequence of RGBA8 frames for a video input channel.
+    // Implementations are driven from a dedicated decode thread, so they don't need to be thread-safe.
+    class VideoDecoder
+    {
+    public:
+
+        virtual ~VideoDecoder() = default;
+
+        virtual bool Open(const std::string& path) = 0;
+
+        // Decodes the next frame into pDst (rows of rowPitch bytes, bottom-up to match the other media)
+        // and returns its timestamp. Returns false at the end of the stream.
+        virtual bool DecodeFrame(uint8_t* pDst, uint32_t rowPitch, double& timestamp) = 0;
+
+        // Seek back to the first frame.
+        virtual void Rewind() = 0;
+
+        virtual int    GetWidth() const     = 0;
+        virtual int    GetHeight() const    = 0;
+        virtual double GetFrameRate() const = 0;
+        virtual double GetDuration() const  = 0;
+    };
+
+    // Picks a decoder for the path (nullptr if no decoder can handle it).
+    std::unique_ptr<VideoDecoder> CreateVideoDecoder(const std::string& path);
+
+} // namespace ICR
+
+#endif
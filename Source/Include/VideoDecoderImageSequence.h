@@ -0,0 +1,34 @@
+#ifndef VIDEO_DECODER_IMAGE_SEQUENCE_H
+#define VIDEO_DECODER_IMAGE_SEQUENCE_H
+
+#include <VideoDecoder.h>
+
+namespace ICR
+{
+    // Stand-in decoder that plays back a directory of images (sorted by file name) at a fixed frame rate.
+    class VideoDecoderImageSequence : public VideoDecoder
+    {
+    public:
+
+        VideoDecoderImageSequence(double frameRate = 30.0);
+
+        bool Open(const std::string& path) override;
+        bool DecodeFrame(uint8_t* pDst, uint32_t rowPitch, double& timestamp) override;
+        void Rewind() override;
+
+        inline int    GetWidth() const override { return mWidth; }
+        inline int    GetHeight() const override { return mHeight; }
+        inline double GetFrameRate() const override { return mFrameRate; }
+        inline double GetDuration() const override { return mFramePaths.size() / mFrameRate; }
+
+    private:
+
+        std::vector<std::filesystem::path> mFramePaths;
+        size_t                             mFrameIndex;
+        double                             mFrameRate;
+        int                                mWidth;
+        int                                mHeight;
+    };
+} // namespace ICR
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef VIDEO_STREAM_H
+#define VIDEO_STREAM_H
+
+#include <ResourceRegistry.h>
+#include <VideoDecoder.h>
+
+namespace ICR
+{
+    // Streams a video channel into a texture. A background thread decodes into a bounded ring of upload slots, and
+    // the render thread only ever picks up frames that are already decoded, recording their copy into the frame's
+    // command list so that uploads overlap with the rest of the GPU work.
+    class VideoStream
+    {
+    public:
+
+        struct Stats
+        {
+            uint64_t presentedFrames;
+            uint64_t droppedFrames;
+            uint64_t lateFrames;
+        };
+
+        VideoStream(std::unique_ptr<VideoDecoder> decoder);
+        ~VideoStream();
+
+        // Picks up the newest decoded frame due at playback time and records its upload. Never waits on the decoder.
+        void Update(float playbackTime, ID3D12GraphicsCommandList* pCmd);
+
+        inline const ResourceHandle& GetTexture() const { return mTexture; }
+        inline float                 GetChannelTime() const { return static_cast<float>(mCurrentTimestamp); }
+        inline int                   GetWidth() const { return mDecoder->GetWidth(); }
+        inline int                   GetHeight() const { return mDecoder->GetHeight(); }
+
+        Stats GetStats() const;
+
+    private:
+
+        static constexpr uint32_t kRingSize = 4u;
+
+        struct Slot
+        {
+            enum class State
+            {
+                Free,
+                Decoding,
+                Ready,
+                InFlight
+            };
+
+            State    state            = State::Free;
+            double   timestamp        = 0.0;
+            double   presentationTime = 0.0;
+            uint64_t fenceValue       = 0u;
+        };
+
+        void DecodeThread();
+
+        std::unique_ptr<VideoDecoder> mDecoder;
+        std::thread                   mDecodeThread;
+        std::atomic<bool>             mStopDecoding;
+        mutable std::mutex            mMutex;
+        std::condition_variable       mSlotFreed;
+        std::array<Slot, kRingSize>   mSlots;
+
+        ResourceHandle                     mTexture;
+        D3D12_RESOURCE_STATES              mTextureState;
+        ResourceHandle                     mUploadBuffer;
+        uint8_t*                           mpUploadData;
+        D3D12_PLACED_SUBRESOURCE_FOOTPRINT mSlotFootprint;
+        uint64_t                           mSlotSize;
+
+        float  mStartTime;
+        bool   mStarted;
+        double mCurrentTimestamp;
+        double mCurrentPresentationTime;
+
+        uint64_t mPresentedFrames;
+        uint64_t mDroppedFrames;
+        uint64_t mLateFrames;
+    };
+} // namespace ICR
+
+#endif
@@ -3,6 +3,10 @@
 #include <OverlayStyle.h>
 #include <Util.h>
 #include <RenderInputShaderToy.h>
+#include <ResourceRegistry.h>
+#include <UploadQueue.h>
+#include <ConstantAllocator.h>
+#include <RenderTargetPool.h>
 
 using namespace ICR;
 
@@ -151,13 +155,170 @@ void Interface::Draw()
             gRenderInput->RenderInterface();
     }
 
-    static int selectedPerformanceGraphMode;
-
     if (ImGui::CollapsingHeader("Performance", ImGuiTreeNodeFlags_DefaultOpen))
     {
         constexpr std::array<const char*, 2> graphModes = { "Frame Time (Milliseconds)", "Frames-per-Second" };
 
-        StringListDropdown("Graph Mode", graphModes.data(), graphModes.size(), selectedPerformanceGraphMode);
+        StringListDropdown("Graph Mode", graphModes.data(), graphModes.size(), gPerformanceGraphMode);
+
+        if (gResourceRegistry && ImGui::TreeNode("Resources"))
+        {
+            auto deferredReleaseStats = gResourceRegistry->GetDeferredReleaseStats();
+
+            ImGui::Text("Live: %u", gResourceRegistry->GetLiveResourceCount());
+            ImGui::Text("Sampler Tables: %u", gResourceRegistry->GetSamplerTableCount());
+
+            constexpr std::array<std::pair<DescriptorHeap::Type, const char*>, 3> descriptorHeaps = {
+                { { DescriptorHeap::Type::Texture2D, "Views" },
+                  { DescriptorHeap::Type::RenderTarget, "Render Target Views" },
+                  { DescriptorHeap::Type::Sampler, "Samplers" } }
+            };
+
+            for (const auto& [type, name] : descriptorHeaps)
+            {
+                auto descriptorStats = gResourceRegistry->GetDescriptorHeap(type)->GetStats();
+
+                ImGui::Text("%s: %u of %u (peak %u, %.0f%% fragmented)",
+                            name,
+                            descriptorStats.usedCount,
+                            descriptorStats.capacity,
+                            descriptorStats.highWaterMark,
+                            descriptorStats.fragmentation * 100.0f);
+            }
+            ImGui::Text("Deferred Releases: %u (%.1f MB)",
+                        deferredReleaseStats.pendingCount,
+                        deferredReleaseStats.pendingBytes / (1024.0f * 1024.0f));
+            ImGui::Text("Reclaimed: %llu (%.1f MB)", deferredReleaseStats.reclaimedCount, deferredReleaseStats.reclaimedBytes / (1024.0f * 1024.0f));
+
+            if (gUploadQueue)
+            {
+                auto uploadStats = gUploadQueue->GetStats();
+
+                ImGui::Text("Uploads: %llu (%.1f MB) in %llu submissions, %llu waits",
+                            uploadStats.uploadCount,
+                            uploadStats.uploadBytes / (1024.0f * 1024.0f),
+                            uploadStats.submissionCount,
+                            uploadStats.waitCount);
+                ImGui::Text("Staging: %.1f MB (grown %u times)", uploadStats.stagingCapacity / (1024.0f * 1024.0f), uploadStats.stagingGrowCount);
+
+                // Before pooling, every one-shot submission created its own allocator, list, fence and event.
+                auto contextStats = gUploadQueue->GetContextStats();
+
+                ImGui::Text("Immediate Contexts: %u created for %llu submissions (%llu waits)",
+                            contextStats.contextCount,
+                            contextStats.submitCount,
+                            contextStats.waitCount);
+            }
+
+            if (gConstantAllocator)
+            {
+                auto constantStats = gConstantAllocator->GetStats();
+
+                ImGui::Text("Constants: %.1f KB per frame (peak %.1f KB of %.1f KB pages, %llu waits)",
+                            constantStats.frameUsedBytes / 1024.0f,
+                            constantStats.peakUsedBytes / 1024.0f,
+                            constantStats.pageSize / 1024.0f,
+                            constantStats.waitCount);
+            }
+
+            ImGui::TreePop();
+        }
+
+        if (gRenderTargetPool && ImGui::TreeNode("Render Target Pool"))
+        {
+            auto poolStats = gRenderTargetPool->GetStats();
+
+            int maxFreeMB    = static_cast<int>(poolStats.maxFreeBytes / (1024u * 1024u));
+            int maxAgeFrames = static_cast<int>(poolStats.maxAgeFrames);
+
+            if (ImGui::SliderInt("Free Memory Cap (MB)", &maxFreeMB, 0, 4096))
+                gRenderTargetPool->SetMaxFreeBytes(static_cast<uint64_t>(maxFreeMB) * 1024u * 1024u);
+
+            if (ImGui::SliderInt("Max Age (Frames)", &maxAgeFrames, 1, 6000))
+                gRenderTargetPool->SetMaxAgeFrames(static_cast<uint32_t>(maxAgeFrames));
+
+            ImGui::Text("Free: %u targets, %u heaps (%.1f MB)",
+                        poolStats.freeTargetCount,
+                        poolStats.freeHeapCount,
+                        poolStats.freeBytes / (1024.0f * 1024.0f));
+            ImGui::Text("Hits: %llu of %llu (%.1f%% hit rate)",
+                        poolStats.hitCount,
+                        poolStats.acquireCount,
+                        poolStats.acquireCount > 0u ? 100.0 * poolStats.hitCount / poolStats.acquireCount : 0.0);
+            ImGui::Text("Trimmed: %llu", poolStats.trimCount);
+
+            if (ImGui::Button("Clear", ImVec2(ImGui::GetContentRegionAvail().x, 0)))
+                gRenderTargetPool->Clear();
+
+            ImGui::TreePop();
+        }
+
+        if (gResourceRegistry && ImGui::TreeNode("Memory"))
+        {
+            constexpr float kMB = 1024.0f * 1024.0f;
+
+            auto memoryStats = gResourceRegistry->GetMemoryStats();
+
+            const float localUsage = memoryStats.localBudgetBytes > 0u
+                                         ? static_cast<float>(memoryStats.localUsageBytes) / static_cast<float>(memoryStats.localBudgetBytes)
+                                         : 0.0f;
+
+            auto localUsageLabel = std::format("{:.0f} of {:.0f} MB", memoryStats.localUsageBytes / kMB, memoryStats.localBudgetBytes / kMB);
+
+            ImGui::ProgressBar(localUsage, ImVec2(0, 0), localUsageLabel.c_str());
+            ImGui::SameLine();
+            ImGui::Text("Local Budget");
+
+            ImGui::Text("Non-Local: %.1f of %.1f MB", memoryStats.nonLocalUsageBytes / kMB, memoryStats.nonLocalBudgetBytes / kMB);
+            ImGui::Text("Tracked: %.1f MB (peak %.1f MB)", memoryStats.trackedBytes / kMB, memoryStats.peakTrackedBytes / kMB);
+            ImGui::Text("D3D12MA: %.1f MB in %.1f MB of heaps", memoryStats.allocatorBytes / kMB, memoryStats.allocatorBlockBytes / kMB);
+
+            ImGui::Separator();
+
+            for (size_t categoryIndex = 0u; categoryIndex < ResourceRegistry::kMemoryCategoryCount; categoryIndex++)
+            {
+                const auto& categoryStats = memoryStats.categories[categoryIndex];
+                const auto  categoryName  = magic_enum::enum_name(static_cast<ResourceRegistry::MemoryCategory>(categoryIndex));
+
+                ImGui::Text("%.*s: %u (%.1f MB, peak %.1f MB)",
+                            static_cast<int>(categoryName.size()),
+                            categoryName.data(),
+                            categoryStats.count,
+                            categoryStats.bytes / kMB,
+                            categoryStats.peakBytes / kMB);
+            }
+
+            // Peak of the tracked memory while each shader was loaded, highest first.
+            auto memoryScopePeaks = gResourceRegistry->GetMemoryScopePeaks();
+
+            if (!memoryScopePeaks.empty())
+            {
+                std::vector<std::pair<std::string, uint64_t>> shaderPeaks(memoryScopePeaks.begin(), memoryScopePeaks.end());
+
+                std::sort(shaderPeaks.begin(), shaderPeaks.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+
+                ImGui::Separator();
+
+                for (const auto& [shaderID, peakBytes] : shaderPeaks)
+                    ImGui::Text("%s: peak %.1f MB", shaderID.c_str(), peakBytes / kMB);
+            }
+
+            if (ImGui::Button("Dump to JSON", ImVec2(ImGui::GetContentRegionAvail().x, 0)))
+            {
+                std::ofstream file("MemoryReport.json");
+
+                if (file.is_open())
+                {
+                    file << gResourceRegistry->GetMemoryReport().dump(4);
+
+                    spdlog::info("Wrote memory report to MemoryReport.json.");
+                }
+                else
+                    spdlog::error("Failed to write MemoryReport.json.");
+            }
+
+            ImGui::TreePop();
+        }
     }
 
     if (ImGui::CollapsingHeader("Log", ImGuiTreeNodeFlags_DefaultOpen))
@@ -227,7 +388,7 @@ void Interface::Draw()
     static float elapsedTime = 0;
     elapsedTime += gDeltaTime;
 
-    switch (selectedPerformanceGraphMode)
+    switch (gPerformanceGraphMode)
     {
         case 0:
         {
@@ -248,6 +409,9 @@ void Interface::Draw()
         }
     }
 
+    if (gResolutionScale > 0.0f)
+        gResolutionScaleBuffer.AddPoint(elapsedTime, gResolutionScale);
+
     static float history = 3.0f;
 
     if (ImPlot::BeginPlot("##PerformanceChild", ImVec2(-1, -1)))
@@ -270,6 +434,12 @@ void Interface::Draw()
             ImPlot::SetupAxisTicks(ImAxis_Y1, &middleTick, 1, &middleTickLabel);
         }
 
+        if (gResolutionScale > 0.0f)
+        {
+            ImPlot::SetupAxis(ImAxis_Y2, nullptr, ImPlotAxisFlags_AuxDefault);
+            ImPlot::SetupAxisLimits(ImAxis_Y2, 0.0, 1.1, ImGuiCond_Always);
+        }
+
         ImPlot::PlotLine("Exact",
                          &gDeltaTimeBuffer.mData[0].x,
                          &gDeltaTimeBuffer.mData[0].y,
@@ -288,6 +458,22 @@ void Interface::Draw()
                          gDeltaTimeMovingAverageBuffer.mOffset,
                          2 * sizeof(float));
 
+        // Dynamic resolution scale on its own axis, so that it can be read against the frame time it responds to.
+        if (gResolutionScale > 0.0f)
+        {
+            ImPlot::SetAxes(ImAxis_X1, ImAxis_Y2);
+
+            ImPlot::SetNextLineStyle(IMPLOT_AUTO_COL, 1.0);
+
+            ImPlot::PlotLine("Resolution Scale",
+                             &gResolutionScaleBuffer.mData[0].x,
+                             &gResolutionScaleBuffer.mData[0].y,
+                             gResolutionScaleBuffer.mData.size(),
+                             ImPlotLineFlags_None,
+                             gResolutionScaleBuffer.mOffset,
+                             2 * sizeof(float));
+        }
+
         ImPlot::EndPlot();
     }
 
@@ -11,6 +11,10 @@ extern "C" { __declspec(dllexport) extern const char* D3D12SDKPath = ".\\D3D12\\
 #include <Interface.h>
 #include <Blitter.h>
 #include <ResourceRegistry.h>
+#include <MediaCache.h>
+#include <UploadQueue.h>
+#include <ConstantAllocator.h>
+#include <RenderTargetPool.h>
 
 using namespace ICR;
 
@@ -146,6 +150,23 @@ _Use_decl_annotations_ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR,
     if (gRenderInput)
         gRenderInput->Release();
 
+    gMediaCache.reset();
+    gUploadQueue.reset();
+    gConstantAllocator.reset();
+    gRenderTargetPool.reset();
+
+    // Nothing is in flight anymore, destroy what is still queued before the leak report.
+    WaitForDevice();
+    gResourceRegistry->FlushDeferredReleases();
+
+    for (auto& swapChainImageHandle : gSwapChainImageHandles)
+        gResourceRegistry->ReleaseImmediate(swapChainImageHandle);
+
+    gSwapChainImageHandles.clear();
+
+    // Whatever the registry still tracks now was never released.
+    gResourceRegistry->ReportLeaks();
+
     glslang::FinalizeProcess();
 
     glfwDestroyWindow(gWindow);
@@ -229,7 +250,9 @@ void CreateSwapChain()
 
         // Wrap a handle around the swap chain buffer and create a RTV/SRV.
         gSwapChainImageHandles[swapChainImageIndex] =
-            gResourceRegistry->Create(pSwapChainBuffer.Detach(), DescriptorHeap::Type::RenderTarget | DescriptorHeap::Type::Texture2D);
+            gResourceRegistry->Create(pSwapChainBuffer.Detach(),
+                                      DescriptorHeap::Type::RenderTarget | DescriptorHeap::Type::Texture2D,
+                                      ResourceRegistry::MemoryCategory::SwapChain);
     }
 }
 
@@ -245,7 +268,7 @@ void ReleaseSwapChain()
     }
 
     for (auto& swapChainImageHandle : gSwapChainImageHandles)
-        gResourceRegistry->Release(swapChainImageHandle);
+        gResourceRegistry->ReleaseImmediate(swapChainImageHandle);
 
     gDXGISwapChain.Reset();
 }
@@ -387,7 +410,7 @@ void UpdateWindowAndSwapChain()
 
     // Need to release the swap chain image views before resizing the swap chain.
     for (auto& swapChainImageHandle : gSwapChainImageHandles)
-        gResourceRegistry->Release(swapChainImageHandle);
+        gResourceRegistry->ReleaseImmediate(swapChainImageHandle);
 
     DXGI_SWAP_CHAIN_DESC swapChainInfo = {};
     gDXGISwapChain->GetDesc(&swapChainInfo);
@@ -408,7 +431,9 @@ void UpdateWindowAndSwapChain()
         ThrowIfFailed(gDXGISwapChain->GetBuffer(swapChainImageIndex, IID_PPV_ARGS(&pSwapChainBuffer)));
 
         gSwapChainImageHandles[swapChainImageIndex] =
-            gResourceRegistry->Create(pSwapChainBuffer.Detach(), DescriptorHeap::Type::RenderTarget | DescriptorHeap::Type::Texture2D);
+            gResourceRegistry->Create(pSwapChainBuffer.Detach(),
+                                      DescriptorHeap::Type::RenderTarget | DescriptorHeap::Type::Texture2D,
+                                      ResourceRegistry::MemoryCategory::SwapChain);
     }
 
     gBackBufferSizePrev = gBackBufferSize;
@@ -567,14 +592,28 @@ void InitializeGraphicsRuntime()
 
     ThrowIfFailed(D3D12CreateDevice(gDXGIAdapter.Get(), D3D_FEATURE_LEVEL_12_0, IID_PPV_ARGS(&gLogicalDevice)));
 
+    // Cached media, staging, constants and pooled render targets live in the previous device's memory.
+    gMediaCache.reset();
+    gUploadQueue.reset();
+    gConstantAllocator.reset();
+    gRenderTargetPool.reset();
+
     gResourceRegistry = std::make_unique<ResourceRegistry>();
 
+    gMediaCache = std::make_unique<MediaCache>();
+
     // Describe and create the command queue.
     D3D12_COMMAND_QUEUE_DESC queueDesc = {};
     queueDesc.Flags                    = D3D12_COMMAND_QUEUE_FLAG_NONE;
     queueDesc.Type                     = D3D12_COMMAND_LIST_TYPE_DIRECT;
     ThrowIfFailed(gLogicalDevice->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&gCommandQueue)));
 
+    gUploadQueue = std::make_unique<UploadQueue>(32u * 1024u * 1024u);
+
+    gConstantAllocator = std::make_unique<ConstantAllocator>(gSwapChainImageCount, 128u * 1024u);
+
+    gRenderTargetPool = std::make_unique<RenderTargetPool>(512u * 1024u * 1024u, 600u);
+
     // Determine the size of descriptor type stride.
     gRTVDescriptorSize = gLogicalDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
     gSRVDescriptorSize = gLogicalDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
@@ -754,6 +793,10 @@ void Render()
 {
     SyncSettings();
 
+    // Pre-render tasks and the render input allocate their constants from this frame's page.
+    gConstantAllocator->BeginFrame();
+    gRenderTargetPool->BeginFrame();
+
     // Process pre-render tasks
     while (!gPreRenderTaskQueue.empty())
     {
@@ -826,5 +869,8 @@ void WaitForDevice()
 
     gFenceValue++;
 
+    if (gResourceRegistry)
+        gResourceRegistry->ProcessDeferredReleases(gFence->GetCompletedValue(), gFenceValue);
+
     gCurrentSwapChainImageIndex = gDXGISwapChain->GetCurrentBackBufferIndex();
 }
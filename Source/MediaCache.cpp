@@ -0,0 +1,245 @@
+#include <MediaCache.h>
+#include <ResourceRegistry.h>
+#include <State.h>
+
+namespace ICR
+{
+    MediaCache::MediaCache() : mBudgetMB(512), mTick(0u), mMemorySize(0u), mHits(0u), mMisses(0u), mEvictions(0u) {}
+
+    MediaCache::~MediaCache()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        for (auto& [src, pMedia] : mEntries)
+        {
+            if (pMedia->referenceCount != 0u)
+                spdlog::warn("MediaCache: {} is still referenced at shutdown.", src);
+
+            gResourceRegistry->Release(pMedia->resource);
+        }
+    }
+
+    uint64_t MediaCache::GetMemorySize(const Media& media) const
+    {
+        // Decoded pixels are kept on the CPU next to the uploaded texture.
+        return media.pixels.size() + gResourceRegistry->GetAllocationSize(media.resource);
+    }
+
+    bool MediaCache::Decode(const std::vector<uint8_t>& data, Media* pMedia) const
+    {
+        const auto dataSize = static_cast<int>(data.size());
+
+        float* pImageFloat = nullptr;
+
+        if (IsEXRFromMemory(data.data(), data.size()) == TINYEXR_SUCCESS)
+        {
+            const char* pError = nullptr;
+
+            if (LoadEXRFromMemory(&pImageFloat, &pMedia->width, &pMedia->height, data.data(), data.size(), &pError) != TINYEXR_SUCCESS)
+            {
+                spdlog::error("Failed to load EXR: {}", pError ? pError : "Unknown error");
+                FreeEXRErrorMessage(pError);
+                return false;
+            }
+
+            // EXR is stored top-down, flip to match the rest of the media.
+            auto rowSize = static_cast<size_t>(pMedia->width) * 4;
+
+            for (int row = 0; row < pMedia->height / 2; row++)
+            {
+                auto* pRowTop    = pImageFloat + row * rowSize;
+                auto* pRowBottom = pImageFloat + (pMedia->height - row - 1) * rowSize;
+
+                std::swap_ranges(pRowTop, pRowTop + rowSize, pRowBottom);
+            }
+        }
+        else if (stbi_is_hdr_from_memory(data.data(), dataSize))
+        {
+            stbi_set_flip_vertically_on_load(true);
+
+            int channels;
+            pImageFloat = stbi_loadf_from_memory(data.data(), dataSize, &pMedia->width, &pMedia->height, &channels, STBI_rgb_alpha);
+
+            if (!pImageFloat)
+                return false;
+        }
+
+        if (pImageFloat)
+        {
+            auto texelCount = static_cast<size_t>(pMedia->width) * pMedia->height * 4;
+
+            pMedia->format = DXGI_FORMAT_R16G16B16A16_FLOAT;
+            pMedia->pixels.resize(texelCount * sizeof(uint16_t));
+
+            ConvertFloatToHalf(pImageFloat, reinterpret_cast<uint16_t*>(pMedia->pixels.data()), texelCount);
+
+            // Both loaders allocate with malloc.
+            free(pImageFloat);
+
+            return true;
+        }
+
+        // Everything else is LDR.
+        // ------------------------------
+
+        stbi_set_flip_vertically_on_load(true);
+
+        int  channels;
+        auto pImage = stbi_load_from_memory(data.data(), dataSize, &pMedia->width, &pMedia->height, &channels, STBI_rgb_alpha);
+
+        if (!pImage)
+            return false;
+
+        pMedia->format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        pMedia->pixels.assign(pImage, pImage + static_cast<size_t>(pMedia->width) * pMedia->height * 4);
+
+        stbi_image_free(pImage);
+
+        return true;
+    }
+
+    const MediaCache::Media* MediaCache::Acquire(const std::string& src)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            if (auto entry = mEntries.find(src); entry != mEntries.end())
+            {
+                entry->second->referenceCount++;
+                entry->second->lastUseTick = ++mTick;
+
+                mHits++;
+
+                return entry->second.get();
+            }
+
+            mMisses++;
+        }
+
+        // Download + decode outside of the lock, this is by far the slowest part.
+        // ------------------------------
+
+        auto data = QueryURL<std::vector<uint8_t>>("https://www.shadertoy.com" + src);
+
+        if (data.empty())
+            return nullptr;
+
+        auto pMedia = std::make_unique<Media>();
+        pMedia->src = src;
+
+        if (!Decode(data, pMedia.get()))
+        {
+            spdlog::error("Failed to load image from bytes.");
+            return nullptr;
+        }
+
+        // Upload
+        // ------------------------------
+
+        pMedia->resource = gResourceRegistry->CreateWithData(CD3DX12_RESOURCE_DESC::Tex2D(pMedia->format, pMedia->width, pMedia->height, 1, 1),
+                                                             0x0, // Manually managed descriptor heaps.
+                                                             pMedia->pixels.data(),
+                                                             pMedia->pixels.size(),
+                                                             ResourceRegistry::MemoryCategory::Media);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        // Another build may have loaded the same media in the meantime, prefer the entry that is already shared.
+        if (auto entry = mEntries.find(src); entry != mEntries.end())
+        {
+            gResourceRegistry->Release(pMedia->resource);
+
+            entry->second->referenceCount++;
+            entry->second->lastUseTick = ++mTick;
+
+            return entry->second.get();
+        }
+
+        pMedia->referenceCount = 1u;
+        pMedia->lastUseTick    = ++mTick;
+
+        mMemorySize += GetMemorySize(*pMedia);
+
+        auto* pResult = pMedia.get();
+
+        mEntries[src] = std::move(pMedia);
+
+        TrimLocked(static_cast<uint64_t>(mBudgetMB) * 1024u * 1024u);
+
+        return pResult;
+    }
+
+    void MediaCache::Release(const std::string& src)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        auto entry = mEntries.find(src);
+
+        if (entry == mEntries.end() || entry->second->referenceCount == 0u)
+            throw std::runtime_error("MediaCache: Releasing media that was never acquired.");
+
+        entry->second->referenceCount--;
+
+        TrimLocked(static_cast<uint64_t>(mBudgetMB) * 1024u * 1024u);
+    }
+
+    void MediaCache::Trim()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        TrimLocked(static_cast<uint64_t>(mBudgetMB) * 1024u * 1024u);
+    }
+
+    void MediaCache::Clear()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        TrimLocked(0u);
+    }
+
+    void MediaCache::TrimLocked(uint64_t budget)
+    {
+        while (mMemorySize > budget)
+        {
+            // Find the least recently used entry that no render graph references anymore.
+            auto leastRecentlyUsed = mEntries.end();
+
+            for (auto entry = mEntries.begin(); entry != mEntries.end(); entry++)
+            {
+                if (entry->second->referenceCount != 0u)
+                    continue;
+
+                if (leastRecentlyUsed == mEntries.end() || entry->second->lastUseTick < leastRecentlyUsed->second->lastUseTick)
+                    leastRecentlyUsed = entry;
+            }
+
+            // Everything left is in use.
+            if (leastRecentlyUsed == mEntries.end())
+                break;
+
+            mMemorySize -= GetMemorySize(*leastRecentlyUsed->second);
+
+            gResourceRegistry->Release(leastRecentlyUsed->second->resource);
+
+            mEntries.erase(leastRecentlyUsed);
+
+            mEvictions++;
+        }
+    }
+
+    MediaCache::Stats MediaCache::GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        Stats stats                = {};
+        stats.hits                 = mHits;
+        stats.misses               = mMisses;
+        stats.evictions            = mEvictions;
+        stats.memorySize           = mMemorySize;
+        stats.entryCount           = static_cast<uint32_t>(mEntries.size());
+        stats.referencedEntryCount = static_cast<uint32_t>(
+            std::count_if(mEntries.begin(), mEntries.end(), [](const auto& entry) { return entry.second->referenceCount != 0u; }));
+
+        return stats;
+    }
+} // namespace ICR
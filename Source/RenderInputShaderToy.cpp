@@ -2,7 +2,12 @@
 #include <Util.h>
 #include <Blitter.h>
 #include <ResourceRegistry.h>
+#include <MediaCache.h>
 #include <State.h>
+#include <UploadQueue.h>
+#include <ConstantAllocator.h>
+
+void WaitForDevice();
 
 namespace ICR
 {
@@ -12,16 +17,15 @@ namespace ICR
     static float elapsedSeconds = 0;
     static int   elapsedFrames  = 0;
 
-    // Shorthand for getting current + history resources.
+    // Shorthand for getting current resources, history resources use the other index.
     int GetCurrentFrameIndex() { return (gInternalFrameIndex + 0) % 2; }
-    int GetHistoryFrameIndex() { return (gInternalFrameIndex + 1) % 2; }
 
     constexpr const char* kFragmentShaderShaderToyInputs = R"(
 
         layout (set = 0, binding = 0, std140) uniform UBO
         {
             // Add some application-specific inputs.
-            vec4 iAppParams0;
+            vec4 iAppParams0;                // xy: rendered fraction of the buffer targets (dynamic resolution), zw: fragCoord offset (tiled render)
 
             // Constant buffer adapted from ShaderToy inputs.
             vec3      iResolution;           // viewport resolution (in pixels)
@@ -59,14 +63,137 @@ namespace ICR
 
         void main()
         {
-            // Invoke the ShaderToy shader.
-            mainImage(fragColorOut, gl_FragCoord.xy);
+            // Invoke the ShaderToy shader. Tiles rendered into tile-sized targets are offset to their place in the image.
+            mainImage(fragColorOut, gl_FragCoord.xy + iAppParams0.zw);
         }
 
     )";
 
     constexpr const char* kUnsupportedInputs[1] = { "keyboard" };
 
+    // Input channels of a pass, each has a texture and a sampler.
+    constexpr uint32_t kChannelCount = 4u;
+
+    // Upper bound for the graph executions per presented frame (accumulation).
+    constexpr int kMaxIterationsPerFrame = 64;
+
+    // Tiled rendering bounds: tiles are at most a couple of thousand pixels wide, and a frame spends about this long on them.
+    constexpr uint32_t kTiledRenderMinTileSize  = 32u;
+    constexpr uint32_t kTiledRenderMaxTileSize  = 2048u;
+    constexpr double   kTiledRenderFrameBudgetMs = 200.0;
+
+    // Graphs that need their targets at the full tiled render resolution may take up to this fraction of the device memory budget.
+    constexpr double kTiledRenderTargetBudget = 0.5;
+
+    // Frames rendered per run when verifying reduced output precision, the last one is compared.
+    constexpr int kPrecisionTestFrameCount = 120;
+
+    // Output memory is over-allocated by the headroom (rounded up to the granularity) and only shrinks once the resolution covers
+    // less than a fraction of its area, so that dragging the window around resizes without re-allocating. Dynamic resolution
+    // renders into a sub-rect of targets at the capacity, otherwise the targets are re-created at exactly the resolution in it.
+    constexpr float   kTargetCapacityHeadroom    = 1.25f;
+    constexpr int32_t kTargetCapacityGranularity = 256;
+    constexpr float   kTargetCapacityShrinkArea  = 0.25f;
+
+    static DirectX::XMINT2 GetTargetCapacity(const DirectX::XMINT2& resolution)
+    {
+        auto GetAxisCapacity = [](int32_t size)
+        {
+            auto capacity = static_cast<int32_t>(std::ceil(size * kTargetCapacityHeadroom / kTargetCapacityGranularity)) *
+                            kTargetCapacityGranularity;
+
+            return std::clamp(capacity, size, static_cast<int32_t>(D3D12_REQ_TEXTURE2D_U_OR_V_DIMENSION));
+        };
+
+        return { GetAxisCapacity(resolution.x), GetAxisCapacity(resolution.y) };
+    }
+
+    // Dynamic resolution renders into the top-left part of the buffer targets, so normalized lookups into buffer channels are
+    // scaled by the rendered fraction (iAppParams0.xy, (1, 1) while dynamic resolution is off). Rewrites the coordinate argument
+    // of texture(), textureLod() and textureGrad() calls on those channels, texelFetch() addresses pixels and needs no change.
+    // Dynamic resolution does not support shaders that pass a buffer channel's sampler to their own functions (lookups there are
+    // not rescaled), that rely on textureSize() (it reports the target size), or that read across the rendered sub-rect's edge
+    // through wrapping or bilinear filtering (both reach the unrendered part of the target).
+    static std::string ScaleBufferLookups(const std::string& glsl, const std::vector<int>& bufferChannels)
+    {
+        static const std::regex lookupPattern(R"(\b(texture|textureLod|textureGrad)\s*\()");
+
+        auto IsBufferChannel = [&](std::string argument)
+        {
+            argument.erase(0, argument.find_first_not_of(" \t\r\n"));
+            argument.erase(argument.find_last_not_of(" \t\r\n") + 1);
+
+            for (int channel : bufferChannels)
+            {
+                if (argument == std::format("iChannel{}", channel))
+                    return true;
+            }
+
+            return false;
+        };
+
+        std::string result;
+
+        auto searchStart = glsl.cbegin();
+
+        for (std::smatch match; std::regex_search(searchStart, glsl.cend(), match, lookupPattern);)
+        {
+            result.append(searchStart, match[0].second);
+
+            // Split the arguments at top-level commas up to the closing parenthesis.
+            std::vector<std::string> arguments(1);
+
+            auto cursor = match[0].second;
+
+            for (int depth = 0; cursor != glsl.cend(); cursor++)
+            {
+                if (*cursor == ')' && depth == 0)
+                    break;
+
+                if (*cursor == '(' || *cursor == '[')
+                    depth++;
+                else if (*cursor == ')' || *cursor == ']')
+                    depth--;
+
+                if (*cursor == ',' && depth == 0)
+                    arguments.emplace_back();
+                else
+                    arguments.back() += *cursor;
+            }
+
+            // Unbalanced (e.g. inside a comment), leave the rest untouched.
+            if (cursor == glsl.cend())
+            {
+                searchStart = match[0].second;
+                continue;
+            }
+
+            const bool scaleCoordinates = IsBufferChannel(arguments[0]);
+
+            for (size_t argumentIndex = 0; argumentIndex < arguments.size(); argumentIndex++)
+            {
+                // Nested lookups are rewritten as well.
+                auto argument = ScaleBufferLookups(arguments[argumentIndex], bufferChannels);
+
+                // Coordinates, and the derivatives of textureGrad(). LOD, bias and offset arguments stay as they are.
+                bool isCoordinate = argumentIndex == 1 || (argumentIndex > 1 && match[1] == "textureGrad");
+
+                if (scaleCoordinates && isCoordinate)
+                    argument = std::format("(({}) * iAppParams0.xy)", argument);
+
+                result += (argumentIndex > 0 ? "," : "") + argument;
+            }
+
+            result += ')';
+
+            searchStart = cursor + 1;
+        }
+
+        result.append(searchStart, glsl.cend());
+
+        return result;
+    }
+
     // Render Pass
     // -------------------------------------------------
 
@@ -74,28 +201,43 @@ namespace ICR
 
     RenderPass::RenderPass(const RenderPass::Args& args)
     {
+        mName = args.renderPassInfo["name"].get<std::string>();
+
         // Resolve the output ID.
         // WARNING: Currently ShaderToy does not support MRT, so we assume there will only ever be one output per-pass.
         mOutputID = args.renderPassInfo["outputs"][0]["id"].get<int>();
 
-        // Intermediate renderpasses need full float format and flipped viewport.
+        // Intermediate renderpasses need float formats and flipped viewport.
         mIntermediateRenderPass = args.renderPassInfo["type"] == "buffer";
 
-        CreateOutputTargets();
+        mpRootSignature   = args.pRootSignature;
+        mOutputPrecision  = OutputPrecision::Auto;
+        mAutoOutputFormat = DXGI_FORMAT_R32G32B32A32_FLOAT;
 
-        // Create a descriptor heap for 4 samplers
-        // ------------------------------------------------
+        mUpdateRate        = UpdateRate::EveryFrame;
+        mUpdateInterval    = 2;
+        mFramesSinceUpdate = 0;
+        mTimeSinceUpdate   = 0.0f;
+        mUpdateCount       = 0;
+        mUpdateDeltaTime   = 0.0f;
+
+        ResetUpdates();
 
-        D3D12_DESCRIPTOR_HEAP_DESC samplerHeapInfo = {};
+        mInputTable = UINT_MAX;
+
+        // Samplers by channel, channels without an input keep the default (linear, wrapping).
+        std::array<D3D12_SAMPLER_DESC, kChannelCount> samplerDescs = {};
+
+        for (auto& samplerDesc : samplerDescs)
         {
-            samplerHeapInfo.NumDescriptors = 4;
-            samplerHeapInfo.Type           = D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER;
-            samplerHeapInfo.Flags          = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+            samplerDesc.Filter        = D3D12_FILTER_MIN_MAG_MIP_LINEAR;
+            samplerDesc.AddressU      = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
+            samplerDesc.AddressV      = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
+            samplerDesc.AddressW      = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
+            samplerDesc.MinLOD        = 0;
+            samplerDesc.MaxLOD        = D3D12_FLOAT32_MAX;
+            samplerDesc.MaxAnisotropy = 1;
         }
-        ThrowIfFailed(gLogicalDevice->CreateDescriptorHeap(&samplerHeapInfo, IID_PPV_ARGS(&mInputSamplerDescriptorHeap)));
-
-        // Obtain a handle to the first sampler.
-        CD3DX12_CPU_DESCRIPTOR_HANDLE samplerHandle(mInputSamplerDescriptorHeap->GetCPUDescriptorHandleForHeapStart());
 
         // Resolve the input IDs.
         // ------------------------------------------------
@@ -109,38 +251,22 @@ namespace ICR
                     throw std::runtime_error("Unsupported input type.");
             }
 
-            if (input.contains("sampler"))
-            {
-                auto& samplerInfo = input["sampler"];
+            mInputIDs.push_back(input["id"].get<int>());
 
-                D3D12_SAMPLER_DESC samplerDesc = {};
-                {
-                    D3D12_TEXTURE_ADDRESS_MODE addressMode;
+            mInputToChannelMap[mInputIDs.back()] = input["channel"].get<int>();
 
-                    if (samplerInfo["wrap"].get<std::string>() == "clamp")
-                        addressMode = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
-                    else
-                        addressMode = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
-
-                    samplerDesc.Filter        = D3D12_FILTER_MIN_MAG_MIP_LINEAR;
-                    samplerDesc.AddressU      = addressMode;
-                    samplerDesc.AddressV      = addressMode;
-                    samplerDesc.AddressW      = addressMode;
-                    samplerDesc.MinLOD        = 0;
-                    samplerDesc.MaxLOD        = D3D12_FLOAT32_MAX;
-                    samplerDesc.MaxAnisotropy = 1;
-                }
-                gLogicalDevice->CreateSampler(&samplerDesc, samplerHandle);
+            if (input.contains("sampler") && input["sampler"]["wrap"].get<std::string>() == "clamp")
+            {
+                auto& samplerDesc = samplerDescs.at(mInputToChannelMap[mInputIDs.back()]);
 
-                // Advance pointer to the next sampler descriptor.
-                samplerHandle.Offset(1, gSMPDescriptorSize);
+                samplerDesc.AddressU = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+                samplerDesc.AddressV = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+                samplerDesc.AddressW = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
             }
-
-            mInputIDs.push_back(input["id"].get<int>());
-
-            mInputToChannelMap[mInputIDs.back()] = input["channel"].get<int>();
         }
 
+        mSamplerTable = gResourceRegistry->GetSamplerTable(samplerDescs.data(), kChannelCount);
+
         // Compile PSO.
         // ------------------------------------------------
         {
@@ -149,6 +275,17 @@ namespace ICR
 
             auto renderPassSourceCodeGLSL = args.renderPassInfo["code"].get<std::string>();
 
+            std::vector<int> bufferChannels;
+
+            for (const auto& input : args.renderPassInfo["inputs"])
+            {
+                if (input["ctype"].get<std::string>() == "buffer")
+                    bufferChannels.push_back(input["channel"].get<int>());
+            }
+
+            if (!bufferChannels.empty())
+                renderPassSourceCodeGLSL = ScaleBufferLookups(renderPassSourceCodeGLSL, bufferChannels);
+
             // Compose a GLSL shader that makes the ShaderToy shader Vulkan-conformant.
             const char* shaderStrings[4] = { kFragmentShaderShaderToyInputs,
                                              args.commonShaderGLSL.c_str(),
@@ -180,7 +317,7 @@ namespace ICR
                             if (inputType == "cubemap")
                                 preambleStream << "samplerCube";
 
-                            if (inputType == "buffer" || inputType == "texture")
+                            if (inputType == "buffer" || inputType == "texture" || inputType == "video")
                                 preambleStream << "sampler2D";
 
                             sampleIndexHasInput = true;
@@ -208,120 +345,158 @@ namespace ICR
             // 2) Convert SPIR-V to DXIL.
             // --------------------------
 
-            std::vector<uint8_t> renderPassDXIL;
-            if (!CrossCompileSPIRVToDXIL("main", mSPIRV, renderPassDXIL))
+            // Kept around to create the PSO for other output formats.
+            if (!CrossCompileSPIRVToDXIL("main", mSPIRV, mDXIL))
                 throw std::runtime_error("Failed to cross-compile SPIR-V to DXIL.");
 
             // 3) Create Graphics PSO.
             // --------------------------
 
+            UpdatePipelineState();
+        }
+    }
+
+    RenderPass::~RenderPass()
+    {
+        ReleaseOutputTargets();
+
+        if (mInputTable != UINT_MAX)
+            gResourceRegistry->ReleaseDescriptorTable(DescriptorHeap::Type::Texture2D, mInputTable, kChannelCount * 2u);
+    }
+
+    DXGI_FORMAT RenderPass::GetOutputFormat() const
+    {
+        if (!mIntermediateRenderPass)
+            return DXGI_FORMAT_R8G8B8A8_UNORM;
+
+        switch (mOutputPrecision)
+        {
+            case OutputPrecision::RGBA32F   : return DXGI_FORMAT_R32G32B32A32_FLOAT;
+            case OutputPrecision::RGBA16F   : return DXGI_FORMAT_R16G16B16A16_FLOAT;
+            case OutputPrecision::R11G11B10F: return DXGI_FORMAT_R11G11B10_FLOAT;
+            default                         : return mAutoOutputFormat;
+        }
+    }
+
+    void RenderPass::SetOutputPrecision(OutputPrecision outputPrecision)
+    {
+        mOutputPrecision = outputPrecision;
+
+        UpdatePipelineState();
+    }
+
+    void RenderPass::SetAutoOutputFormat(DXGI_FORMAT autoOutputFormat)
+    {
+        mAutoOutputFormat = autoOutputFormat;
+
+        UpdatePipelineState();
+    }
+
+    void RenderPass::UpdatePipelineState()
+    {
+        auto outputFormat = GetOutputFormat();
+
+        auto& pipelineState = mPipelineStates[outputFormat];
+
+        if (!pipelineState)
+        {
             D3D12_GRAPHICS_PIPELINE_STATE_DESC shaderToyPSOInfo = {};
             {
                 const auto& fullscreenTriangleDXIL = gShaderDXIL["FullscreenTriangle.vert"];
 
-                shaderToyPSOInfo.PS                    = { renderPassDXIL.data(), renderPassDXIL.size() };
+                shaderToyPSOInfo.PS                    = { mDXIL.data(), mDXIL.size() };
                 shaderToyPSOInfo.VS                    = { fullscreenTriangleDXIL->GetBufferPointer(), fullscreenTriangleDXIL->GetBufferSize() };
                 shaderToyPSOInfo.RasterizerState       = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
                 shaderToyPSOInfo.BlendState            = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
                 shaderToyPSOInfo.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
                 shaderToyPSOInfo.SampleMask            = UINT_MAX;
                 shaderToyPSOInfo.NumRenderTargets      = 1;
-                shaderToyPSOInfo.RTVFormats[0]         = mIntermediateRenderPass ? DXGI_FORMAT_R32G32B32A32_FLOAT : DXGI_FORMAT_R8G8B8A8_UNORM;
+                shaderToyPSOInfo.RTVFormats[0]         = outputFormat;
                 shaderToyPSOInfo.SampleDesc.Count      = 1;
-                shaderToyPSOInfo.pRootSignature        = args.pRootSignature;
+                shaderToyPSOInfo.pRootSignature        = mpRootSignature;
             }
 
             // Compile the PSO in the driver.
-            if (gLogicalDevice->CreateGraphicsPipelineState(&shaderToyPSOInfo, IID_PPV_ARGS(&mPSO)) != S_OK)
+            if (gLogicalDevice->CreateGraphicsPipelineState(&shaderToyPSOInfo, IID_PPV_ARGS(&pipelineState)) != S_OK)
                 throw std::runtime_error("Failed to create graphics PSO.");
         }
+
+        mpPipelineState = pipelineState.Get();
     }
 
-    void RenderPass::CreateOutputTargets()
+    void RenderPass::SetOutputTargets(const std::array<ResourceHandle, 2>& outputTargets)
     {
-        DXGI_FORMAT outputFormat;
-
-        if (mIntermediateRenderPass)
-            outputFormat = DXGI_FORMAT_R32G32B32A32_FLOAT;
-        else
-            outputFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
+        ReleaseOutputTargets();
 
-        const float clearColor[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        mOutputTargets = outputTargets;
 
-        auto CreateOutputColorBuffer = [&](ResourceHandle& colorBufferHandle)
-        {
-            if (colorBufferHandle.indexResource != UINT_MAX)
-                gResourceRegistry->Release(colorBufferHandle);
-
-            auto colorBufferInfo = CD3DX12_RESOURCE_DESC::Tex2D(outputFormat,
-                                                                static_cast<UINT>(gViewport.Width),
-                                                                static_cast<UINT>(gViewport.Height),
-                                                                1,
-                                                                1,
-                                                                1,
-                                                                0,
-                                                                D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
+        SetDebugName(gResourceRegistry->Get(mOutputTargets[0]), L"RenderPassOutputA");
 
-            colorBufferHandle = gResourceRegistry->Create(colorBufferInfo, DescriptorHeap::Type::RenderTarget | DescriptorHeap::Type::Texture2D);
-        };
+        if (mOutputTargets[1].indexResource != mOutputTargets[0].indexResource)
+            SetDebugName(gResourceRegistry->Get(mOutputTargets[1]), L"RenderPassOutputB");
+    }
 
-        CreateOutputColorBuffer(mOutputTargets[0]);
-        CreateOutputColorBuffer(mOutputTargets[1]);
+    void RenderPass::ReleaseOutputTargets()
+    {
+        if (mOutputTargets[0].indexResource != UINT_MAX)
+            gResourceRegistry->Release(mOutputTargets[0]);
 
-        {
-            SetDebugName(gResourceRegistry->Get(mOutputTargets[0]), L"RenderPassOutputA");
-            SetDebugName(gResourceRegistry->Get(mOutputTargets[1]), L"RenderPassOutputB");
-        }
+        // Single-buffered outputs share the handle.
+        if (mOutputTargets[1].indexResource != UINT_MAX && mOutputTargets[1].indexResource != mOutputTargets[0].indexResource)
+            gResourceRegistry->Release(mOutputTargets[1]);
 
-        for (auto& outputTarget : mOutputTargets)
-        {
-            auto* pRenderTargetHeap = gResourceRegistry->GetDescriptorHeap(DescriptorHeap::Type::RenderTarget);
+        mOutputTargets = {};
+    }
 
-            auto outputDescriptorHandle = pRenderTargetHeap->GetAddressCPU(outputTarget.indexDescriptorRenderTarget);
+    std::array<ResourceHandle, 2> RenderPass::DetachOutputTargets()
+    {
+        auto outputTargets = mOutputTargets;
 
-            ExecuteCommandListAndWait(gLogicalDevice.Get(),
-                                      gCommandQueue.Get(),
-                                      [&](ID3D12GraphicsCommandList* pCmd)
-                                      {
-                                          auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(gResourceRegistry->Get(outputTarget),
-                                                                                              D3D12_RESOURCE_STATE_COMMON,
-                                                                                              D3D12_RESOURCE_STATE_RENDER_TARGET);
+        mOutputTargets = {};
 
-                                          pCmd->ResourceBarrier(1, &barrier);
-                                          pCmd->ClearRenderTargetView(outputDescriptorHandle, clearColor, 0, nullptr);
-                                      });
-        }
+        return outputTargets;
     }
 
     void RenderPass::CreateInputResourceDescriptorTable(const std::unordered_map<int, std::array<ResourceHandle, 2>>& resourceCache)
     {
-        // Create a descriptor heap for 4 resources x 2 frames (history).
+        // A table of the channels for each frame index (current frame index).
         // ------------------------------------------------
 
-        D3D12_DESCRIPTOR_HEAP_DESC resourceDescriptorHeapInfo = {};
+        auto* pTextureHeap = gResourceRegistry->GetDescriptorHeap(DescriptorHeap::Type::Texture2D);
+
+        if (mInputTable == UINT_MAX)
+            mInputTable = pTextureHeap->AllocateTable(kChannelCount * 2u);
+
+        // Unused channels read zeros.
+        D3D12_SHADER_RESOURCE_VIEW_DESC nullSRVDesc = {};
         {
-            resourceDescriptorHeapInfo.NumDescriptors = 4 * 2;
-            resourceDescriptorHeapInfo.Type           = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-            resourceDescriptorHeapInfo.Flags          = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+            nullSRVDesc.Format                    = DXGI_FORMAT_R8G8B8A8_UNORM;
+            nullSRVDesc.ViewDimension             = D3D12_SRV_DIMENSION_TEXTURE2D;
+            nullSRVDesc.Shader4ComponentMapping   = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+            nullSRVDesc.Texture2D.MostDetailedMip = 0;
+            nullSRVDesc.Texture2D.MipLevels       = 1;
         }
-        ThrowIfFailed(gLogicalDevice->CreateDescriptorHeap(&resourceDescriptorHeapInfo, IID_PPV_ARGS(&mInputResourceDescriptorHeap)));
+
+        for (uint32_t tableIndex = 0u; tableIndex < kChannelCount * 2u; tableIndex++)
+            gLogicalDevice->CreateShaderResourceView(nullptr, &nullSRVDesc, pTextureHeap->GetAddressCPU(mInputTable + tableIndex));
 
         for (int frameIndex = 0; frameIndex < 2; frameIndex++)
         {
+            const int historyFrameIndex = (frameIndex + 1) % 2;
+
             for (int inputID : mInputIDs) // NOTE: Should never exceed 4.
             {
                 if (!resourceCache.contains(inputID))
                     continue;
 
-                // Generate a pointer to the resource descriptor.
-                CD3DX12_CPU_DESCRIPTOR_HANDLE resourceDescriptorHandle(mInputResourceDescriptorHeap->GetCPUDescriptorHandleForHeapStart(),
-                                                                       (4 * frameIndex) + mInputToChannelMap[inputID],
-                                                                       gSRVDescriptorSize);
+                auto inputFrameIndex = IsHistoryInput(inputID) ? historyFrameIndex : frameIndex;
+
+                auto resourceDescriptorHandle = pTextureHeap->GetAddressCPU(mInputTable + kChannelCount * frameIndex + mInputToChannelMap[inputID]);
 
                 // Create SRV for the resource.
                 // ------------------------------------------------
 
-                auto* pResource = gResourceRegistry->Get(resourceCache.at(inputID)[frameIndex]);
+                auto* pResource = gResourceRegistry->Get(resourceCache.at(inputID)[inputFrameIndex]);
 
                 // Recover the image's format.
                 auto resourceInfo = pResource->GetDesc();
@@ -339,454 +514,2295 @@ namespace ICR
         }
     }
 
-    static std::mutex gRenderPassCommandMutex;
+    void RenderPass::SetUpdateRate(UpdateRate updateRate, int updateInterval)
+    {
+        mUpdateRate     = updateRate;
+        mUpdateInterval = std::max(updateInterval, 1);
+    }
 
-    void RenderPass::Dispatch(ID3D12GraphicsCommandList* pCmd)
+    void RenderPass::ResetUpdates()
     {
-        // Need to lock here because taskflow may dispatch two tasks at the same time that do not depend on each other.
-        std::lock_guard<std::mutex> commandLock(gRenderPassCommandMutex);
+        mUpdateRequested = true;
+        mSkipped         = false;
+        mOutputStale     = false;
+    }
+
+    void RenderPass::AdvanceFrame(float deltaTime)
+    {
+        const bool updatedLastFrame = !mSkipped;
+
+        mFramesSinceUpdate++;
+        mTimeSinceUpdate += deltaTime;
+
+        mSkipped = IsDecimated() && !mUpdateRequested && !(mUpdateRate == UpdateRate::EveryNthFrame && mFramesSinceUpdate >= mUpdateInterval);
+
+        // An update writes the current slot while the other one keeps the previous output. On the first skipped frame after it,
+        // the slots swap roles and the current one has to be brought up to date before anything samples it.
+        mOutputStale = mSkipped && updatedLastFrame;
+
+        if (mSkipped)
+            return;
 
+        // The time delta spans every frame since the previous update.
+        mUpdateDeltaTime   = mTimeSinceUpdate;
+        mUpdateRequested   = false;
+        mFramesSinceUpdate = 0;
+        mTimeSinceUpdate   = 0.0f;
+        mUpdateCount++;
+    }
+
+    void RenderPass::Dispatch(ID3D12GraphicsCommandList* pCmd)
+    {
         // Bind the output render target.
         // ------------------------------------------------
 
         auto renderTargetsHeap = gResourceRegistry->GetDescriptorHeap(DescriptorHeap::Type::RenderTarget);
 
         auto currentOutputRenderTargetView = renderTargetsHeap->GetAddressCPU(mOutputTargets[GetCurrentFrameIndex()].indexDescriptorRenderTarget);
-        gCommandList->OMSetRenderTargets(1, &currentOutputRenderTargetView, FALSE, nullptr);
+        pCmd->OMSetRenderTargets(1, &currentOutputRenderTargetView, FALSE, nullptr);
 
-        // Bind the input heaps.
+        // Bind the samplers, the global heaps are bound once per command list.
         // ------------------------------------------------
-        ID3D12DescriptorHeap* ppHeaps[2] = { mInputResourceDescriptorHeap.Get(), mInputSamplerDescriptorHeap.Get() };
-        pCmd->SetDescriptorHeaps(ARRAYSIZE(ppHeaps), ppHeaps);
+        pCmd->SetGraphicsRootDescriptorTable(1, gResourceRegistry->GetDescriptorHeap(DescriptorHeap::Type::Sampler)->GetAddressGPU(mSamplerTable));
 
-        // Bind the samplers.
+        // Bind the current frame's resources, history inputs were resolved when the table was written.
         // ------------------------------------------------
-        pCmd->SetGraphicsRootDescriptorTable(1, mInputSamplerDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
-
-        // Bind the current frame's resources
-        // ------------------------------------------------
-        {
-            // Obtain handle to the base of the resource descriptors.
-            CD3DX12_GPU_DESCRIPTOR_HANDLE inputResourceDescriptorHandle(mInputResourceDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
-
-            // Offset w.r.t. the frame index.
-            inputResourceDescriptorHandle.Offset(4 * GetHistoryFrameIndex(), gSRVDescriptorSize);
+        auto* pTextureHeap = gResourceRegistry->GetDescriptorHeap(DescriptorHeap::Type::Texture2D);
 
-            // Bind the input resources.
-            pCmd->SetGraphicsRootDescriptorTable(2, inputResourceDescriptorHandle);
-        }
+        pCmd->SetGraphicsRootDescriptorTable(2, pTextureHeap->GetAddressGPU(mInputTable + kChannelCount * GetCurrentFrameIndex()));
 
         // Bind the PSO.
         // ------------------------------------------------
-        pCmd->SetPipelineState(mPSO.Get());
+        pCmd->SetPipelineState(mpPipelineState);
 
         // Draw the fullscreen triangle.
         // ------------------------------------------------
         pCmd->DrawInstanced(3U, 1U, 0U, 0U);
     }
 
-    // -------------------------------------------------
-
-    RenderInputShaderToy::RenderInputShaderToy() : mShaderID(256, '\0'), mInitialized(false), mUserRequestUnload(false)
+    static D3D12_RESOURCE_STATES GetD3D12ResourceState(ResourceState state)
     {
-        // Initialize the shadertoy to a known-good one.
-        // "fractal pyramid" https://www.shadertoy.com/view/tsXBzS
-        memcpy(mShaderID.data(), "tsXBzS", 6);
-
-        // Initial async compile state.
-        mAsyncCompileStatus.store(AsyncCompileShaderToyStatus::Idle);
+        switch (state)
+        {
+            case ResourceState::RenderTarget  : return D3D12_RESOURCE_STATE_RENDER_TARGET;
+            case ResourceState::ShaderResource: return D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+            default                           : return D3D12_RESOURCE_STATE_COMMON;
+        }
     }
 
-    RenderInputShaderToy::~RenderInputShaderToy() {}
-
-    void RenderInputShaderToy::Initialize()
+    // Translates a batch planned by the render graph compiler into a single ResourceBarrier call.
+    static void RecordResourceBarriers(ID3D12GraphicsCommandList* pCmd, const std::vector<ResourceBarrier>& barriers)
     {
-        if (mInitialized)
+        if (barriers.empty())
             return;
 
-        //  Resources
-        // ---------------------------
+        std::vector<D3D12_RESOURCE_BARRIER> d3dBarriers;
+        d3dBarriers.reserve(barriers.size());
 
-        mUBO = gResourceRegistry->Create(CD3DX12_RESOURCE_DESC::Buffer(sizeof(Constants)), DescriptorHeap::Type::Constants, true);
+        for (const auto& barrier : barriers)
+        {
+            ResourceHandle handle;
+            handle.indexResource = barrier.resource;
 
-        ThrowIfFailed(gResourceRegistry->Get(mUBO)->Map(0, nullptr, &mpUBOData));
+            D3D12_RESOURCE_BARRIER_FLAGS flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
 
-        // Create the root signature (same for all render passes).
-        // ---------------------------
+            if (barrier.split == ResourceBarrier::Split::Begin)
+                flags = D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY;
+            else if (barrier.split == ResourceBarrier::Split::End)
+                flags = D3D12_RESOURCE_BARRIER_FLAG_END_ONLY;
 
-        {
-            D3D12_DESCRIPTOR_RANGE1 inputSMPRanges = {};
-            {
-                inputSMPRanges.RangeType          = D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER;
-                inputSMPRanges.NumDescriptors     = 4;
-                inputSMPRanges.BaseShaderRegister = 0;
-                inputSMPRanges.RegisterSpace      = 1;
-            }
+            d3dBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(gResourceRegistry->Get(handle),
+                                                                       GetD3D12ResourceState(barrier.before),
+                                                                       GetD3D12ResourceState(barrier.after),
+                                                                       D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
+                                                                       flags));
+        }
 
-            D3D12_DESCRIPTOR_RANGE1 inputSRVRanges = {};
-            {
-                inputSRVRanges.RangeType          = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
-                inputSRVRanges.NumDescriptors     = 4;
-                inputSRVRanges.BaseShaderRegister = 0;
-                inputSRVRanges.RegisterSpace      = 1;
-            }
+        pCmd->ResourceBarrier(static_cast<UINT>(d3dBarriers.size()), d3dBarriers.data());
+    }
 
-            std::array<CD3DX12_ROOT_PARAMETER1, 3> rootParameters;
-            {
-                // Constants (includes the ShaderToy inputs).
-                rootParameters[0].InitAsConstantBufferView(0, 0, D3D12_ROOT_DESCRIPTOR_FLAG_DATA_VOLATILE, D3D12_SHADER_VISIBILITY_PIXEL);
+    // Records the levels of a render graph frame: the global heaps and root signature per list, then the planned barriers and
+    // the passes (decimated passes with their own constants, skipped ones not at all).
+    class RenderGraphLevelRecorder : public LevelRecorder<DeviceCommandList>
+    {
+    public:
+
+        RenderGraphLevelRecorder(RenderInputShaderToy::RenderGraph&                renderGraph,
+                                 ID3D12RootSignature*                              pRootSignature,
+                                 const D3D12_VIEWPORT&                             viewport,
+                                 const D3D12_RECT&                                 scissor,
+                                 D3D12_GPU_VIRTUAL_ADDRESS                         constantsAddress,
+                                 const std::vector<ConstantAllocator::Allocation>& renderPassConstants,
+                                 bool                                              decimate) :
+            mRenderGraph(renderGraph),
+            mpRootSignature(pRootSignature),
+            mViewport(viewport),
+            mScissor(scissor),
+            mConstantsAddress(constantsAddress),
+            mRenderPassConstants(renderPassConstants),
+            mDecimate(decimate)
+        {}
+
+        void Begin(DeviceCommandList& commandList) override
+        {
+            auto* pCmd = commandList.commandList.Get();
 
-                // These can't be static samplers since it can vary per-pass.
-                rootParameters[1].InitAsDescriptorTable(1, &inputSMPRanges, D3D12_SHADER_VISIBILITY_PIXEL);
-                rootParameters[2].InitAsDescriptorTable(1, &inputSRVRanges, D3D12_SHADER_VISIBILITY_PIXEL);
-            }
+            pCmd->RSSetViewports(1U, &mViewport);
+            pCmd->RSSetScissorRects(1U, &mScissor);
 
-            D3D12_VERSIONED_ROOT_SIGNATURE_DESC rootSignatureDesc = {};
+            // One shader resource and one sampler heap hold the tables of every pass.
+            gResourceRegistry->BindDescriptorHeaps(pCmd, DescriptorHeap::Type::Texture2D | DescriptorHeap::Type::Sampler);
 
-            rootSignatureDesc.Version                = D3D_ROOT_SIGNATURE_VERSION_1_0;
-            rootSignatureDesc.Desc_1_0.NumParameters = static_cast<UINT>(rootParameters.size());
-            rootSignatureDesc.Desc_1_0.pParameters   = reinterpret_cast<const D3D12_ROOT_PARAMETER*>(rootParameters.data());
+            // Root signature is the same for all render passes, so set it once per list.
+            pCmd->SetGraphicsRootSignature(mpRootSignature);
+            pCmd->SetGraphicsRootConstantBufferView(0u, mConstantsAddress);
+            pCmd->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        }
 
-            ComPtr<ID3DBlob> pBlobSignature;
-            ComPtr<ID3DBlob> pBlobError;
-            if (FAILED(D3D12SerializeVersionedRootSignature(&rootSignatureDesc, &pBlobSignature, &pBlobError)))
-            {
-                if (pBlobError)
-                    spdlog::error((static_cast<char*>(pBlobError->GetBufferPointer())));
+        void RecordAliasing(DeviceCommandList& commandList, const std::vector<uint32_t>& resources) override
+        {
+            std::vector<D3D12_RESOURCE_BARRIER> aliasingBarriers;
 
-                return;
-            }
+            for (uint32_t resource : resources)
+                aliasingBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Aliasing(nullptr, GetResource(resource)));
 
-            ThrowIfFailed(gLogicalDevice->CreateRootSignature(0,
-                                                              pBlobSignature->GetBufferPointer(),
-                                                              pBlobSignature->GetBufferSize(),
-                                                              IID_PPV_ARGS(&mRootSignature)));
+            commandList.commandList->ResourceBarrier(static_cast<UINT>(aliasingBarriers.size()), aliasingBarriers.data());
         }
 
-        // Compile
-        // ---------------------------
+        void RecordBarriers(DeviceCommandList& commandList, const std::vector<ResourceBarrier>& barriers) override
+        {
+            RecordResourceBarriers(commandList.commandList.Get(), barriers);
+        }
 
-        // Set am idle compile status before attempting anything.
-        mAsyncCompileStatus.store(AsyncCompileShaderToyStatus::Idle);
+        void RecordDiscards(DeviceCommandList& commandList, const std::vector<uint32_t>& resources) override
+        {
+            for (uint32_t resource : resources)
+                commandList.commandList->DiscardResource(GetResource(resource), nullptr);
+        }
 
-        // Re-load PSO
-        if (!mShaderID.empty() && !mUserRequestUnload)
+        void RecordPasses(DeviceCommandList& commandList, size_t levelIndex) override
         {
-            mAsyncCompileStatus.store(AsyncCompileShaderToyStatus::Compiling);
+            auto* pCmd = commandList.commandList.Get();
+
+            for (auto* pRenderPass : mRenderGraph.levels[levelIndex])
+            {
+                if (mDecimate && pRenderPass->IsSkipped())
+                    continue;
 
-            gTaskGroup.run(
-                [&]()
+                if (!mDecimate || !pRenderPass->IsDecimated())
                 {
-                    if (CompileShaderToy(mShaderID))
-                        mAsyncCompileStatus.store(AsyncCompileShaderToyStatus::Compiled);
-                    else
-                        mAsyncCompileStatus.store(AsyncCompileShaderToyStatus::Failed);
-                });
+                    pRenderPass->Dispatch(pCmd);
+                    continue;
+                }
+
+                auto renderPassIndex = std::find_if(mRenderGraph.renderPasses.begin(),
+                                                    mRenderGraph.renderPasses.end(),
+                                                    [&](const auto& renderPass) { return renderPass.get() == pRenderPass; }) -
+                                       mRenderGraph.renderPasses.begin();
+
+                pCmd->SetGraphicsRootConstantBufferView(0u, mRenderPassConstants[renderPassIndex].gpuAddress);
+                pRenderPass->Dispatch(pCmd);
+                pCmd->SetGraphicsRootConstantBufferView(0u, mConstantsAddress);
+            }
         }
 
-        mInitialized = true;
-    }
+        void End(DeviceCommandList& commandList) override { ThrowIfFailed(commandList.commandList->Close()); }
 
-    ID3D12GraphicsCommandList* pCommandList = nullptr;
+    private:
 
-    bool RenderInputShaderToy::BuildRenderGraph(const nlohmann::json& parsedShaderToy)
-    {
-        // Intermediate memory for tracking renderpass dependencies.
-        std::unordered_map<int, tf::Task> renderPassTaskMap;
+        static ID3D12Resource* GetResource(uint32_t resource)
+        {
+            ResourceHandle handle;
+            handle.indexResource = resource;
 
-        mRenderGraph.clear();
-        mRenderPasses.clear();
-        mCommonShaderGLSL.clear();
-        mResourceCache.clear();
-        mMediaResources.clear();
+            return gResourceRegistry->Get(handle);
+        }
 
-        // Scan 1) Pre-pass for the common shader.
-        for (const auto& renderPassInfo : parsedShaderToy["Shader"]["renderpass"])
+        RenderInputShaderToy::RenderGraph&                mRenderGraph;
+        ID3D12RootSignature*                              mpRootSignature;
+        const D3D12_VIEWPORT&                             mViewport;
+        const D3D12_RECT&                                 mScissor;
+        D3D12_GPU_VIRTUAL_ADDRESS                         mConstantsAddress;
+        const std::vector<ConstantAllocator::Allocation>& mRenderPassConstants;
+        bool                                              mDecimate;
+    };
+
+    static void SetVideoChannelConstants(RenderInputShaderToy::Constants&                                    constants,
+                                         const std::vector<RenderInputShaderToy::RenderGraph::VideoChannel>& videoChannels)
+    {
+        for (const auto& videoChannel : videoChannels)
         {
-            if (renderPassInfo["name"] != "Common")
-                continue;
+            (&constants.iChannelTime.x)[videoChannel.channel] = videoChannel.stream->GetChannelTime();
 
-            // Extract the common shader which is just a fake render pass that
-            // serves as a container for the common shader code.
-            mCommonShaderGLSL = renderPassInfo["code"].get<std::string>();
-            break;
+            constants.iChannelResolution[videoChannel.channel] = { static_cast<float>(videoChannel.stream->GetWidth()),
+                                                                   static_cast<float>(videoChannel.stream->GetHeight()),
+                                                                   1.0f,
+                                                                   0.0f };
         }
+    }
 
-        // Scan 2) Initialize all render passes.
-        for (const auto& renderPassInfo : parsedShaderToy["Shader"]["renderpass"])
+    // Peak signal-to-noise ratio between two RGBA8 images over the color channels (alpha is not presented), infinite if identical.
+    static double ComputePSNR(const std::vector<uint8_t>& image, const std::vector<uint8_t>& referenceImage)
+    {
+        double squaredError = 0.0;
+
+        for (size_t byteIndex = 0; byteIndex < image.size(); byteIndex++)
         {
-            if (renderPassInfo["name"] == "Common")
+            if (byteIndex % 4 == 3)
                 continue;
 
-            try
-            {
-                RenderPass::Args renderPassArgs = { mRootSignature.Get(), renderPassInfo, mCommonShaderGLSL };
+            double error = static_cast<double>(image[byteIndex]) - static_cast<double>(referenceImage[byteIndex]);
 
-                // Initialize the render pass.
-                mRenderPasses.push_back(std::make_unique<RenderPass>(renderPassArgs));
-            }
-            catch (std::runtime_error& e)
-            {
-                spdlog::critical("Failed to initialize render pass: {}", e.what());
-                return false;
-            }
+            squaredError += error * error;
+        }
 
-            // Get the recently added render pass.
-            auto* renderPass = mRenderPasses.back().get();
+        if (squaredError == 0.0)
+            return std::numeric_limits<double>::infinity();
 
-            // Keep track of the final render pass.
-            if (renderPassInfo["name"] == "Image")
-                mpFinalRenderPass = renderPass;
+        double meanSquaredError = squaredError / (3.0 * static_cast<double>(image.size() / 4));
 
-            // Insert the render pass output into the input provider.
-            mResourceCache[renderPass->GetOutputID()][0] = renderPass->GetOutputResources()[0];
-            mResourceCache[renderPass->GetOutputID()][1] = renderPass->GetOutputResources()[1];
+        return 10.0 * std::log10((255.0 * 255.0) / meanSquaredError);
+    }
+
+    // Render Graph
+    // -------------------------------------------------
+
+    using RenderGraph = RenderInputShaderToy::RenderGraph;
+
+    RenderGraph::~RenderGraph()
+    {
+        // Placed outputs have to go before the heap backing them.
+        ReleaseOutputTargets();
+
+        renderPasses.clear();
+
+        // Media is shared with other graphs, only drop the references.
+        for (const auto& mediaSrc : mediaSources)
+            gMediaCache->Release(mediaSrc);
+    }
+
+    void RenderGraph::Compile()
+    {
+        std::vector<PassDeclaration> passDeclarations;
+
+        for (const auto& renderPass : renderPasses)
+            passDeclarations.push_back({ renderPass->GetOutputID(), renderPass->GetInputIDs(), renderPass.get() == pFinalRenderPass });
+
+        schedule = std::make_unique<RenderGraphSchedule>(passDeclarations);
+
+        for (size_t renderPassIndex = 0; renderPassIndex < renderPasses.size(); renderPassIndex++)
+            renderPasses[renderPassIndex]->SetHistoryInputIDs(schedule->GetHistoryInputIDs()[renderPassIndex]);
+
+        levels.clear();
+
+        for (const auto& level : schedule->GetLevels())
+        {
+            auto& renderPassLevel = levels.emplace_back();
+
+            for (auto renderPassIndex : level)
+                renderPassLevel.push_back(renderPasses[renderPassIndex].get());
+        }
+
+        culledRenderPasses.clear();
+
+        for (auto renderPassIndex : schedule->GetCulledPasses())
+        {
+            culledRenderPasses.push_back(renderPasses[renderPassIndex].get());
+
+            spdlog::info("Render graph for {}: Culled {}, its output never reaches the image.", shaderID, culledRenderPasses.back()->GetName());
+        }
+    }
+
+    void RenderGraph::ReleaseOutputTargets()
+    {
+        // Committed outputs go back into the pool in the state the barriers left them in, placed ones are released and their
+        // heap goes back as a whole.
+        for (const auto& outputAllocation : outputAllocations)
+        {
+            if (outputAllocation.placed)
+                continue;
+
+            const auto outputTargets = outputAllocation.pRenderPass->DetachOutputTargets();
+
+            gRenderTargetPool->Release(outputTargets[0], barrierCompiler.GetState(outputTargets[0].indexResource));
+
+            // Single-buffered outputs share the handle.
+            if (outputTargets[1].indexResource != outputTargets[0].indexResource)
+                gRenderTargetPool->Release(outputTargets[1], barrierCompiler.GetState(outputTargets[1].indexResource));
+        }
+
+        for (auto& renderPass : renderPasses)
+            renderPass->ReleaseOutputTargets();
+
+        if (transientHeap)
+            gRenderTargetPool->ReleaseHeap(std::move(transientHeap));
+
+        outputAllocations.clear();
+    }
+
+    static CD3DX12_RESOURCE_DESC GetOutputTargetInfo(const RenderPass* pRenderPass, const DirectX::XMINT2& size)
+    {
+        return CD3DX12_RESOURCE_DESC::Tex2D(pRenderPass->GetOutputFormat(),
+                                            static_cast<UINT>(size.x),
+                                            static_cast<UINT>(size.y),
+                                            1,
+                                            1,
+                                            1,
+                                            0,
+                                            D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
+    }
+
+    constexpr DescriptorHeapFlags kOutputDescriptorHeapFlags = DescriptorHeap::Type::RenderTarget | DescriptorHeap::Type::Texture2D;
+
+    void RenderGraph::AllocateOutputTargets()
+    {
+        ReleaseOutputTargets();
+
+        renderResolution = resolution;
+
+        // Dynamic resolution renders into a sub-rect of targets at the capacity. Otherwise the targets are created at exactly the
+        // resolution, all of them placed into memory laid out for the capacity, so that resizes only re-create them in place.
+        exactTargets = !dynamicResolution;
+
+        std::vector<TransientAllocation>    transientAllocations;
+        std::vector<std::pair<size_t, int>> transientOutputAllocationIndices; // Output allocation and buffer of each placement.
+        uint64_t                            transientHeapAlignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+
+        // States of the targets drawn from the pool, applied once the barrier tracking was reset below.
+        std::vector<std::pair<uint32_t, ResourceState>> pooledStates;
+
+        auto AcquireOutputTarget = [&](const CD3DX12_RESOURCE_DESC& outputTargetInfo, ResourceRegistry::MemoryCategory category)
+        {
+            ResourceState state;
+
+            auto outputTarget = gRenderTargetPool->Acquire(outputTargetInfo, kOutputDescriptorHeapFlags, category, &state);
+
+            pooledStates.push_back({ outputTarget.indexResource, state });
+
+            return outputTarget;
+        };
+
+        for (size_t renderPassIndex = 0; renderPassIndex < renderPasses.size(); renderPassIndex++)
+        {
+            // Culled passes never render, so they get neither targets nor descriptor tables.
+            if (schedule->IsCulled(renderPassIndex))
+                continue;
+
+            auto* pRenderPass = renderPasses[renderPassIndex].get();
+
+            const auto& lifetime = schedule->GetLifetimes()[renderPassIndex];
+
+            auto outputTargetInfo = GetOutputTargetInfo(pRenderPass, capacity);
+            auto allocationInfo   = gLogicalDevice->GetResourceAllocationInfo(0, 1, &outputTargetInfo);
+
+            OutputAllocation outputAllocation = {};
+            {
+                outputAllocation.pRenderPass = pRenderPass;
+                outputAllocation.history     = lifetime.history;
+                outputAllocation.persistent  = !lifetime.history && pRenderPass->IsDecimated();
+                outputAllocation.placed      = exactTargets || (!outputAllocation.history && !outputAllocation.persistent);
+                outputAllocation.size        = allocationInfo.SizeInBytes;
+                outputAllocation.firstLevel  = lifetime.firstLevel;
+                outputAllocation.lastLevel   = lifetime.lastLevel;
+            }
+            outputAllocations.push_back(outputAllocation);
+
+            pRenderPass->ResetUpdates();
+
+            if (!outputAllocation.placed)
+            {
+                if (lifetime.history)
+                {
+                    pRenderPass->SetOutputTargets({ AcquireOutputTarget(outputTargetInfo, ResourceRegistry::MemoryCategory::History),
+                                                    AcquireOutputTarget(outputTargetInfo, ResourceRegistry::MemoryCategory::History) });
+                }
+                else
+                {
+                    auto outputTarget = AcquireOutputTarget(outputTargetInfo, ResourceRegistry::MemoryCategory::PassOutputs);
+
+                    pRenderPass->SetOutputTargets({ outputTarget, outputTarget });
+                }
+
+                continue;
+            }
+
+            // Outputs that outlive the frame span every level, so nothing aliases them.
+            const bool   aliased    = !outputAllocation.history && !outputAllocation.persistent;
+            const size_t firstLevel = aliased ? lifetime.firstLevel : 0u;
+            const size_t lastLevel  = aliased ? lifetime.lastLevel : std::max(levels.size(), size_t(1)) - 1u;
+
+            for (int buffer = 0; buffer < (outputAllocation.history ? 2 : 1); buffer++)
+            {
+                transientAllocations.push_back({ allocationInfo.SizeInBytes, firstLevel, lastLevel, 0u });
+                transientOutputAllocationIndices.push_back({ outputAllocations.size() - 1, buffer });
+            }
+
+            transientHeapAlignment = std::max(transientHeapAlignment, allocationInfo.Alignment);
+        }
+
+        if (!transientAllocations.empty())
+        {
+            auto transientHeapSize = PlaceTransientAllocations(transientAllocations, transientHeapAlignment);
+
+            transientHeap = gRenderTargetPool->AcquireHeap({ transientHeapSize, transientHeapAlignment });
+
+            for (size_t transientIndex = 0; transientIndex < transientAllocations.size(); transientIndex++)
+            {
+                const auto [outputAllocationIndex, buffer] = transientOutputAllocationIndices[transientIndex];
+
+                outputAllocations[outputAllocationIndex].heapOffsets[buffer] = transientAllocations[transientIndex].heapOffset;
+            }
+        }
+
+        CreatePlacedOutputTargets();
+
+        PrepareOutputTargets(pooledStates);
+
+        spdlog::info("Render graph for {}: {:.1f} MB of {}x{} render targets ({:.1f} MB saved by single-buffering and aliasing).",
+                     shaderID,
+                     GetDeviceMemorySize() / (1024.0f * 1024.0f),
+                     capacity.x,
+                     capacity.y,
+                     (GetDoubleBufferedMemorySize() - GetDeviceMemorySize()) / (1024.0f * 1024.0f));
+    }
+
+    void RenderGraph::CreatePlacedOutputTargets()
+    {
+        const auto targetSize = exactTargets ? resolution : capacity;
+
+        for (const auto& outputAllocation : outputAllocations)
+        {
+            if (!outputAllocation.placed)
+                continue;
+
+            auto outputTargetInfo = GetOutputTargetInfo(outputAllocation.pRenderPass, targetSize);
+
+            auto outputTarget = gResourceRegistry->CreatePlaced(outputTargetInfo,
+                                                                kOutputDescriptorHeapFlags,
+                                                                transientHeap.Get(),
+                                                                outputAllocation.heapOffsets[0]);
+
+            if (!outputAllocation.history)
+            {
+                outputAllocation.pRenderPass->SetOutputTargets({ outputTarget, outputTarget });
+                continue;
+            }
+
+            outputAllocation.pRenderPass->SetOutputTargets({ outputTarget,
+                                                             gResourceRegistry->CreatePlaced(outputTargetInfo,
+                                                                                             kOutputDescriptorHeapFlags,
+                                                                                             transientHeap.Get(),
+                                                                                             outputAllocation.heapOffsets[1]) });
+        }
+    }
+
+    void RenderGraph::RecreatePlacedOutputTargets()
+    {
+        // The previous targets may still be in flight, their release is deferred. The new ones take over the memory in queue
+        // order, and are cleared or discarded before their first use like freshly allocated ones.
+        for (const auto& outputAllocation : outputAllocations)
+        {
+            outputAllocation.pRenderPass->ResetUpdates();
+
+            if (outputAllocation.placed)
+                outputAllocation.pRenderPass->ReleaseOutputTargets();
+        }
+
+        CreatePlacedOutputTargets();
+
+        PrepareOutputTargets({});
+    }
+
+    void RenderGraph::PrepareOutputTargets(const std::vector<std::pair<uint32_t, ResourceState>>& pooledStates)
+    {
+        // Now that all input resources are allocated, each render pass can build their srv heap.
+        for (const auto& outputAllocation : outputAllocations)
+            resourceCache[outputAllocation.pRenderPass->GetOutputID()] = outputAllocation.pRenderPass->GetOutputResources();
+
+        for (const auto& outputAllocation : outputAllocations)
+            outputAllocation.pRenderPass->CreateInputResourceDescriptorTable(resourceCache);
+
+        // Resource accesses of each level for both frame indices.
+        // ------------------------------------------------
+
+        auto IsRenderPassOutput = [&](int inputID)
+        {
+            return std::any_of(renderPasses.begin(),
+                               renderPasses.end(),
+                               [&](const auto& renderPass) { return renderPass->GetOutputID() == inputID; });
+        };
+
+        for (int frameIndex = 0; frameIndex < 2; frameIndex++)
+        {
+            const int historyFrameIndex = (frameIndex + 1) % 2;
+
+            levelAccesses[frameIndex].clear();
+
+            for (const auto& level : levels)
+            {
+                auto& levelAccess = levelAccesses[frameIndex].emplace_back();
+
+                for (auto* pRenderPass : level)
+                {
+                    auto& passAccess = levelAccess.emplace_back();
+
+                    passAccess.writes.push_back(pRenderPass->GetOutputResources()[frameIndex].indexResource);
+
+                    // Media and video inputs are not render targets and stay out of the state tracking.
+                    for (int inputID : pRenderPass->GetInputIDs())
+                    {
+                        if (!IsRenderPassOutput(inputID))
+                            continue;
+
+                        auto inputFrameIndex = pRenderPass->IsHistoryInput(inputID) ? historyFrameIndex : frameIndex;
+
+                        passAccess.reads.push_back(resourceCache.at(inputID)[inputFrameIndex].indexResource);
+                    }
+                }
+            }
+        }
+
+        // New output targets start out in the common state, pooled ones in whatever state they were returned in. History outputs
+        // are read before they are first written, so they get cleared ahead of their first frame, transient ones are discarded
+        // whenever they take over their memory. Persistent ones are always written by the first frame (their pass is due for an
+        // update), placed ones are cleared first as they take over memory.
+        barrierCompiler.Reset();
+        pendingClears.clear();
+
+        for (const auto& [resource, state] : pooledStates)
+            barrierCompiler.SetState(resource, state);
+
+        for (const auto& outputAllocation : outputAllocations)
+        {
+            const auto outputTargets = outputAllocation.pRenderPass->GetOutputResources();
+
+            if (outputAllocation.history)
+            {
+                pendingClears.insert(pendingClears.end(), outputTargets.begin(), outputTargets.end());
+                continue;
+            }
+
+            if (outputAllocation.persistent)
+            {
+                if (outputAllocation.placed)
+                    pendingClears.push_back(outputTargets[0]);
+
+                continue;
+            }
+
+            barrierCompiler.SetAliased(outputTargets[0].indexResource);
+        }
+    }
+
+    bool RenderGraph::Resize(const DirectX::XMINT2& newResolution)
+    {
+        resolution = newResolution;
+
+        const bool grow = resolution.x > capacity.x || resolution.y > capacity.y;
+
+        const bool shrink = static_cast<float>(resolution.x) * static_cast<float>(resolution.y) <
+                            kTargetCapacityShrinkArea * static_cast<float>(capacity.x) * static_cast<float>(capacity.y);
+
+        // Dynamic resolution was toggled, the targets change between capacity-sized and exact ones.
+        const bool relayout = exactTargets == dynamicResolution;
+
+        if (grow || shrink || relayout)
+        {
+            capacity = GetTargetCapacity(resolution);
+
+            AllocateOutputTargets();
+
+            return true;
+        }
+
+        renderResolution = resolution;
+
+        // Exact targets are re-created at the new resolution in the memory they already have (which also restarts history).
+        if (exactTargets)
+        {
+            RecreatePlacedOutputTargets();
+
+            return false;
+        }
+
+        // History is stale at the new resolution and restarts cleared, as after an allocation. The clears are batched into the
+        // prologue of the next frame, everything else (targets, descriptors, level accesses) stays as it is.
+        pendingClears.clear();
+
+        for (const auto& outputAllocation : outputAllocations)
+        {
+            // Decimated passes re-render at the new resolution right away.
+            outputAllocation.pRenderPass->ResetUpdates();
+
+            if (!outputAllocation.history)
+                continue;
+
+            const auto outputTargets = outputAllocation.pRenderPass->GetOutputResources();
+
+            pendingClears.insert(pendingClears.end(), outputTargets.begin(), outputTargets.end());
+        }
+
+        return false;
+    }
+
+    DirectX::XMFLOAT2 RenderGraph::GetRenderScale() const
+    {
+        if (!dynamicResolution)
+            return { 1.0f, 1.0f };
+
+        return { static_cast<float>(renderResolution.x) / static_cast<float>(capacity.x),
+                 static_cast<float>(renderResolution.y) / static_cast<float>(capacity.y) };
+    }
+
+    uint64_t RenderGraph::GetDeviceMemorySize() const
+    {
+        uint64_t size = transientHeap ? transientHeap->GetSize() : 0u;
+
+        for (const auto& outputAllocation : outputAllocations)
+        {
+            if (outputAllocation.placed)
+                continue;
+
+            size += outputAllocation.history ? 2u * outputAllocation.size : outputAllocation.size;
+        }
+
+        // NOTE: Media is accounted for (and budgeted) by the media cache.
+
+        return size;
+    }
+
+    uint64_t RenderGraph::GetDoubleBufferedMemorySize() const
+    {
+        uint64_t size = 0u;
+
+        for (const auto& outputAllocation : outputAllocations)
+            size += 2u * outputAllocation.size;
+
+        return size;
+    }
+
+    uint64_t RenderGraph::GetHostMemorySize() const
+    {
+        uint64_t size = sizeof(RenderGraph) + commonShaderGLSL.size();
+
+        for (const auto& renderPass : renderPasses)
+            size += sizeof(RenderPass) + renderPass->GetSPIRV().size() * sizeof(uint32_t) + renderPass->GetDXIL().size();
+
+        return size;
+    }
+
+    // Compares re-allocating every output target per resize (at exactly the new resolution, as before targets had a capacity)
+    // against Resize(), over the sizes of a window drag shrinking the viewport a few pixels at a time. GPU has to be idle.
+    static void BenchmarkResize(RenderGraph& renderGraph)
+    {
+        constexpr int kResizeCount = 64;
+
+        const auto initialResolution = renderGraph.resolution;
+
+        auto GetDragResolution = [&](int resizeIndex) -> DirectX::XMINT2
+        {
+            return { std::max(initialResolution.x - 4 * resizeIndex, 1), std::max(initialResolution.y - 2 * resizeIndex, 1) };
+        };
+
+        // Old: Fresh targets (and descriptor tables) at every size.
+        double reallocateMs;
+        {
+            auto start = std::chrono::steady_clock::now();
+
+            for (int resizeIndex = 0; resizeIndex < kResizeCount; resizeIndex++)
+            {
+                renderGraph.resolution = GetDragResolution(resizeIndex);
+                renderGraph.capacity   = renderGraph.resolution;
+                renderGraph.AllocateOutputTargets();
+            }
+
+            reallocateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / kResizeCount;
+        }
+
+        // Start from the capacity a regular resize to the initial resolution would pick.
+        renderGraph.resolution = initialResolution;
+        renderGraph.capacity   = GetTargetCapacity(initialResolution);
+        renderGraph.AllocateOutputTargets();
+
+        // New: Targets are kept within the capacity.
+        double resizeMs;
+        int    reallocationCount = 0;
+        {
+            auto start = std::chrono::steady_clock::now();
+
+            for (int resizeIndex = 0; resizeIndex < kResizeCount; resizeIndex++)
+                reallocationCount += renderGraph.Resize(GetDragResolution(resizeIndex)) ? 1 : 0;
+
+            resizeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / kResizeCount;
+        }
+
+        renderGraph.Resize(initialResolution);
+
+        spdlog::info("Resize ({} passes, {} resizes): Re-allocate {:.4f} ms/resize, Capacity {:.4f} ms/resize ({} re-allocations)",
+                     renderGraph.renderPasses.size(),
+                     kResizeCount,
+                     reallocateMs,
+                     resizeMs,
+                     reallocationCount);
+    }
+
+    // -------------------------------------------------
+
+    RenderInputShaderToy::RenderInputShaderToy() :
+        mRenderGraphCacheBudgetDeviceMB(2048),
+        mRenderGraphCacheBudgetHostMB(256),
+        mOutputPrecisionThresholdPSNR(45.0f),
+        mIterationsPerFrame(1),
+        mTiledRenderResolution { 15360, 8640 },
+        mTiledRenderFrameCount(1),
+        mTiledRenderTargetTileMs(50.0f),
+        mTiledRenderConfirmMultiPass(false),
+        mDynamicResolution(false),
+        mResolutionScaleController({ 1000.0 / 60.0, 0.05, 0.3, 0.25, 1.0 }),
+        mShaderID(256, '\0'),
+        mInitialized(false),
+        mUserRequestUnload(false)
+    {
+        // Initialize the shadertoy to a known-good one.
+        // "fractal pyramid" https://www.shadertoy.com/view/tsXBzS
+        memcpy(mShaderID.data(), "tsXBzS", 6);
+
+        // Initial async compile state.
+        mAsyncCompileStatus.store(AsyncCompileShaderToyStatus::Idle);
+    }
+
+    RenderInputShaderToy::~RenderInputShaderToy() {}
+
+    void RenderInputShaderToy::Initialize()
+    {
+        if (mInitialized)
+            return;
+
+        // Create the root signature (same for all render passes).
+        // ---------------------------
+
+        {
+            D3D12_DESCRIPTOR_RANGE1 inputSMPRanges = {};
+            {
+                inputSMPRanges.RangeType          = D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER;
+                inputSMPRanges.NumDescriptors     = kChannelCount;
+                inputSMPRanges.BaseShaderRegister = 0;
+                inputSMPRanges.RegisterSpace      = 1;
+            }
+
+            D3D12_DESCRIPTOR_RANGE1 inputSRVRanges = {};
+            {
+                inputSRVRanges.RangeType          = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+                inputSRVRanges.NumDescriptors     = kChannelCount;
+                inputSRVRanges.BaseShaderRegister = 0;
+                inputSRVRanges.RegisterSpace      = 1;
+            }
+
+            std::array<CD3DX12_ROOT_PARAMETER1, 3> rootParameters;
+            {
+                // Constants (includes the ShaderToy inputs).
+                rootParameters[0].InitAsConstantBufferView(0, 0, D3D12_ROOT_DESCRIPTOR_FLAG_DATA_VOLATILE, D3D12_SHADER_VISIBILITY_PIXEL);
+
+                // These can't be static samplers since it can vary per-pass.
+                rootParameters[1].InitAsDescriptorTable(1, &inputSMPRanges, D3D12_SHADER_VISIBILITY_PIXEL);
+                rootParameters[2].InitAsDescriptorTable(1, &inputSRVRanges, D3D12_SHADER_VISIBILITY_PIXEL);
+            }
+
+            D3D12_VERSIONED_ROOT_SIGNATURE_DESC rootSignatureDesc = {};
+
+            rootSignatureDesc.Version                = D3D_ROOT_SIGNATURE_VERSION_1_0;
+            rootSignatureDesc.Desc_1_0.NumParameters = static_cast<UINT>(rootParameters.size());
+            rootSignatureDesc.Desc_1_0.pParameters   = reinterpret_cast<const D3D12_ROOT_PARAMETER*>(rootParameters.data());
+
+            ComPtr<ID3DBlob> pBlobSignature;
+            ComPtr<ID3DBlob> pBlobError;
+            if (FAILED(D3D12SerializeVersionedRootSignature(&rootSignatureDesc, &pBlobSignature, &pBlobError)))
+            {
+                if (pBlobError)
+                    spdlog::error((static_cast<char*>(pBlobError->GetBufferPointer())));
+
+                return;
+            }
+
+            ThrowIfFailed(gLogicalDevice->CreateRootSignature(0,
+                                                              pBlobSignature->GetBufferPointer(),
+                                                              pBlobSignature->GetBufferSize(),
+                                                              IID_PPV_ARGS(&mRootSignature)));
+        }
+
+        mCommandListPool = std::make_unique<CommandListPool>(D3D12_COMMAND_LIST_TYPE_DIRECT);
+
+        mInitialized = true;
+
+        // Compile
+        // ---------------------------
+
+        LoadShaderToy();
+    }
+
+    void RenderInputShaderToy::LoadShaderToy()
+    {
+        // Set am idle compile status before attempting anything.
+        mAsyncCompileStatus.store(AsyncCompileShaderToyStatus::Idle);
+
+        if (mShaderID.empty() || mUserRequestUnload)
+            return;
+
+        // Peak memory is reported per shader, including what its graph build allocates.
+        gResourceRegistry->SetMemoryScope(mShaderID.substr(0, 6));
+
+        // Switching back to a recently used shader is free if its graph is still cached.
+        if (RestoreCachedRenderGraph(mShaderID.substr(0, 6)))
+        {
+            mAsyncCompileStatus.store(AsyncCompileShaderToyStatus::Compiled);
+            return;
+        }
+
+        // Re-load PSO
+        mAsyncCompileStatus.store(AsyncCompileShaderToyStatus::Compiling);
+
+        gTaskGroup.run(
+            [&]()
+            {
+                if (CompileShaderToy(mShaderID))
+                    mAsyncCompileStatus.store(AsyncCompileShaderToyStatus::Compiled);
+                else
+                    mAsyncCompileStatus.store(AsyncCompileShaderToyStatus::Failed);
+            });
+    }
+
+    bool RenderInputShaderToy::RestoreCachedRenderGraph(const std::string& shaderID)
+    {
+        DirectX::XMINT2 resolution = { static_cast<int32_t>(gViewport.Width), static_cast<int32_t>(gViewport.Height) };
+
+        auto cachedRenderGraph = std::find_if(mRenderGraphCache.begin(),
+                                              mRenderGraphCache.end(),
+                                              [&](const std::unique_ptr<RenderGraph>& renderGraph) { return renderGraph->shaderID == shaderID; });
+
+        if (cachedRenderGraph == mRenderGraphCache.end())
+            return false;
+
+        mRenderGraph = std::move(*cachedRenderGraph);
+        mRenderGraphCache.erase(cachedRenderGraph);
+
+        // Parked at another resolution, its targets are kept if they still fit.
+        mRenderGraph->dynamicResolution = mDynamicResolution;
+        mRenderGraph->Resize(resolution);
+
+        spdlog::info("Restored cached render graph for {} ({}x{}).", shaderID, resolution.x, resolution.y);
+
+        return true;
+    }
+
+    void RenderInputShaderToy::RetireRenderGraph()
+    {
+        if (!mRenderGraph)
+            return;
+
+        // Park the active graph as the most recently used entry.
+        mRenderGraphCache.push_front(std::move(mRenderGraph));
+
+        TrimRenderGraphCache();
+    }
+
+    void RenderInputShaderToy::TrimRenderGraphCache()
+    {
+        const uint64_t budgetDevice = static_cast<uint64_t>(mRenderGraphCacheBudgetDeviceMB) * 1024u * 1024u;
+        const uint64_t budgetHost   = static_cast<uint64_t>(mRenderGraphCacheBudgetHostMB) * 1024u * 1024u;
+
+        uint64_t sizeDevice = 0u;
+        uint64_t sizeHost   = 0u;
+
+        for (const auto& renderGraph : mRenderGraphCache)
+        {
+            sizeDevice += renderGraph->GetDeviceMemorySize();
+            sizeHost += renderGraph->GetHostMemorySize();
+        }
+
+        // Evict least recently used graphs until both budgets are met.
+        while (!mRenderGraphCache.empty() && (sizeDevice > budgetDevice || sizeHost > budgetHost))
+        {
+            auto& renderGraph = mRenderGraphCache.back();
+
+            sizeDevice -= renderGraph->GetDeviceMemorySize();
+            sizeHost -= renderGraph->GetHostMemorySize();
+
+            spdlog::info("Evicted cached render graph for {} ({}x{}).", renderGraph->shaderID, renderGraph->resolution.x, renderGraph->resolution.y);
+
+            mRenderGraphCache.pop_back();
+        }
+    }
+
+    bool RenderInputShaderToy::BuildRenderGraph(const std::string& shaderID, const nlohmann::json& parsedShaderToy)
+    {
+        // Build into a fresh graph so that a failure leaves nothing half-initialized behind.
+        auto renderGraph = std::make_unique<RenderGraph>();
+
+        renderGraph->shaderID   = shaderID;
+        renderGraph->resolution = { static_cast<int32_t>(gViewport.Width), static_cast<int32_t>(gViewport.Height) };
+
+        // Scan 1) Pre-pass for the common shader.
+        for (const auto& renderPassInfo : parsedShaderToy["Shader"]["renderpass"])
+        {
+            if (renderPassInfo["name"] != "Common")
+                continue;
+
+            // Extract the common shader which is just a fake render pass that
+            // serves as a container for the common shader code.
+            renderGraph->commonShaderGLSL = renderPassInfo["code"].get<std::string>();
+            break;
+        }
+
+        // Scan 2) Initialize all render passes.
+        for (const auto& renderPassInfo : parsedShaderToy["Shader"]["renderpass"])
+        {
+            if (renderPassInfo["name"] == "Common")
+                continue;
+
+            try
+            {
+                RenderPass::Args renderPassArgs = { mRootSignature.Get(), renderPassInfo, renderGraph->commonShaderGLSL };
+
+                // Initialize the render pass.
+                renderGraph->renderPasses.push_back(std::make_unique<RenderPass>(renderPassArgs));
+            }
+            catch (std::runtime_error& e)
+            {
+                spdlog::critical("Failed to initialize render pass: {}", e.what());
+                return false;
+            }
+
+            // Get the recently added render pass.
+            auto* renderPass = renderGraph->renderPasses.back().get();
+
+            // Keep track of the final render pass.
+            if (renderPassInfo["name"] == "Image")
+                renderGraph->pFinalRenderPass = renderPass;
+        }
+
+        // Parse all non-buffer inputs.
+        // ---------------------------------
+
+        std::vector<nlohmann::json> mediaInputs;
+        std::vector<nlohmann::json> videoInputs;
+
+        for (const auto& renderPass : parsedShaderToy["Shader"]["renderpass"])
+        {
+            for (const auto& input : renderPass["inputs"])
+            {
+                auto inputType = input["ctype"].get<std::string>();
+
+                // Check if any unsupported input is detected.
+                if (std::find(std::begin(kUnsupportedInputs), std::end(kUnsupportedInputs), inputType) != std::end(kUnsupportedInputs))
+                {
+                    spdlog::info("Shader requires unsupported input: {}", inputType);
+                    return false;
+                }
+
+                if (inputType == "texture" || inputType == "cubemap")
+                    mediaInputs.push_back(input);
+
+                if (inputType == "video")
+                    videoInputs.push_back(input);
+            }
+        }
+
+        // Obtain any media from server.
+        // ---------------------------------
+
+        std::unordered_set<int> processedInputs;
+
+        for (const auto& mediaInput : mediaInputs)
+        {
+            int mediaInputId = mediaInput["id"].get<int>();
+
+            if (processedInputs.contains(mediaInputId))
+                continue;
+
+            processedInputs.insert(mediaInputId);
+
+            // Stock media is shared between shaders, so only the first shader to use it pays for download + decode + upload.
+            auto mediaSrc = mediaInput["src"].get<std::string>();
+
+            const auto* pMedia = gMediaCache->Acquire(mediaSrc);
+
+            if (!pMedia)
+                return false;
+
+            // Keep the reference for the lifetime of the graph.
+            renderGraph->mediaSources.push_back(mediaSrc);
+
+            // And specify it here.
+            renderGraph->resourceCache[mediaInputId][0] = pMedia->resource;
+            renderGraph->resourceCache[mediaInputId][1] = renderGraph->resourceCache[mediaInputId][0]; // No history for media.
+        }
+
+        // Media uploads of this build (and of any concurrent one sharing cached media) go out in one batch, a single wait.
+        if (!mediaInputs.empty())
+            gUploadQueue->Finish();
+
+        // Open any video streams from local files.
+        // ---------------------------------
+
+        for (const auto& videoInput : videoInputs)
+        {
+            int videoInputId = videoInput["id"].get<int>();
+
+            if (processedInputs.contains(videoInputId))
+                continue;
+
+            processedInputs.insert(videoInputId);
+
+            // Videos are not downloaded, they are expected to be decoded locally under Media\<name>.
+            auto videoPath = std::filesystem::path("Media") / std::filesystem::path(videoInput["src"].get<std::string>()).stem();
+
+            auto decoder = CreateVideoDecoder(videoPath.string());
+
+            if (!decoder)
+            {
+                spdlog::error("No local video found for channel input {} (expected at {}).", videoInputId, videoPath.string());
+                return false;
+            }
+
+            auto& videoChannel = renderGraph->videoChannels.emplace_back();
+
+            videoChannel.inputID = videoInputId;
+            videoChannel.channel = videoInput["channel"].get<int>();
+            videoChannel.stream  = std::make_unique<VideoStream>(std::move(decoder));
+
+            renderGraph->resourceCache[videoInputId][0] = videoChannel.stream->GetTexture();
+            renderGraph->resourceCache[videoInputId][1] = renderGraph->resourceCache[videoInputId][0]; // No history for video.
+        }
+
+        // Scan 3) Resolve all render pass dependencies into the levels executed every frame.
+        try
+        {
+            renderGraph->Compile();
+        }
+        catch (std::runtime_error& e)
+        {
+            spdlog::critical("Failed to compile render graph: {}", e.what());
+            return false;
+        }
+
+        // Videos only sampled by culled passes are not decoded.
+        std::erase_if(renderGraph->videoChannels,
+                      [&](const RenderGraph::VideoChannel& videoChannel)
+                      {
+                          for (const auto& level : renderGraph->levels)
+                          {
+                              for (auto* pRenderPass : level)
+                              {
+                                  const auto& inputIDs = pRenderPass->GetInputIDs();
+
+                                  if (std::find(inputIDs.begin(), inputIDs.end(), videoChannel.inputID) != inputIDs.end())
+                                      return false;
+                              }
+                          }
+
+                          renderGraph->resourceCache.erase(videoChannel.inputID);
+
+                          return true;
+                      });
+
+        // Output lifetimes are known now, allocate them (this also builds the srv heaps of each render pass).
+        renderGraph->dynamicResolution = mDynamicResolution;
+        renderGraph->capacity          = GetTargetCapacity(renderGraph->resolution);
+        renderGraph->AllocateOutputTargets();
+
+        mRenderGraph = std::move(renderGraph);
+
+        return true;
+    }
+
+    bool RenderInputShaderToy::CompileShaderToy(const std::string& shaderID)
+    {
+        // 1) Download the shader toy shader.
+        // -----------------------------------
+
+        auto data = QueryURL<std::string>("https://www.shadertoy.com/api/v1/shaders/" + shaderID.substr(0, 6) + "?key=BtrjRM");
+
+        // 2) Parse result into JSON.
+        // --------------------------
+
+        nlohmann::json parsedData = nlohmann::json::parse(data);
+
+#ifdef _DEBUG
+        // Keep the result in debug builds for optional viewing.
+        mShaderAPIRequestResult = parsedData;
+#endif
+
+        // 3) Compile GLSL to SPIR-V.
+        // ---------------------------
+
+        if (parsedData.contains("Error"))
+        {
+            spdlog::info("Requested shader is not publically available via API.");
+            return false;
+        }
+
+        // Build task-graph.
+        if (!BuildRenderGraph(shaderID.substr(0, 6), parsedData))
+            return false;
+
+        return true;
+    }
+
+    void RenderInputShaderToy::ResizeViewportTargets(const DirectX::XMINT2& dim)
+    {
+        // The graph is at the tiled render's resolution.
+        if (mTiledRender)
+            FinishTiledRender(true);
+
+        // Re-set internal frame counter.
+        gInternalFrameIndex = 0;
+
+        if (!mRenderGraph)
+            return;
+
+        // The schedule does not depend on the resolution, only the output targets may need to be re-created.
+        mRenderGraph->Resize(dim);
+    }
+
+    void RenderInputShaderToy::RenderInterface()
+    {
+        if (mAsyncCompileStatus.load() == AsyncCompileShaderToyStatus::Compiling)
+        {
+            ImGui::SetNextWindowPos(ImVec2(gViewport.TopLeftX + (0.5f * gViewport.Width), gViewport.Height * 0.5f),
+                                    ImGuiCond_Always,
+                                    ImVec2(0.5f, 0.5f));
+
+            ImGui::Begin("##ShaderToyProgress", nullptr, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoTitleBar);
+            ImGui::ProgressBar(-1.0f * (float)ImGui::GetTime(), ImVec2(0, 0), "Loading");
+            ImGui::End();
+        }
+
+        if (mTiledRender)
+        {
+            ImGui::SetNextWindowPos(ImVec2(gViewport.TopLeftX + (0.5f * gViewport.Width), gViewport.Height * 0.5f),
+                                    ImGuiCond_Always,
+                                    ImVec2(0.5f, 0.5f));
+
+            ImGui::Begin("##ShaderToyTiledRender",
+                         nullptr,
+                         ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoTitleBar);
+            ImGui::ProgressBar(static_cast<float>(mTiledRender->scheduler->GetProgress()), ImVec2(0, 0), "Tiled Render");
+            ImGui::Text("%u tiles, tile size %u", mTiledRender->scheduler->GetTileCount(), mTiledRender->scheduler->GetTileSize());
+
+            if (ImGui::Button("Cancel", ImVec2(ImGui::GetContentRegionAvail().x, 0)))
+            {
+                gPreRenderTaskQueue.push(
+                    [&]()
+                    {
+                        if (mTiledRender)
+                            FinishTiledRender(true);
+                    });
+            }
+
+            ImGui::End();
+        }
+
+        if (ImGui::BeginChild("##ShaderToy", ImVec2(0, 0), ImGuiChildFlags_AutoResizeY | ImGuiChildFlags_Borders))
+        {
+            ImGui::InputText("Shader ID", mShaderID.data(), mShaderID.size());
+
+            // The async build writes the active graph, so it can't be swapped out until it finishes.
+            ImGui::BeginDisabled(mAsyncCompileStatus.load() == AsyncCompileShaderToyStatus::Compiling || mTiledRender);
+
+            if (ImGui::Button("Load", ImVec2(ImGui::GetContentRegionAvail().x, 0)))
+            {
+                gPreRenderTaskQueue.push(
+                    [&]()
+                    {
+                        mUserRequestUnload = false;
+                        RetireRenderGraph();
+                        LoadShaderToy();
+                    });
+            }
+
+            if (ImGui::Button("Unload", ImVec2(ImGui::GetContentRegionAvail().x, 0)))
+            {
+                gPreRenderTaskQueue.push(
+                    [&]()
+                    {
+                        mUserRequestUnload = true;
+                        RetireRenderGraph();
+                        LoadShaderToy();
+                    });
+            }
+
+            ImGui::EndDisabled();
+
+            // Accumulating shaders converge K times faster, at K graph executions per presented frame.
+            ImGui::SliderInt("Iterations Per Frame", &mIterationsPerFrame, 1, kMaxIterationsPerFrame);
+            ImGui::Text("iFrame: %d", elapsedFrames);
+
+            if (ImGui::TreeNode("Dynamic Resolution"))
+            {
+                if (ImGui::Checkbox("Enabled", &mDynamicResolution))
+                    mResolutionScaleController.Reset(1.0);
+
+                auto resolutionScaleParams = mResolutionScaleController.GetParams();
+
+                const double frameTimeRange[2] = { 1.0, 100.0 };
+                const double gainRange[2]      = { 0.0, 2.0 };
+                const double scaleRange[2]     = { 0.1, 1.0 };
+
+                bool paramsChanged = false;
+
+                paramsChanged |= ImGui::SliderScalar("Target Frame Time (ms)",
+                                                     ImGuiDataType_Double,
+                                                     &resolutionScaleParams.targetFrameTime,
+                                                     &frameTimeRange[0],
+                                                     &frameTimeRange[1],
+                                                     "%.2f");
+                paramsChanged |= ImGui::SliderScalar("Proportional Gain",
+                                                     ImGuiDataType_Double,
+                                                     &resolutionScaleParams.proportionalGain,
+                                                     &gainRange[0],
+                                                     &gainRange[1],
+                                                     "%.3f");
+                paramsChanged |= ImGui::SliderScalar("Integral Gain (1/s)",
+                                                     ImGuiDataType_Double,
+                                                     &resolutionScaleParams.integralGain,
+                                                     &gainRange[0],
+                                                     &gainRange[1],
+                                                     "%.3f");
+                paramsChanged |= ImGui::SliderScalar("Minimum Scale",
+                                                     ImGuiDataType_Double,
+                                                     &resolutionScaleParams.minScale,
+                                                     &scaleRange[0],
+                                                     &scaleRange[1],
+                                                     "%.2f");
+
+                if (paramsChanged)
+                    mResolutionScaleController.SetParams(resolutionScaleParams);
+
+                if (mAsyncCompileStatus.load() == AsyncCompileShaderToyStatus::Compiled)
+                {
+                    ImGui::Text("Scale: %.2f (%dx%d of %dx%d, capacity %dx%d)",
+                                mDynamicResolution ? mResolutionScaleController.GetScale() : 1.0,
+                                mRenderGraph->renderResolution.x,
+                                mRenderGraph->renderResolution.y,
+                                mRenderGraph->resolution.x,
+                                mRenderGraph->resolution.y,
+                                mRenderGraph->capacity.x,
+                                mRenderGraph->capacity.y);
+                }
+
+                ImGui::TreePop();
+            }
+
+            if (ImGui::TreeNode("Render Graph Cache"))
+            {
+                if (ImGui::SliderInt("VRAM Budget (MB)", &mRenderGraphCacheBudgetDeviceMB, 0, 8192))
+                    TrimRenderGraphCache();
+
+                if (ImGui::SliderInt("RAM Budget (MB)", &mRenderGraphCacheBudgetHostMB, 0, 1024))
+                    TrimRenderGraphCache();
+
+                // Peak of all tracked memory while the shader was loaded, not just its graph.
+                auto memoryScopePeaks = gResourceRegistry->GetMemoryScopePeaks();
+
+                for (const auto& renderGraph : mRenderGraphCache)
+                {
+                    ImGui::Text("%s (%dx%d): %.1f MB VRAM, %.1f MB RAM, peak %.1f MB",
+                                renderGraph->shaderID.c_str(),
+                                renderGraph->resolution.x,
+                                renderGraph->resolution.y,
+                                renderGraph->GetDeviceMemorySize() / (1024.0f * 1024.0f),
+                                renderGraph->GetHostMemorySize() / (1024.0f * 1024.0f),
+                                memoryScopePeaks[renderGraph->shaderID] / (1024.0f * 1024.0f));
+                }
+
+                if (ImGui::Button("Clear", ImVec2(ImGui::GetContentRegionAvail().x, 0)))
+                    gPreRenderTaskQueue.push([&]() { mRenderGraphCache.clear(); });
+
+                ImGui::TreePop();
+            }
+
+            auto* pRenderGraph = mRenderGraph.get();
+
+            // Changes that re-allocate the targets are only safe between frames, and on the graph they were made for.
+            auto IsActiveRenderGraph = [this, pRenderGraph]()
+            {
+                return mAsyncCompileStatus.load() == AsyncCompileShaderToyStatus::Compiled && mRenderGraph.get() == pRenderGraph && !mTiledRender;
+            };
+
+            if (mAsyncCompileStatus.load() == AsyncCompileShaderToyStatus::Compiled && ImGui::TreeNode("Render Targets"))
+            {
+                auto deviceMemorySize         = mRenderGraph->GetDeviceMemorySize();
+                auto doubleBufferedMemorySize = mRenderGraph->GetDoubleBufferedMemorySize();
+
+                ImGui::Text("Total: %.1f MB (%.1f MB if double-buffered, %.1f MB saved)",
+                            deviceMemorySize / (1024.0f * 1024.0f),
+                            doubleBufferedMemorySize / (1024.0f * 1024.0f),
+                            (doubleBufferedMemorySize - deviceMemorySize) / (1024.0f * 1024.0f));
+
+                ImGui::Text("Capacity: %dx%d (rendering %dx%d)",
+                            mRenderGraph->capacity.x,
+                            mRenderGraph->capacity.y,
+                            mRenderGraph->resolution.x,
+                            mRenderGraph->resolution.y);
+
+                for (const auto& outputAllocation : mRenderGraph->outputAllocations)
+                {
+                    auto outputFormatName = magic_enum::enum_name(outputAllocation.pRenderPass->GetOutputFormat());
+
+                    if (outputAllocation.history)
+                    {
+                        ImGui::Text("%s: history, 2 x %.1f MB (%.*s)",
+                                    outputAllocation.pRenderPass->GetName().c_str(),
+                                    outputAllocation.size / (1024.0f * 1024.0f),
+                                    static_cast<int>(outputFormatName.size()),
+                                    outputFormatName.data());
+                    }
+                    else if (outputAllocation.persistent)
+                    {
+                        ImGui::Text("%s: persistent, %.1f MB (decimated, %.*s)",
+                                    outputAllocation.pRenderPass->GetName().c_str(),
+                                    outputAllocation.size / (1024.0f * 1024.0f),
+                                    static_cast<int>(outputFormatName.size()),
+                                    outputFormatName.data());
+                    }
+                    else
+                    {
+                        ImGui::Text("%s: transient, %.1f MB at heap offset %.1f MB (levels %zu-%zu, %.*s)",
+                                    outputAllocation.pRenderPass->GetName().c_str(),
+                                    outputAllocation.size / (1024.0f * 1024.0f),
+                                    outputAllocation.heapOffsets[0] / (1024.0f * 1024.0f),
+                                    outputAllocation.firstLevel,
+                                    outputAllocation.lastLevel,
+                                    static_cast<int>(outputFormatName.size()),
+                                    outputFormatName.data());
+                    }
+                }
+
+                // Passes left out by dead-pass culling, they take neither time nor memory.
+                for (const auto* pRenderPass : mRenderGraph->culledRenderPasses)
+                    ImGui::TextDisabled("%s: culled (output never reaches the image)", pRenderPass->GetName().c_str());
+
+                // Output precision of the buffer passes.
+                // ---------------------------------
+
+                const auto& culledRenderPasses = mRenderGraph->culledRenderPasses;
+
+                for (const auto& renderPass : mRenderGraph->renderPasses)
+                {
+                    if (!renderPass->IsIntermediate() ||
+                        std::find(culledRenderPasses.begin(), culledRenderPasses.end(), renderPass.get()) != culledRenderPasses.end())
+                        continue;
+
+                    auto outputPrecision = static_cast<int>(renderPass->GetOutputPrecision());
+
+                    auto comboLabel = std::format("{} Precision", renderPass->GetName());
+
+                    if (ImGui::Combo(comboLabel.c_str(), &outputPrecision, "Auto\0RGBA32F\0RGBA16F\0R11G11B10F\0"))
+                    {
+                        gPreRenderTaskQueue.push(
+                            [this, IsActiveRenderGraph, pRenderPass = renderPass.get(), outputPrecision]()
+                            {
+                                if (!IsActiveRenderGraph())
+                                    return;
+
+                                pRenderPass->SetOutputPrecision(static_cast<RenderPass::OutputPrecision>(outputPrecision));
+
+                                mRenderGraph->AllocateOutputTargets();
+
+                                gInternalFrameIndex = 0;
+                            });
+                    }
+                }
+
+                ImGui::SliderFloat("Precision Threshold (dB PSNR)", &mOutputPrecisionThresholdPSNR, 20.0f, 80.0f);
+
+                if (ImGui::Button("Verify Auto Precision", ImVec2(ImGui::GetContentRegionAvail().x, 0)))
+                {
+                    gPreRenderTaskQueue.push(
+                        [this, IsActiveRenderGraph]()
+                        {
+                            if (IsActiveRenderGraph())
+                                VerifyOutputPrecision();
+                        });
+                }
+
+#ifdef _DEBUG
+                if (ImGui::Button("Benchmark Resize", ImVec2(ImGui::GetContentRegionAvail().x, 0)))
+                {
+                    gPreRenderTaskQueue.push(
+                        [this, IsActiveRenderGraph]()
+                        {
+                            if (!IsActiveRenderGraph())
+                                return;
+
+                            BenchmarkResize(*mRenderGraph);
+
+                            gInternalFrameIndex = 0;
+                        });
+                }
+#endif
+
+                ImGui::TreePop();
+            }
+
+            if (mAsyncCompileStatus.load() == AsyncCompileShaderToyStatus::Compiled && ImGui::TreeNode("Update Rates"))
+            {
+                // Buffer passes that run, the image pass renders every frame.
+                for (const auto& level : mRenderGraph->levels)
+                {
+                    for (auto* pRenderPass : level)
+                    {
+                        if (!pRenderPass->IsIntermediate())
+                            continue;
+
+                        ImGui::PushID(pRenderPass);
+
+                        auto updateRate = static_cast<int>(pRenderPass->GetUpdateRate());
+
+                        if (ImGui::Combo(pRenderPass->GetName().c_str(), &updateRate, "Every Frame\0Every Nth Frame\0On Demand\0"))
+                        {
+                            gPreRenderTaskQueue.push(
+                                [this, IsActiveRenderGraph, pRenderPass, updateRate]()
+                                {
+                                    if (!IsActiveRenderGraph())
+                                        return;
+
+                                    const bool decimated = pRenderPass->IsDecimated();
+
+                                    pRenderPass->SetUpdateRate(static_cast<RenderPass::UpdateRate>(updateRate), pRenderPass->GetUpdateInterval());
+
+                                    // Decimated outputs are backed differently.
+                                    if (pRenderPass->IsDecimated() != decimated)
+                                    {
+                                        mRenderGraph->AllocateOutputTargets();
+
+                                        gInternalFrameIndex = 0;
+                                    }
+                                });
+                        }
+
+                        if (pRenderPass->GetUpdateRate() == RenderPass::UpdateRate::EveryNthFrame)
+                        {
+                            auto updateInterval = pRenderPass->GetUpdateInterval();
+
+                            if (ImGui::SliderInt("Interval (Frames)", &updateInterval, 2, 240))
+                                pRenderPass->SetUpdateRate(RenderPass::UpdateRate::EveryNthFrame, updateInterval);
+                        }
+
+                        if (pRenderPass->GetUpdateRate() == RenderPass::UpdateRate::OnDemand)
+                        {
+                            if (ImGui::Button("Update", ImVec2(ImGui::GetContentRegionAvail().x, 0)))
+                                pRenderPass->RequestUpdate();
+                        }
+
+                        if (pRenderPass->IsDecimated())
+                        {
+                            ImGui::Text("Updates: %d (last %.1f ms apart)",
+                                        pRenderPass->GetUpdateCount(),
+                                        1000.0f * pRenderPass->GetUpdateDeltaTime());
+                        }
+
+                        ImGui::PopID();
+                    }
+                }
+
+                ImGui::TreePop();
+            }
+
+            if (mAsyncCompileStatus.load() == AsyncCompileShaderToyStatus::Compiled && ImGui::TreeNode("Tiled Render"))
+            {
+                ImGui::BeginDisabled(mTiledRender != nullptr);
+
+                ImGui::InputInt2("Resolution", mTiledRenderResolution);
+                ImGui::SliderInt("Frames Per Tile", &mTiledRenderFrameCount, 1, kMaxIterationsPerFrame);
+                ImGui::SliderFloat("Target Tile Cost (ms)", &mTiledRenderTargetTileMs, 5.0f, 500.0f);
+
+                // Passes sampling neighbors would read tiles that were not rendered yet (only with full-size targets, which
+                // multi-pass graphs need).
+                if (mRenderGraph->renderPasses.size() - mRenderGraph->culledRenderPasses.size() > 1)
+                    ImGui::Checkbox("Passes Only Sample Their Own Pixels", &mTiledRenderConfirmMultiPass);
+
+                if (ImGui::Button("Render", ImVec2(ImGui::GetContentRegionAvail().x, 0)))
+                {
+                    gPreRenderTaskQueue.push(
+                        [&]()
+                        {
+                            if (mAsyncCompileStatus.load() == AsyncCompileShaderToyStatus::Compiled && !mTiledRender)
+                                StartTiledRender();
+                        });
+                }
+
+                ImGui::EndDisabled();
+
+                ImGui::TreePop();
+            }
+
+            if (mAsyncCompileStatus.load() == AsyncCompileShaderToyStatus::Compiled && !mRenderGraph->videoChannels.empty() &&
+                ImGui::TreeNode("Video Channels"))
+            {
+                for (const auto& videoChannel : mRenderGraph->videoChannels)
+                {
+                    auto videoStats = videoChannel.stream->GetStats();
+
+                    ImGui::Text("iChannel%d: %.2fs (%llu presented, %llu dropped, %llu late)",
+                                videoChannel.channel,
+                                videoChannel.stream->GetChannelTime(),
+                                videoStats.presentedFrames,
+                                videoStats.droppedFrames,
+                                videoStats.lateFrames);
+                }
+
+                ImGui::TreePop();
+            }
+
+            if (ImGui::TreeNode("Media Cache"))
+            {
+                if (ImGui::SliderInt("Budget (MB)", &gMediaCache->mBudgetMB, 0, 4096))
+                    gPreRenderTaskQueue.push([]() { gMediaCache->Trim(); });
+
+                auto mediaCacheStats = gMediaCache->GetStats();
+
+                auto lookupCount = mediaCacheStats.hits + mediaCacheStats.misses;
+
+                ImGui::Text("Entries: %u (%u referenced)", mediaCacheStats.entryCount, mediaCacheStats.referencedEntryCount);
+                ImGui::Text("Memory: %.1f MB", mediaCacheStats.memorySize / (1024.0f * 1024.0f));
+                ImGui::Text("Hits: %llu, Misses: %llu (%.1f%% hit rate)",
+                            mediaCacheStats.hits,
+                            mediaCacheStats.misses,
+                            lookupCount > 0u ? 100.0f * mediaCacheStats.hits / lookupCount : 0.0f);
+                ImGui::Text("Evictions: %llu", mediaCacheStats.evictions);
+
+                if (ImGui::Button("Clear Unreferenced", ImVec2(ImGui::GetContentRegionAvail().x, 0)))
+                    gPreRenderTaskQueue.push([]() { gMediaCache->Clear(); });
+
+#ifdef _DEBUG
+                // Microbenchmark for the HDR ingestion path (a 4K RGBA image worth of floats).
+                if (ImGui::Button("Benchmark Half Conversion", ImVec2(ImGui::GetContentRegionAvail().x, 0)))
+                    BenchmarkFloatToHalf(3840u * 2160u * 4u);
+#endif
+
+                ImGui::TreePop();
+            }
+
+#ifdef _DEBUG
+            if (!mShaderAPIRequestResult.empty())
+            {
+                if (ImGui::Button("Log API Request Result", ImVec2(ImGui::GetContentRegionAvail().x, 0)))
+                    spdlog::info(mShaderAPIRequestResult.dump(4));
+            }
+#endif
+
+            do
+            {
+                if (mAsyncCompileStatus.load() != AsyncCompileShaderToyStatus::Compiled)
+                    break;
+
+                if (ImGui::Button("Write HLSL to Disk", ImVec2(ImGui::GetContentRegionAvail().x, 0)))
+                {
+                    for (const auto& renderPass : mRenderGraph->renderPasses)
+                    {
+                        if (renderPass->GetSPIRV().empty())
+                            continue;
+
+                        spirv_cross::CompilerHLSL compiler(renderPass->GetSPIRV());
+
+                        spirv_cross::CompilerHLSL::Options compileOptions;
+                        {
+                            // Request SM 6.0 compliant.
+                            compileOptions.shader_model = 60;
+                        }
+                        compiler.set_hlsl_options(compileOptions);
+
+                        // Decompile the render pass SPIR-V to HLSL.
+                        auto hlsl = compiler.compile();
+
+                        // Write the HLSL code to a file.
+                        std::ofstream file(std::format("{}-renderpass-{}.hlsl", mShaderID.substr(0, 6), renderPass->GetOutputID()));
+
+                        if (!file.is_open())
+                            break;
+
+                        file << hlsl;
+                        file.close();
+                    }
+                }
+            }
+            while (false);
+        }
+
+        ImGui::EndChild();
+    }
+
+    std::vector<ResourceBarrier> RenderInputShaderToy::RecordRenderGraph(std::vector<ID3D12CommandList*>&                 graphCommandLists,
+                                                                         D3D12_GPU_VIRTUAL_ADDRESS                        constantsAddress,
+                                                                         const std::vector<ConstantAllocator::Allocation>& renderPassConstants,
+                                                                         const D3D12_RECT&                                scissor,
+                                                                         bool                                             updateVideo,
+                                                                         bool                                             recordExitBarriers,
+                                                                         bool                                             decimate)
+    {
+        const auto frameIndex      = GetCurrentFrameIndex();
+        const auto finalPassOutput = mRenderGraph->pFinalRenderPass->GetOutputResources()[frameIndex];
+
+        auto IsSkipped = [&](const RenderPass* pRenderPass) { return decimate && pRenderPass->IsSkipped(); };
+
+        // Plan this frame's barriers, freshly created targets are cleared in a leading level of their own.
+        const auto* pFrameAccesses = &mRenderGraph->levelAccesses[frameIndex];
+
+        // Skipped passes neither read nor write anything.
+        RenderGraph::LevelAccesses decimatedFrameAccesses;
+
+        // Stale current slots of skipped passes are copied from the other one ahead of the levels. The copies transition out of
+        // and back into the tracked states, captured before planning moves them to where this frame leaves them.
+        struct OutputSync
+        {
+            ID3D12Resource*       pSource;
+            ID3D12Resource*       pDestination;
+            D3D12_RESOURCE_STATES sourceState;
+            D3D12_RESOURCE_STATES destinationState;
+        };
+
+        std::vector<OutputSync> outputSyncs;
+
+        for (size_t levelIndex = 0; levelIndex < mRenderGraph->levels.size(); levelIndex++)
+        {
+            const auto& level = mRenderGraph->levels[levelIndex];
+
+            for (size_t passIndex = 0; passIndex < level.size(); passIndex++)
+            {
+                auto* pRenderPass = level[passIndex];
+
+                if (!IsSkipped(pRenderPass))
+                    continue;
+
+                if (decimatedFrameAccesses.empty())
+                {
+                    decimatedFrameAccesses = *pFrameAccesses;
+                    pFrameAccesses         = &decimatedFrameAccesses;
+                }
+
+                decimatedFrameAccesses[levelIndex][passIndex] = {};
+
+                const auto outputTargets = pRenderPass->GetOutputResources();
+
+                // Single targets just keep their contents.
+                if (!pRenderPass->IsOutputStale() || outputTargets[0].indexResource == outputTargets[1].indexResource)
+                    continue;
+
+                const auto& sourceTarget      = outputTargets[(frameIndex + 1) % 2];
+                const auto& destinationTarget = outputTargets[frameIndex];
+
+                outputSyncs.push_back({ gResourceRegistry->Get(sourceTarget),
+                                        gResourceRegistry->Get(destinationTarget),
+                                        GetD3D12ResourceState(mRenderGraph->barrierCompiler.GetState(sourceTarget.indexResource)),
+                                        GetD3D12ResourceState(mRenderGraph->barrierCompiler.GetState(destinationTarget.indexResource)) });
+            }
+        }
+
+        RenderGraph::LevelAccesses clearFrameAccesses;
+
+        if (!mRenderGraph->pendingClears.empty())
+        {
+            auto& clearAccess = clearFrameAccesses.emplace_back().emplace_back();
+
+            for (const auto& outputTarget : mRenderGraph->pendingClears)
+                clearAccess.writes.push_back(outputTarget.indexResource);
+
+            clearFrameAccesses.insert(clearFrameAccesses.end(), pFrameAccesses->begin(), pFrameAccesses->end());
+
+            pFrameAccesses = &clearFrameAccesses;
+        }
+
+        auto barrierPlan = mRenderGraph->barrierCompiler.Compile(*pFrameAccesses, { finalPassOutput.indexResource });
+
+        const size_t levelOffset = pFrameAccesses->size() - mRenderGraph->levels.size();
+
+        if ((updateVideo && !mRenderGraph->videoChannels.empty()) || !mRenderGraph->pendingClears.empty() || !outputSyncs.empty())
+        {
+            auto* pPrologueCmd = mCommandListPool->Acquire();
+
+            if (!outputSyncs.empty())
+            {
+                std::vector<D3D12_RESOURCE_BARRIER> toCopyBarriers;
+                std::vector<D3D12_RESOURCE_BARRIER> fromCopyBarriers;
+
+                for (const auto& outputSync : outputSyncs)
+                {
+                    toCopyBarriers.push_back(
+                        CD3DX12_RESOURCE_BARRIER::Transition(outputSync.pSource, outputSync.sourceState, D3D12_RESOURCE_STATE_COPY_SOURCE));
+                    toCopyBarriers.push_back(
+                        CD3DX12_RESOURCE_BARRIER::Transition(outputSync.pDestination, outputSync.destinationState, D3D12_RESOURCE_STATE_COPY_DEST));
+
+                    fromCopyBarriers.push_back(
+                        CD3DX12_RESOURCE_BARRIER::Transition(outputSync.pSource, D3D12_RESOURCE_STATE_COPY_SOURCE, outputSync.sourceState));
+                    fromCopyBarriers.push_back(
+                        CD3DX12_RESOURCE_BARRIER::Transition(outputSync.pDestination, D3D12_RESOURCE_STATE_COPY_DEST, outputSync.destinationState));
+                }
+
+                pPrologueCmd->ResourceBarrier(static_cast<UINT>(toCopyBarriers.size()), toCopyBarriers.data());
+
+                for (const auto& outputSync : outputSyncs)
+                    pPrologueCmd->CopyResource(outputSync.pDestination, outputSync.pSource);
+
+                pPrologueCmd->ResourceBarrier(static_cast<UINT>(fromCopyBarriers.size()), fromCopyBarriers.data());
+            }
+
+            // Pick up any decoded video frames (records their uploads ahead of the passes).
+            if (updateVideo)
+            {
+                for (auto& videoChannel : mRenderGraph->videoChannels)
+                    videoChannel.stream->Update(elapsedSeconds, pPrologueCmd);
+            }
+
+            if (!mRenderGraph->pendingClears.empty())
+            {
+                RecordResourceBarriers(pPrologueCmd, barrierPlan.levelBarriers[0]);
+
+                auto* pRenderTargetHeap = gResourceRegistry->GetDescriptorHeap(DescriptorHeap::Type::RenderTarget);
+
+                const float clearColor[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+                for (const auto& outputTarget : mRenderGraph->pendingClears)
+                {
+                    auto outputDescriptorHandle = pRenderTargetHeap->GetAddressCPU(outputTarget.indexDescriptorRenderTarget);
+
+                    pPrologueCmd->ClearRenderTargetView(outputDescriptorHandle, clearColor, 0, nullptr);
+                }
+
+                mRenderGraph->pendingClears.clear();
+            }
+
+            ThrowIfFailed(pPrologueCmd->Close());
+
+            graphCommandLists.push_back(pPrologueCmd);
+        }
+
+        // Covers the rendered part of the graph's targets, the scissor limits the pixels that are rendered.
+        D3D12_VIEWPORT viewport = gViewport;
+        {
+            viewport.TopLeftX = 0.0f;
+            viewport.TopLeftY = 0.0f;
+            viewport.Width    = static_cast<float>(mRenderGraph->renderResolution.x);
+            viewport.Height   = static_cast<float>(mRenderGraph->renderResolution.y);
+        }
+
+        // Record each level into its own command list in parallel, the passes of a level are independent.
+        RenderGraphLevelRecorder levelRecorder(*mRenderGraph,
+                                               mRootSignature.Get(),
+                                               viewport,
+                                               scissor,
+                                               constantsAddress,
+                                               renderPassConstants,
+                                               decimate);
+
+        auto levelCommandLists = RecordLevels(mCommandListPool->GetCache(),
+                                              levelRecorder,
+                                              barrierPlan,
+                                              levelOffset,
+                                              mRenderGraph->levels.size(),
+                                              recordExitBarriers,
+                                              gFence->GetCompletedValue());
+
+        for (auto* pLevelCommandList : levelCommandLists)
+            graphCommandLists.push_back(pLevelCommandList->commandList.Get());
+
+        return barrierPlan.exitBarriers;
+    }
+
+    std::vector<uint8_t> RenderInputShaderToy::RenderPrecisionTestWindow()
+    {
+        // Fresh targets in the current formats, history starts out cleared like on a shader load.
+        mRenderGraph->AllocateOutputTargets();
+
+        gInternalFrameIndex = 0;
+
+        const auto& resolution = mRenderGraph->resolution;
+
+        D3D12_RECT scissor = {};
+        {
+            scissor.right  = static_cast<LONG>(gBackBufferSize.x);
+            scissor.bottom = static_cast<LONG>(gBackBufferSize.y);
+        }
+
+        // Read back the final output of the last frame.
+        auto finalPassOutputInfo = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R8G8B8A8_UNORM,
+                                                                static_cast<UINT>(resolution.x),
+                                                                static_cast<UINT>(resolution.y),
+                                                                1,
+                                                                1);
+
+        D3D12_PLACED_SUBRESOURCE_FOOTPRINT readbackFootprint = {};
+        uint64_t                           readbackSize      = 0u;
+        gLogicalDevice->GetCopyableFootprints(&finalPassOutputInfo, 0, 1, 0, &readbackFootprint, nullptr, nullptr, &readbackSize);
+
+        auto readbackBuffer = gResourceRegistry->CreateReadback(readbackSize);
+
+        for (int frame = 0; frame < kPrecisionTestFrameCount; frame++)
+        {
+            const bool lastFrame = frame == kPrecisionTestFrameCount - 1;
+
+            std::vector<ID3D12CommandList*> graphCommandLists;
+
+            // Video channels hold their current frame, so that every run sees the same inputs. The final output is left
+            // readable, as the blit would, the last frame does that itself ahead of the copy.
+            auto frameConstants = gConstantAllocator->Allocate(sizeof(Constants));
+
+            auto exitBarriers = RecordRenderGraph(graphCommandLists, frameConstants.gpuAddress, {}, scissor, false, !lastFrame, false);
+
+            // Fixed 60 Hz timeline without mouse input.
+            Constants constants = {};
+            {
+                constants.iAppParams0.x = mRenderGraph->GetRenderScale().x;
+                constants.iAppParams0.y = mRenderGraph->GetRenderScale().y;
+                constants.iResolution.x = static_cast<float>(resolution.x);
+                constants.iResolution.y = static_cast<float>(resolution.y);
+                constants.iTime         = frame / 60.0f;
+                constants.iFrame        = frame;
+                constants.iTimeDelta    = 1.0f / 60.0f;
+                constants.iFrameRate    = 60.0f;
+
+                SetVideoChannelConstants(constants, mRenderGraph->videoChannels);
+            }
+            memcpy(frameConstants.pData, &constants, sizeof(Constants));
+
+            if (lastFrame)
+            {
+                auto* pReadbackCmd = mCommandListPool->Acquire();
+
+                RecordResourceBarriers(pReadbackCmd, exitBarriers);
+
+                auto* pFinalPassOutput = gResourceRegistry->Get(mRenderGraph->pFinalRenderPass->GetOutputResources()[GetCurrentFrameIndex()]);
+
+                auto toCopyBarrier = CD3DX12_RESOURCE_BARRIER::Transition(pFinalPassOutput,
+                                                                          D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+                                                                          D3D12_RESOURCE_STATE_COPY_SOURCE);
+                pReadbackCmd->ResourceBarrier(1, &toCopyBarrier);
+
+                CD3DX12_TEXTURE_COPY_LOCATION copyDst(gResourceRegistry->Get(readbackBuffer), readbackFootprint);
+                CD3DX12_TEXTURE_COPY_LOCATION copySrc(pFinalPassOutput, 0);
+
+                // The target may be larger than the resolution (capacity).
+                CD3DX12_BOX copyBox(0, 0, resolution.x, resolution.y);
+
+                pReadbackCmd->CopyTextureRegion(&copyDst, 0, 0, 0, &copySrc, &copyBox);
+
+                // Back to where the barrier compiler expects it.
+                auto fromCopyBarrier = CD3DX12_RESOURCE_BARRIER::Transition(pFinalPassOutput,
+                                                                            D3D12_RESOURCE_STATE_COPY_SOURCE,
+                                                                            D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+                pReadbackCmd->ResourceBarrier(1, &fromCopyBarrier);
+
+                ThrowIfFailed(pReadbackCmd->Close());
+
+                graphCommandLists.push_back(pReadbackCmd);
+            }
+
+            gCommandQueue->ExecuteCommandLists(static_cast<UINT>(graphCommandLists.size()), graphCommandLists.data());
+
+            mCommandListPool->Retire(gFenceValue);
+
+            // Recycles the command lists.
+            WaitForDevice();
+
+            gInternalFrameIndex++;
+        }
+
+        // Tightly pack the rows.
+        std::vector<uint8_t> image(static_cast<size_t>(resolution.x) * resolution.y * 4u);
+
+        void* pMappedData = nullptr;
+        ThrowIfFailed(gResourceRegistry->Get(readbackBuffer)->Map(0, nullptr, &pMappedData));
+
+        for (int row = 0; row < resolution.y; row++)
+        {
+            memcpy(image.data() + static_cast<size_t>(row) * resolution.x * 4u,
+                   static_cast<uint8_t*>(pMappedData) + readbackFootprint.Offset + static_cast<size_t>(row) * readbackFootprint.Footprint.RowPitch,
+                   static_cast<size_t>(resolution.x) * 4u);
+        }
+
+        D3D12_RANGE writtenRange = { 0, 0 };
+        gResourceRegistry->Get(readbackBuffer)->Unmap(0, &writtenRange);
 
-            // Insert the render pass into the render graph.
-            renderPassTaskMap[renderPass->GetOutputID()] = mRenderGraph.emplace([this, renderPass]() { renderPass->Dispatch(mpActiveCommandList); });
-        }
+        gResourceRegistry->Release(readbackBuffer);
 
-        // Parse all non-buffer inputs.
-        // ---------------------------------
+        return image;
+    }
 
-        std::vector<nlohmann::json> mediaInputs;
+    void RenderInputShaderToy::VerifyOutputPrecision()
+    {
+        const auto& renderPasses = mRenderGraph->renderPasses;
 
-        for (const auto& renderPass : parsedShaderToy["Shader"]["renderpass"])
+        // Buffer passes left on auto start out at full precision. Passes whose output is fed back across frames (simulations,
+        // accumulation) compound their rounding error every frame, so they are excluded and stay at full precision.
+        std::vector<RenderPass*> candidateRenderPasses;
+
+        for (const auto& level : mRenderGraph->schedule->GetLevels())
         {
-            for (const auto& input : renderPass["inputs"])
+            for (auto renderPassIndex : level)
             {
-                auto inputType = input["ctype"].get<std::string>();
+                auto* pRenderPass = renderPasses[renderPassIndex].get();
 
-                // Check if any unsupported input is detected.
-                if (std::find(std::begin(kUnsupportedInputs), std::end(kUnsupportedInputs), inputType) != std::end(kUnsupportedInputs))
+                if (!pRenderPass->IsIntermediate() || pRenderPass->GetOutputPrecision() != RenderPass::OutputPrecision::Auto)
+                    continue;
+
+                pRenderPass->SetAutoOutputFormat(DXGI_FORMAT_R32G32B32A32_FLOAT);
+
+                if (mRenderGraph->schedule->GetLifetimes()[renderPassIndex].history)
                 {
-                    spdlog::info("Shader requires unsupported input: {}", inputType);
-                    return false;
+                    spdlog::info("Output precision of {}: Fed back across frames, kept at RGBA32F.", pRenderPass->GetName());
+                    continue;
                 }
 
-                if (inputType == "texture" || inputType == "cubemap")
-                    mediaInputs.push_back(input);
+                candidateRenderPasses.push_back(pRenderPass);
             }
         }
 
-        // Obtain any media from server.
-        // ---------------------------------
-
-        std::unordered_set<int> processedInputs;
-
-        for (const auto& mediaInput : mediaInputs)
+        if (!candidateRenderPasses.empty())
         {
-            int mediaInputId = mediaInput["id"].get<int>();
+            auto referenceImage = RenderPrecisionTestWindow();
 
-            if (processedInputs.contains(mediaInputId))
-                continue;
+            // Greedy in schedule order, each candidate is verified together with the formats accepted before it, so that the
+            // errors of all reduced passes are measured combined.
+            for (auto* pRenderPass : candidateRenderPasses)
+            {
+                bool accepted = false;
 
-            processedInputs.insert(mediaInputId);
+                // Cheapest first.
+                for (auto outputFormat : { DXGI_FORMAT_R11G11B10_FLOAT, DXGI_FORMAT_R16G16B16A16_FLOAT })
+                {
+                    pRenderPass->SetAutoOutputFormat(outputFormat);
 
-            // Pull image bytes from the API.
-            // ------------------------------
+                    auto psnr = ComputePSNR(RenderPrecisionTestWindow(), referenceImage);
 
-            auto data = QueryURL<std::vector<uint8_t>>("https://www.shadertoy.com" + mediaInput["src"].get<std::string>());
+                    spdlog::info("Output precision of {}: {} at {:.1f} dB PSNR.", pRenderPass->GetName(), magic_enum::enum_name(outputFormat), psnr);
 
-            if (data.empty())
-                return false;
+                    if (psnr >= mOutputPrecisionThresholdPSNR)
+                    {
+                        accepted = true;
+                        break;
+                    }
+                }
 
-            // Load the image
-            // ------------------------------
+                if (!accepted)
+                    pRenderPass->SetAutoOutputFormat(DXGI_FORMAT_R32G32B32A32_FLOAT);
+            }
+        }
 
-            stbi_set_flip_vertically_on_load(true);
+        // Restart from cleared history in the chosen formats.
+        mRenderGraph->AllocateOutputTargets();
 
-            int  width, height, channels;
-            auto pImage = stbi_load_from_memory(data.data(), static_cast<int>(data.size()), &width, &height, &channels, STBI_rgb_alpha);
+        gInternalFrameIndex = 0;
+    }
 
-            if (!pImage)
-            {
-                spdlog::error("Failed to load image from bytes.");
-                return false;
-            }
+    bool RenderInputShaderToy::StartTiledRender()
+    {
+        const DirectX::XMINT2 resolution = { std::clamp(mTiledRenderResolution[0], 1, D3D12_REQ_TEXTURE2D_U_OR_V_DIMENSION),
+                                             std::clamp(mTiledRenderResolution[1], 1, D3D12_REQ_TEXTURE2D_U_OR_V_DIMENSION) };
 
-            ResourceHandle mediaResourceHandle =
-                gResourceRegistry->CreateWithData(CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R8G8B8A8_UNORM, width, height, 1, 1),
-                                                  0x0, // Manually managed descriptor heaps.
-                                                  pImage,
-                                                  width * height * 4);
+        // Passes sampling other outputs (or their own history) look them up in screen space, so their targets have to cover the
+        // whole image. Without any, in practice single-pass graphs, every tile renders into tile-sized targets instead.
+        bool samplesPassOutputs = false;
 
-            // Transfer the resource to the media resource cache.
-            mMediaResources.push_back(std::move(mediaResourceHandle));
+        for (size_t renderPassIndex = 0; renderPassIndex < mRenderGraph->renderPasses.size(); renderPassIndex++)
+        {
+            if (mRenderGraph->schedule->IsCulled(renderPassIndex))
+                continue;
 
-            // And specify it here.
-            mResourceCache[mediaInputId][0] = mMediaResources.back();
-            mResourceCache[mediaInputId][1] = mResourceCache[mediaInputId][0]; // No history for media.
+            for (int inputID : mRenderGraph->renderPasses[renderPassIndex]->GetInputIDs())
+            {
+                samplesPassOutputs |= std::any_of(mRenderGraph->renderPasses.begin(),
+                                                  mRenderGraph->renderPasses.end(),
+                                                  [&](const auto& renderPass) { return renderPass->GetOutputID() == inputID; });
+            }
         }
 
-        // Scan 3) Resolve all render pass dependencies.
-        for (const auto& renderPass : mRenderPasses)
+        if (samplesPassOutputs)
         {
-            // Now that all input resources are allocated, each render pass can build their srv heap.
-            renderPass->CreateInputResourceDescriptorTable(mResourceCache);
+            // Every tile renders the whole graph scissored to the tile, which only matches a full frame if no pass reads pixels
+            // of another tile. That cannot be derived from the GLSL, it is up to the user to confirm.
+            if (!mTiledRenderConfirmMultiPass)
+            {
+                spdlog::error("Tiled render of {} needs confirmation that its passes do not sample across tiles.", mRenderGraph->shaderID);
+                return false;
+            }
 
-            for (const auto& inputID : renderPass->GetInputIDs())
+            // Full-size float targets (double-buffered with history) quickly outgrow the device, refuse rather than fail to
+            // allocate them.
+            uint64_t targetSize = 0u;
+
+            for (size_t renderPassIndex = 0; renderPassIndex < mRenderGraph->renderPasses.size(); renderPassIndex++)
             {
-                // Skip inputs that are not provided from other render passes.
-                if (!renderPassTaskMap.contains(inputID))
+                if (mRenderGraph->schedule->IsCulled(renderPassIndex))
                     continue;
 
-                // Skip self-referential inputs.
-                if (inputID == renderPass->GetOutputID())
-                    continue;
+                auto targetInfo = CD3DX12_RESOURCE_DESC::Tex2D(mRenderGraph->renderPasses[renderPassIndex]->GetOutputFormat(),
+                                                               static_cast<UINT64>(resolution.x),
+                                                               static_cast<UINT>(resolution.y),
+                                                               1,
+                                                               1,
+                                                               1,
+                                                               0,
+                                                               D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
+
+                const uint64_t allocationSize = gLogicalDevice->GetResourceAllocationInfo(0, 1, &targetInfo).SizeInBytes;
+
+                targetSize += mRenderGraph->schedule->GetLifetimes()[renderPassIndex].history ? 2u * allocationSize : allocationSize;
+            }
+
+            const auto targetBudget = static_cast<uint64_t>(gResourceRegistry->GetMemoryStats().localBudgetBytes * kTiledRenderTargetBudget);
 
-                renderPassTaskMap[inputID].precede(renderPassTaskMap[renderPass->GetOutputID()]);
+            if (targetSize > targetBudget)
+            {
+                spdlog::error("Tiled render of {} at {}x{} needs {:.1f} MB of full-size targets, more than the budget of {:.1f} MB.",
+                              mRenderGraph->shaderID,
+                              resolution.x,
+                              resolution.y,
+                              targetSize / (1024.0 * 1024.0),
+                              targetBudget / (1024.0 * 1024.0));
+                return false;
             }
         }
 
-        return true;
-    }
+        auto tiledRender = std::make_unique<TiledRender>();
 
-    bool RenderInputShaderToy::CompileShaderToy(const std::string& shaderID)
-    {
-        // 1) Download the shader toy shader.
-        // -----------------------------------
+        tiledRender->resolution  = resolution;
+        tiledRender->tileTargets = !samplesPassOutputs;
 
-        auto data = QueryURL<std::string>("https://www.shadertoy.com/api/v1/shaders/" + shaderID.substr(0, 6) + "?key=BtrjRM");
+        // Single-frame references just use the first frame, accumulating shaders converge over several.
+        tiledRender->frameCount = std::clamp(mTiledRenderFrameCount, 1, kMaxIterationsPerFrame);
+        tiledRender->time       = elapsedSeconds;
+        tiledRender->start      = std::chrono::steady_clock::now();
 
-        // 2) Parse result into JSON.
-        // --------------------------
+        TileScheduler::Params tileSchedulerParams = {};
+        {
+            tileSchedulerParams.width           = static_cast<uint32_t>(tiledRender->resolution.x);
+            tileSchedulerParams.height          = static_cast<uint32_t>(tiledRender->resolution.y);
+            tileSchedulerParams.targetTileCost  = mTiledRenderTargetTileMs;
+            tileSchedulerParams.initialTileSize = 256u;
+            tileSchedulerParams.minTileSize     = kTiledRenderMinTileSize;
+            tileSchedulerParams.maxTileSize     = kTiledRenderMaxTileSize;
+        }
+        tiledRender->scheduler = std::make_unique<TileScheduler>(tileSchedulerParams);
 
-        nlohmann::json parsedData = nlohmann::json::parse(data);
+        // Sized for the largest tile, remainders merged into a tile can push it past the maximum by less than the minimum.
+        auto largestTileInfo = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R8G8B8A8_UNORM,
+                                                            kTiledRenderMaxTileSize + kTiledRenderMinTileSize,
+                                                            kTiledRenderMaxTileSize + kTiledRenderMinTileSize,
+                                                            1,
+                                                            1);
 
-#ifdef _DEBUG
-        // Keep the result in debug builds for optional viewing.
-        mShaderAPIRequestResult = parsedData;
-#endif
+        uint64_t readbackSize = 0u;
+        gLogicalDevice->GetCopyableFootprints(&largestTileInfo, 0, 1, 0, nullptr, nullptr, nullptr, &readbackSize);
 
-        // 3) Compile GLSL to SPIR-V.
-        // ---------------------------
+        tiledRender->readbackBuffer = gResourceRegistry->CreateReadback(readbackSize);
 
-        if (parsedData.contains("Error"))
+        tiledRender->image.resize(static_cast<size_t>(tiledRender->resolution.x) * tiledRender->resolution.y * 4u);
+
+        // The graph renders into targets the size of the largest tile or of the whole image until the tiles are done, without
+        // any headroom. The constants of the tiles carry the reference resolution.
+        mRenderGraph->resolution = tiledRender->resolution;
+
+        if (tiledRender->tileTargets)
         {
-            spdlog::info("Requested shader is not publically available via API.");
-            return false;
+            constexpr auto kMaxTileTargetSize = static_cast<int32_t>(kTiledRenderMaxTileSize + kTiledRenderMinTileSize);
+
+            mRenderGraph->resolution.x = std::min(mRenderGraph->resolution.x, kMaxTileTargetSize);
+            mRenderGraph->resolution.y = std::min(mRenderGraph->resolution.y, kMaxTileTargetSize);
         }
 
-        // Build task-graph.
-        if (!BuildRenderGraph(parsedData))
-            return false;
+        mRenderGraph->capacity = mRenderGraph->resolution;
+
+        mRenderGraph->AllocateOutputTargets();
+
+        spdlog::info("Started tiled render of {} at {}x{} ({} frames per tile, {} targets).",
+                     mRenderGraph->shaderID,
+                     tiledRender->resolution.x,
+                     tiledRender->resolution.y,
+                     tiledRender->frameCount,
+                     tiledRender->tileTargets ? "tile-sized" : "full-size");
+
+        mTiledRender = std::move(tiledRender);
 
         return true;
     }
 
-    void RenderInputShaderToy::ResizeViewportTargets(const DirectX::XMINT2& dim)
+    void RenderInputShaderToy::RenderTiles()
     {
-        // Re-set internal frame counter.
-        gInternalFrameIndex = 0;
+        auto& tiledRender = *mTiledRender;
 
-        for (auto& renderPass : mRenderPasses)
-        {
-            // 1) Resize the output resources.
-            renderPass->CreateOutputTargets();
+        auto* pReadbackBuffer = gResourceRegistry->Get(tiledRender.readbackBuffer);
 
-            // 2) Update the resource cache.
-            mResourceCache[renderPass->GetOutputID()][0] = renderPass->GetOutputResources()[0];
-            mResourceCache[renderPass->GetOutputID()][1] = renderPass->GetOutputResources()[1];
-        }
+        auto frameStart = std::chrono::steady_clock::now();
 
-        for (auto& renderPass : mRenderPasses)
-        {
-            // 3) Re-create the input resource descriptor table.
-            renderPass->CreateInputResourceDescriptorTable(mResourceCache);
-        }
-    }
+        Tile tile;
 
-    void RenderInputShaderToy::RenderInterface()
-    {
-        if (mAsyncCompileStatus.load() == AsyncCompileShaderToyStatus::Compiling)
+        // At least one tile per frame, more while the frame budget allows.
+        while (std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count() < kTiledRenderFrameBudgetMs)
         {
-            ImGui::SetNextWindowPos(ImVec2(gViewport.TopLeftX + (0.5f * gViewport.Width), gViewport.Height * 0.5f),
-                                    ImGuiCond_Always,
-                                    ImVec2(0.5f, 0.5f));
+            if (!tiledRender.scheduler->Next(tile))
+            {
+                FinishTiledRender(false);
+                return;
+            }
 
-            ImGui::Begin("##ShaderToyProgress", nullptr, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoTitleBar);
-            ImGui::ProgressBar(-1.0f * (float)ImGui::GetTime(), ImVec2(0, 0), "Loading");
-            ImGui::End();
-        }
+            // Tile-sized targets hold the tile at their origin, the shaders see it at its place in the image through the
+            // fragCoord offset. Full-size targets are scissored to the tile.
+            const uint32_t targetX = tiledRender.tileTargets ? 0u : tile.x;
+            const uint32_t targetY = tiledRender.tileTargets ? 0u : tile.y;
 
-        if (ImGui::BeginChild("##ShaderToy", ImVec2(0, 0), ImGuiChildFlags_AutoResizeY | ImGuiChildFlags_Borders))
-        {
-            ImGui::InputText("Shader ID", mShaderID.data(), mShaderID.size());
+            if (tiledRender.tileTargets)
+                mRenderGraph->renderResolution = { static_cast<int32_t>(tile.width), static_cast<int32_t>(tile.height) };
 
-            if (ImGui::Button("Load", ImVec2(ImGui::GetContentRegionAvail().x, 0)))
+            D3D12_RECT scissor = {};
             {
-                gPreRenderTaskQueue.push(
-                    [&]()
-                    {
-                        mUserRequestUnload = false;
-                        Release();
-                        Initialize();
-                    });
+                scissor.left   = static_cast<LONG>(targetX);
+                scissor.top    = static_cast<LONG>(targetY);
+                scissor.right  = static_cast<LONG>(targetX + tile.width);
+                scissor.bottom = static_cast<LONG>(targetY + tile.height);
             }
 
-            if (ImGui::Button("Unload", ImVec2(ImGui::GetContentRegionAvail().x, 0)))
+            // Every tile runs the frames from the start, history outside of it is never read.
+            gInternalFrameIndex = 0;
+
+            std::vector<ID3D12CommandList*> graphCommandLists;
+            std::vector<ResourceBarrier>    exitBarriers;
+
+            for (int frame = 0; frame < tiledRender.frameCount; frame++)
             {
-                gPreRenderTaskQueue.push(
-                    [&]()
+                const bool lastFrame = frame == tiledRender.frameCount - 1;
+
+                auto frameConstants = gConstantAllocator->Allocate(sizeof(Constants));
+
+                exitBarriers = RecordRenderGraph(graphCommandLists, frameConstants.gpuAddress, {}, scissor, false, !lastFrame, false);
+
+                Constants constants = {};
+                {
+                    constants.iResolution.x = static_cast<float>(tiledRender.resolution.x);
+                    constants.iResolution.y = static_cast<float>(tiledRender.resolution.y);
+                    constants.iTime         = tiledRender.time;
+                    constants.iFrame        = frame;
+                    constants.iTimeDelta    = 1.0f / 60.0f;
+                    constants.iFrameRate    = 60.0f;
+
+                    if (tiledRender.tileTargets)
                     {
-                        mUserRequestUnload = true;
-                        Release();
-                        Initialize();
-                    });
+                        constants.iAppParams0.z = static_cast<float>(tile.x);
+                        constants.iAppParams0.w = static_cast<float>(tile.y);
+                    }
+
+                    SetVideoChannelConstants(constants, mRenderGraph->videoChannels);
+                }
+                memcpy(frameConstants.pData, &constants, sizeof(Constants));
+
+                if (!lastFrame)
+                    gInternalFrameIndex++;
             }
 
-#ifdef _DEBUG
-            if (!mShaderAPIRequestResult.empty())
+            // Copy the tile out of the final output.
+            auto tileInfo = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R8G8B8A8_UNORM, tile.width, tile.height, 1, 1);
+
+            D3D12_PLACED_SUBRESOURCE_FOOTPRINT tileFootprint = {};
+            gLogicalDevice->GetCopyableFootprints(&tileInfo, 0, 1, 0, &tileFootprint, nullptr, nullptr, nullptr);
+
+            auto* pReadbackCmd = mCommandListPool->Acquire();
             {
-                if (ImGui::Button("Log API Request Result", ImVec2(ImGui::GetContentRegionAvail().x, 0)))
-                    spdlog::info(mShaderAPIRequestResult.dump(4));
+                RecordResourceBarriers(pReadbackCmd, exitBarriers);
+
+                auto* pFinalPassOutput = gResourceRegistry->Get(mRenderGraph->pFinalRenderPass->GetOutputResources()[GetCurrentFrameIndex()]);
+
+                auto toCopyBarrier = CD3DX12_RESOURCE_BARRIER::Transition(pFinalPassOutput,
+                                                                          D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+                                                                          D3D12_RESOURCE_STATE_COPY_SOURCE);
+                pReadbackCmd->ResourceBarrier(1, &toCopyBarrier);
+
+                CD3DX12_TEXTURE_COPY_LOCATION copyDst(pReadbackBuffer, tileFootprint);
+                CD3DX12_TEXTURE_COPY_LOCATION copySrc(pFinalPassOutput, 0);
+                CD3DX12_BOX                   copyBox(targetX, targetY, targetX + tile.width, targetY + tile.height);
+
+                pReadbackCmd->CopyTextureRegion(&copyDst, 0, 0, 0, &copySrc, &copyBox);
+
+                // Back to where the barrier compiler expects it.
+                auto fromCopyBarrier = CD3DX12_RESOURCE_BARRIER::Transition(pFinalPassOutput,
+                                                                            D3D12_RESOURCE_STATE_COPY_SOURCE,
+                                                                            D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+                pReadbackCmd->ResourceBarrier(1, &fromCopyBarrier);
             }
-#endif
+            ThrowIfFailed(pReadbackCmd->Close());
 
-            do
-            {
-                if (mAsyncCompileStatus.load() != AsyncCompileShaderToyStatus::Compiled)
-                    break;
+            graphCommandLists.push_back(pReadbackCmd);
 
-                if (ImGui::Button("Write HLSL to Disk", ImVec2(ImGui::GetContentRegionAvail().x, 0)))
-                {
-                    for (const auto& renderPass : mRenderPasses)
-                    {
-                        if (renderPass->GetSPIRV().empty())
-                            continue;
+            // Measured around the submission, the wait makes it (mostly) the GPU cost of the tile.
+            auto tileStart = std::chrono::steady_clock::now();
 
-                        spirv_cross::CompilerHLSL compiler(renderPass->GetSPIRV());
+            gCommandQueue->ExecuteCommandLists(static_cast<UINT>(graphCommandLists.size()), graphCommandLists.data());
 
-                        spirv_cross::CompilerHLSL::Options compileOptions;
-                        {
-                            // Request SM 6.0 compliant.
-                            compileOptions.shader_model = 60;
-                        }
-                        compiler.set_hlsl_options(compileOptions);
+            mCommandListPool->Retire(gFenceValue);
 
-                        // Decompile the render pass SPIR-V to HLSL.
-                        auto hlsl = compiler.compile();
+            WaitForDevice();
 
-                        // Write the HLSL code to a file.
-                        std::ofstream file(std::format("{}-renderpass-{}.hlsl", mShaderID.substr(0, 6), renderPass->GetOutputID()));
+            tiledRender.scheduler->Report(tile, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tileStart).count());
 
-                        if (!file.is_open())
-                            break;
+            // Stream the tile into the image.
+            void* pMappedData = nullptr;
+            ThrowIfFailed(pReadbackBuffer->Map(0, nullptr, &pMappedData));
 
-                        file << hlsl;
-                        file.close();
-                    }
-                }
+            for (uint32_t row = 0; row < tile.height; row++)
+            {
+                memcpy(tiledRender.image.data() + ((static_cast<size_t>(tile.y) + row) * tiledRender.resolution.x + tile.x) * 4u,
+                       static_cast<uint8_t*>(pMappedData) + tileFootprint.Offset + static_cast<size_t>(row) * tileFootprint.Footprint.RowPitch,
+                       static_cast<size_t>(tile.width) * 4u);
             }
-            while (false);
+
+            D3D12_RANGE writtenRange = { 0, 0 };
+            pReadbackBuffer->Unmap(0, &writtenRange);
+        }
+    }
+
+    void RenderInputShaderToy::FinishTiledRender(bool cancel)
+    {
+        auto tiledRender = std::move(mTiledRender);
+
+        if (!cancel)
+        {
+            auto imagePath = std::format("{}-{}x{}.png", mRenderGraph->shaderID, tiledRender->resolution.x, tiledRender->resolution.y);
+
+            // The image is in target row order, bottom row first as gl_FragCoord (and as the media is loaded).
+            stbi_flip_vertically_on_write(1);
+
+            const bool written = stbi_write_png(imagePath.c_str(),
+                                                tiledRender->resolution.x,
+                                                tiledRender->resolution.y,
+                                                4,
+                                                tiledRender->image.data(),
+                                                tiledRender->resolution.x * 4);
+
+            stbi_flip_vertically_on_write(0);
+
+            if (!written)
+                spdlog::error("Failed to write tiled render to {}.", imagePath);
+            else
+                spdlog::info("Tiled render written to {} ({} tiles in {:.1f} s).",
+                             imagePath,
+                             tiledRender->scheduler->GetTileCount(),
+                             std::chrono::duration<double>(std::chrono::steady_clock::now() - tiledRender->start).count());
         }
 
-        ImGui::EndChild();
+        // Nothing is in flight, Render() waits for each tile.
+        gResourceRegistry->Release(tiledRender->readbackBuffer);
+
+        // Back to the viewport.
+        mRenderGraph->resolution = { static_cast<int32_t>(gViewport.Width), static_cast<int32_t>(gViewport.Height) };
+        mRenderGraph->capacity   = GetTargetCapacity(mRenderGraph->resolution);
+        mRenderGraph->AllocateOutputTargets();
+
+        gInternalFrameIndex = 0;
     }
 
     void RenderInputShaderToy::Render(const FrameParams& frameParams)
     {
+        // Reported below for as long as dynamic resolution is active.
+        gResolutionScale = 0.0f;
+
         if (!mInitialized)
             return;
 
@@ -799,14 +2815,62 @@ namespace ICR
             default                                    : break;
         };
 
+        // A tiled render takes over the graph, nothing is presented until it finishes.
+        if (mTiledRender)
+        {
+            RenderTiles();
+            return;
+        }
+
+        // Toggled from the interface, re-allocates the targets at the capacity or at exactly the resolution (see Resize()).
+        if (mRenderGraph->dynamicResolution != mDynamicResolution)
+        {
+            mRenderGraph->dynamicResolution = mDynamicResolution;
+            mRenderGraph->Resize(mRenderGraph->resolution);
+        }
+
+        // Dynamic resolution renders a scaled sub-rect of the full-size targets, so that the scale can change every frame without
+        // reallocating anything. The controller steers it towards the target frame time, fed by the performance graph's average.
+        const auto& resolution       = mRenderGraph->resolution;
+        auto&       renderResolution = mRenderGraph->renderResolution;
+
+        if (mDynamicResolution)
+        {
+            double averageFrameTime = gDeltaTimeMovingAverage.GetAverage();
+
+            // The average follows the unit of the graph.
+            if (gPerformanceGraphMode == 1)
+                averageFrameTime = averageFrameTime > 0.0 ? 1000.0 / averageFrameTime : 0.0;
+
+            const double scale = mResolutionScaleController.Update(averageFrameTime, gDeltaTime);
+
+            renderResolution.x = std::clamp(static_cast<int32_t>(std::round(scale * resolution.x)), 1, resolution.x);
+            renderResolution.y = std::clamp(static_cast<int32_t>(std::round(scale * resolution.y)), 1, resolution.y);
+
+            gResolutionScale = static_cast<float>(scale);
+        }
+        else
+            renderResolution = resolution;
+
+        D3D12_RECT scissor = {};
+        {
+            scissor.left   = static_cast<LONG>(0);
+            scissor.top    = static_cast<LONG>(0);
+            scissor.right  = static_cast<LONG>(renderResolution.x);
+            scissor.bottom = static_cast<LONG>(renderResolution.y);
+        }
+
+        // Exact ratios of the rounded sub-rect to the targets, these scale the shader's lookups into buffer targets. (1, 1) with
+        // dynamic resolution off, the lookups are left as written then.
+        const auto renderScale = mRenderGraph->GetRenderScale();
+
         Constants constants = {};
         {
-            constants.iResolution.x = gViewport.Width;
-            constants.iResolution.y = gViewport.Height;
-            constants.iTime         = elapsedSeconds;
-            constants.iFrame        = elapsedFrames;
-            constants.iTimeDelta    = gDeltaTime;
-            constants.iFrameRate    = 1.0f / gDeltaTime;
+            constants.iAppParams0.x = renderScale.x;
+            constants.iAppParams0.y = renderScale.y;
+
+            constants.iResolution.x = static_cast<float>(renderResolution.x);
+            constants.iResolution.y = static_cast<float>(renderResolution.y);
 
             POINT mousePos;
             if (GetCursorPos(&mousePos))
@@ -822,73 +2886,133 @@ namespace ICR
 
                 // Flip
                 constants.iMouse.y = gViewport.Height - constants.iMouse.y;
+
+                constants.iMouse.x *= static_cast<float>(renderResolution.x) / gViewport.Width;
+                constants.iMouse.y *= static_cast<float>(renderResolution.y) / gViewport.Height;
             }
 
             constants.iMouse.z = ImGui::IsAnyMouseDown();
             constants.iMouse.w = ImGui::IsAnyMouseDown();
         }
-        memcpy(mpUBOData, &constants, sizeof(Constants));
 
-        D3D12_RECT scissor = {};
-        {
-            scissor.left   = static_cast<LONG>(0);
-            scissor.top    = static_cast<LONG>(0);
-            scissor.right  = static_cast<LONG>(gBackBufferSize.x);
-            scissor.bottom = static_cast<LONG>(gBackBufferSize.y);
-        }
+        // Graph work is recorded into pooled command lists and submitted ahead of the frame command list,
+        // which is left with the blit of the final output.
+        std::vector<ID3D12CommandList*> graphCommandLists;
+        std::vector<ResourceBarrier>    exitBarriers;
 
-        D3D12_VIEWPORT viewport = gViewport;
+        // Accumulating shaders converge one sample per graph execution, so the graph can run several times per presented frame.
+        // Every iteration is a full frame to the shader (time, frame and history advance) with its own constants, and all of
+        // them go out in a single submission. Only the last one is presented.
+        const float iterationDeltaTime = gDeltaTime / static_cast<float>(mIterationsPerFrame);
+
+        for (int iteration = 0; iteration < mIterationsPerFrame; iteration++)
         {
-            viewport.TopLeftX = 0.0f;
-            viewport.TopLeftY = 0.0f;
-        }
-        frameParams.pCmd->RSSetViewports(1U, &viewport);
-        frameParams.pCmd->RSSetScissorRects(1U, &scissor);
+            const bool presentedIteration = iteration == mIterationsPerFrame - 1;
+
+            for (const auto& level : mRenderGraph->levels)
+            {
+                for (auto* pRenderPass : level)
+                    pRenderPass->AdvanceFrame(iterationDeltaTime);
+            }
+
+            // Allocated ahead of recording for their addresses, and filled in below.
+            auto iterationConstants = gConstantAllocator->Allocate(sizeof(Constants));
+
+            // Decimated passes that update this iteration get a block of their own.
+            std::vector<ConstantAllocator::Allocation> renderPassConstants(mRenderGraph->renderPasses.size(), { nullptr, 0u });
+
+            for (size_t renderPassIndex = 0; renderPassIndex < mRenderGraph->renderPasses.size(); renderPassIndex++)
+            {
+                const auto* pRenderPass = mRenderGraph->renderPasses[renderPassIndex].get();
+
+                if (pRenderPass->IsDecimated() && !pRenderPass->IsSkipped())
+                    renderPassConstants[renderPassIndex] = gConstantAllocator->Allocate(sizeof(Constants));
+            }
+
+            // Video advances with the presented frames, its frames are picked up once.
+            exitBarriers = RecordRenderGraph(graphCommandLists,
+                                             iterationConstants.gpuAddress,
+                                             renderPassConstants,
+                                             scissor,
+                                             iteration == 0,
+                                             !presentedIteration,
+                                             true);
+
+            // Written after recording, so that video channels report the frames picked up above.
+            if (iteration == 0)
+                SetVideoChannelConstants(constants, mRenderGraph->videoChannels);
+
+            constants.iTime      = elapsedSeconds;
+            constants.iFrame     = elapsedFrames;
+            constants.iTimeDelta = iterationDeltaTime;
+            constants.iFrameRate = 1.0f / iterationDeltaTime;
+
+            memcpy(iterationConstants.pData, &constants, sizeof(Constants));
+
+            // Decimated passes count their own updates, and their time delta spans the frames they skipped.
+            for (size_t renderPassIndex = 0; renderPassIndex < mRenderGraph->renderPasses.size(); renderPassIndex++)
+            {
+                const auto* pRenderPass = mRenderGraph->renderPasses[renderPassIndex].get();
+
+                if (!renderPassConstants[renderPassIndex].pData)
+                    continue;
 
-        gResourceRegistry->BindDescriptorHeaps(frameParams.pCmd, DescriptorHeap::Type::Constants);
+                Constants passConstants = constants;
+                {
+                    passConstants.iFrame     = pRenderPass->GetUpdateCount() - 1;
+                    passConstants.iTimeDelta = pRenderPass->GetUpdateDeltaTime();
+                    passConstants.iFrameRate = 1.0f / std::max(pRenderPass->GetUpdateDeltaTime(), 1e-6f);
+                }
+                memcpy(renderPassConstants[renderPassIndex].pData, &passConstants, sizeof(Constants));
+            }
 
-        // Root signature is the same for all render passes, so set it once.
-        frameParams.pCmd->SetGraphicsRootSignature(mRootSignature.Get());
-        frameParams.pCmd->SetGraphicsRootConstantBufferView(0u, gResourceRegistry->Get(mUBO)->GetGPUVirtualAddress());
-        frameParams.pCmd->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+            elapsedSeconds += iterationDeltaTime;
+            elapsedFrames += 1;
 
-        // Configure the active command lists.
-        mpActiveCommandList = frameParams.pCmd;
+            if (!presentedIteration)
+                gInternalFrameIndex++;
+        }
 
-        tf::Executor renderGraphExecutor;
+        const auto finalPassOutput = mRenderGraph->pFinalRenderPass->GetOutputResources()[GetCurrentFrameIndex()];
 
-        // Dispatch all of the render passes in order.
-        renderGraphExecutor.run(mRenderGraph).wait();
+        // Submit in dependency order, the queue executes the lists back to back.
+        gCommandQueue->ExecuteCommandLists(static_cast<UINT>(graphCommandLists.size()), graphCommandLists.data());
 
-        elapsedSeconds += gDeltaTime;
-        elapsedFrames += 1;
+        // The frame fence is signaled after the frame command list, which executes after these.
+        mCommandListPool->Retire(gFenceValue);
 
-        // Blit final output into swapchain backbuffer.
+        // The rendered sub-rect is stretched over the viewport: the blit viewport grows by the inverse scale, anchored at the corner
+        // the blit presents the first texel row and column at (bottom-left), and the scissor clips it back to the viewport.
+        D3D12_VIEWPORT blitViewport = gViewport;
         {
-            auto pFinalPassOutputFrame = gResourceRegistry->Get(mpFinalRenderPass->GetOutputResources()[GetCurrentFrameIndex()]);
+            blitViewport.Width    = gViewport.Width / renderScale.x;
+            blitViewport.Height   = gViewport.Height / renderScale.y;
+            blitViewport.TopLeftY = gViewport.TopLeftY + gViewport.Height - blitViewport.Height;
+        }
 
-            D3D12_RESOURCE_BARRIER transitionBarriers[1];
+        D3D12_RECT blitScissor = {};
+        {
+            blitScissor.left   = static_cast<LONG>(gViewport.TopLeftX);
+            blitScissor.top    = static_cast<LONG>(gViewport.TopLeftY);
+            blitScissor.right  = static_cast<LONG>(gViewport.TopLeftX + gViewport.Width);
+            blitScissor.bottom = static_cast<LONG>(gViewport.TopLeftY + gViewport.Height);
+        }
 
-            transitionBarriers[0] = CD3DX12_RESOURCE_BARRIER::Transition(pFinalPassOutputFrame,
-                                                                         D3D12_RESOURCE_STATE_RENDER_TARGET,
-                                                                         D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+        // The blit below relies on the frame command list having a scissor set.
+        frameParams.pCmd->RSSetScissorRects(1U, &blitScissor);
 
-            gCommandList->ResourceBarrier(1, transitionBarriers);
+        // Blit final output into swapchain backbuffer. It stays readable until a later frame renders into it again.
+        {
+            RecordResourceBarriers(frameParams.pCmd, exitBarriers);
 
             Blitter::Params blitParams = {};
             {
-                blitParams.pCmd                       = gCommandList.Get();
-                blitParams.bindlessDescriptorSrcIndex = mpFinalRenderPass->GetOutputResources()[GetCurrentFrameIndex()].indexDescriptorTexture2D;
+                blitParams.pCmd                       = frameParams.pCmd;
+                blitParams.bindlessDescriptorSrcIndex = finalPassOutput.indexDescriptorTexture2D;
                 blitParams.renderTargetDst            = frameParams.currentSwapChainBufferRTV;
-                blitParams.viewport                   = gViewport;
+                blitParams.viewport                   = blitViewport;
             }
             gBlitter->Dispatch(blitParams);
-
-            transitionBarriers[0] = CD3DX12_RESOURCE_BARRIER::Transition(pFinalPassOutputFrame,
-                                                                         D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
-                                                                         D3D12_RESOURCE_STATE_RENDER_TARGET);
-
-            gCommandList->ResourceBarrier(1, transitionBarriers);
         }
 
         // Increment the internal frame index.
@@ -900,20 +3024,25 @@ namespace ICR
         if (!mInitialized)
             return;
 
-        for (auto& handle : mMediaResources)
-            gResourceRegistry->Release(handle);
-
         mShaderAPIRequestResult.clear();
-        mRenderGraph.clear();
-        mRenderPasses.clear();
-        mCommonShaderGLSL.clear();
 
-        gResourceRegistry->Get(mUBO)->Unmap(0, nullptr);
-        gResourceRegistry->Release(mUBO);
+        if (mTiledRender)
+        {
+            gResourceRegistry->Release(mTiledRender->readbackBuffer);
+            mTiledRender.reset();
+        }
+
+        // Graphs release their own passes, targets and media.
+        mRenderGraph.reset();
+        mRenderGraphCache.clear();
 
         mRootSignature.Reset();
         mPSO.Reset();
 
+        mCommandListPool.reset();
+
+        gResolutionScale = 0.0f;
+
         mInitialized = false;
     }
 
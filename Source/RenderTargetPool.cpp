@@ -0,0 +1,257 @@
+#include <RenderTargetPool.h>
+#include <State.h>
+
+namespace ICR
+{
+    size_t RenderTargetPool::KeyHash::operator()(const Key& key) const
+    {
+        size_t hash = std::hash<uint64_t>()(key.width);
+
+        auto Combine = [&](uint64_t value) { hash ^= std::hash<uint64_t>()(value) + 0x9e3779b97f4a7c15ull + (hash << 6u) + (hash >> 2u); };
+
+        Combine(key.height);
+        Combine(static_cast<uint64_t>(key.format));
+        Combine(static_cast<uint64_t>(key.flags));
+        Combine(key.descriptorHeapFlags);
+
+        return hash;
+    }
+
+    RenderTargetPool::RenderTargetPool(uint64_t maxFreeBytes, uint32_t maxAgeFrames) :
+        mMaxFreeBytes(maxFreeBytes),
+        mMaxAgeFrames(maxAgeFrames),
+        mFrame(0u),
+        mStats()
+    {
+    }
+
+    RenderTargetPool::~RenderTargetPool() { Clear(); }
+
+    ResourceHandle RenderTargetPool::Acquire(const CD3DX12_RESOURCE_DESC&     resourceInfo,
+                                             DescriptorHeapFlags              descriptorHeapFlags,
+                                             ResourceRegistry::MemoryCategory category,
+                                             ResourceState*                   pState)
+    {
+        const Key key = { resourceInfo.Format, resourceInfo.Width, resourceInfo.Height, resourceInfo.Flags, descriptorHeapFlags };
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            mStats.acquireCount++;
+
+            auto freeTargets = mFreeTargets.find(key);
+
+            if (freeTargets != mFreeTargets.end() && !freeTargets->second.empty())
+            {
+                // Most recently returned first, it is the likeliest to still be resident.
+                auto freeTarget = freeTargets->second.back();
+                freeTargets->second.pop_back();
+
+                mStats.freeTargetCount--;
+                mStats.freeBytes -= freeTarget.size;
+                mStats.hitCount++;
+
+                // The previous owner may have used it for something else (e.g. history instead of a pass output).
+                gResourceRegistry->SetMemoryCategory(freeTarget.handle, category);
+
+                *pState = freeTarget.state;
+
+                return freeTarget.handle;
+            }
+        }
+
+        // Created outside of the lock, so that concurrent graph builds do not wait on each other's allocations.
+        *pState = ResourceState::Common;
+
+        return gResourceRegistry->Create(resourceInfo, descriptorHeapFlags, false, category);
+    }
+
+    void RenderTargetPool::Release(const ResourceHandle& handle, ResourceState state)
+    {
+        const auto resourceInfo = gResourceRegistry->Get(handle)->GetDesc();
+
+        Key key = { resourceInfo.Format, resourceInfo.Width, resourceInfo.Height, resourceInfo.Flags, 0x0 };
+
+        // The views the target was created with are part of the key.
+        if (handle.indexDescriptorTexture2D != UINT_MAX)
+            key.descriptorHeapFlags |= DescriptorHeap::Type::Texture2D;
+
+        if (handle.indexDescriptorRenderTarget != UINT_MAX)
+            key.descriptorHeapFlags |= DescriptorHeap::Type::RenderTarget;
+
+        if (handle.indexDescriptorConstants != UINT_MAX)
+            key.descriptorHeapFlags |= DescriptorHeap::Type::Constants;
+
+        FreeTarget freeTarget = {};
+        {
+            freeTarget.handle = handle;
+            freeTarget.state  = state;
+            freeTarget.size   = gResourceRegistry->GetAllocationSize(handle);
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        freeTarget.releaseFrame = mFrame;
+
+        mFreeTargets[key].push_back(freeTarget);
+
+        mStats.freeTargetCount++;
+        mStats.freeBytes += freeTarget.size;
+
+        Trim(0u, mMaxFreeBytes);
+    }
+
+    ComPtr<D3D12MA::Allocation> RenderTargetPool::AcquireHeap(const D3D12_RESOURCE_ALLOCATION_INFO& allocationInfo)
+    {
+        if (allocationInfo.Alignment <= D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            mStats.acquireCount++;
+
+            auto freeHeaps = mFreeHeaps.find(allocationInfo.SizeInBytes);
+
+            if (freeHeaps != mFreeHeaps.end() && !freeHeaps->second.empty())
+            {
+                auto heap = std::move(freeHeaps->second.back().heap);
+                freeHeaps->second.pop_back();
+
+                mStats.freeHeapCount--;
+                mStats.freeBytes -= heap->GetSize();
+                mStats.hitCount++;
+
+                return heap;
+            }
+        }
+
+        return gResourceRegistry->AllocateRenderTargetHeap(allocationInfo);
+    }
+
+    void RenderTargetPool::ReleaseHeap(ComPtr<D3D12MA::Allocation>&& heap)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        const uint64_t size = heap->GetSize();
+
+        mFreeHeaps[size].push_back({ std::move(heap), mFrame });
+
+        mStats.freeHeapCount++;
+        mStats.freeBytes += size;
+
+        Trim(0u, mMaxFreeBytes);
+    }
+
+    void RenderTargetPool::Trim(uint64_t olderThanFrame, uint64_t maxFreeBytes)
+    {
+        while (mStats.freeTargetCount + mStats.freeHeapCount > 0u)
+        {
+            // Few entries are ever free at once, a scan for the oldest is cheaper than keeping them ordered.
+            std::vector<FreeTarget>* pOldestTargets = nullptr;
+            std::vector<FreeHeap>*   pOldestHeaps   = nullptr;
+            size_t                   oldestIndex    = 0u;
+            uint64_t                 oldestFrame    = UINT64_MAX;
+
+            for (auto& [key, freeTargets] : mFreeTargets)
+            {
+                for (size_t index = 0u; index < freeTargets.size(); index++)
+                {
+                    if (freeTargets[index].releaseFrame < oldestFrame)
+                    {
+                        pOldestTargets = &freeTargets;
+                        oldestIndex    = index;
+                        oldestFrame    = freeTargets[index].releaseFrame;
+                    }
+                }
+            }
+
+            for (auto& [size, freeHeaps] : mFreeHeaps)
+            {
+                for (size_t index = 0u; index < freeHeaps.size(); index++)
+                {
+                    if (freeHeaps[index].releaseFrame < oldestFrame)
+                    {
+                        pOldestTargets = nullptr;
+                        pOldestHeaps   = &freeHeaps;
+                        oldestIndex    = index;
+                        oldestFrame    = freeHeaps[index].releaseFrame;
+                    }
+                }
+            }
+
+            if (oldestFrame >= olderThanFrame && mStats.freeBytes <= maxFreeBytes)
+                break;
+
+            // Both are deferred by the registry, the GPU may still be using them.
+            if (pOldestTargets)
+            {
+                auto freeTarget = (*pOldestTargets)[oldestIndex];
+
+                pOldestTargets->erase(pOldestTargets->begin() + oldestIndex);
+
+                gResourceRegistry->Release(freeTarget.handle);
+
+                mStats.freeTargetCount--;
+                mStats.freeBytes -= freeTarget.size;
+            }
+            else
+            {
+                auto heap = std::move((*pOldestHeaps)[oldestIndex].heap);
+
+                pOldestHeaps->erase(pOldestHeaps->begin() + oldestIndex);
+
+                mStats.freeHeapCount--;
+                mStats.freeBytes -= heap->GetSize();
+
+                gResourceRegistry->ReleaseRenderTargetHeap(std::move(heap));
+            }
+
+            mStats.trimCount++;
+        }
+    }
+
+    void RenderTargetPool::BeginFrame()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mFrame++;
+
+        if (mFrame > mMaxAgeFrames)
+            Trim(mFrame - mMaxAgeFrames, mMaxFreeBytes);
+    }
+
+    void RenderTargetPool::Clear()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        Trim(UINT64_MAX, 0u);
+    }
+
+    void RenderTargetPool::SetMaxFreeBytes(uint64_t maxFreeBytes)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mMaxFreeBytes = maxFreeBytes;
+
+        Trim(0u, mMaxFreeBytes);
+    }
+
+    void RenderTargetPool::SetMaxAgeFrames(uint32_t maxAgeFrames)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mMaxAgeFrames = maxAgeFrames;
+    }
+
+    RenderTargetPool::Stats RenderTargetPool::GetStats()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        Stats stats = mStats;
+        {
+            stats.maxFreeBytes = mMaxFreeBytes;
+            stats.maxAgeFrames = mMaxAgeFrames;
+        }
+
+        return stats;
+    }
+} // namespace ICR
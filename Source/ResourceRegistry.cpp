@@ -1,9 +1,10 @@
 #include <ResourceRegistry.h>
 #include <State.h>
+#include <UploadQueue.h>
 
 namespace ICR
 {
-    ResourceRegistry::ResourceRegistry() : mMaxAllocations(1024u)
+    ResourceRegistry::ResourceRegistry() : mTable(1024u, this)
     {
         D3D12MA::ALLOCATOR_DESC memoryAllocatorDesc = {};
         {
@@ -13,46 +14,46 @@ namespace ICR
         }
         ThrowIfFailed(D3D12MA::CreateAllocator(&memoryAllocatorDesc, &mAllocator));
 
-        mResources.resize(mMaxAllocations);
-
-        for (uint32_t i = 0; i < mMaxAllocations; i++)
-            mFreeIndices.push(i);
-
         mDescriptorHeaps[DescriptorHeap::Type::Texture2D]    = std::make_unique<DescriptorHeap>(DescriptorHeap::Type::Texture2D);
         mDescriptorHeaps[DescriptorHeap::Type::RenderTarget] = std::make_unique<DescriptorHeap>(DescriptorHeap::Type::RenderTarget);
         mDescriptorHeaps[DescriptorHeap::Type::Constants]    = std::make_unique<DescriptorHeap>(DescriptorHeap::Type::Constants);
         mDescriptorHeaps[DescriptorHeap::Type::RawBuffer]    = std::make_unique<DescriptorHeap>(DescriptorHeap::Type::RawBuffer);
-
-        mStagingBuffer = Create(CD3DX12_RESOURCE_DESC::Buffer(32 * 1024 * 1024), 0x0, true);
+        mDescriptorHeaps[DescriptorHeap::Type::Sampler]      = std::make_unique<DescriptorHeap>(DescriptorHeap::Type::Sampler);
     }
 
-    void ResourceRegistry::AddResourceToDescriptorHeaps(ResourceHandle& handle, DescriptorHeapFlags descriptorHeapFlags)
+    uint32_t ResourceRegistry::CreateView(const DeviceResource& resource, ResourceView view)
     {
-        if ((descriptorHeapFlags & DescriptorHeap::Type::Texture2D) != 0)
-            mDescriptorHeaps[DescriptorHeap::Type::Texture2D]->CreateView(&handle);
+        return mDescriptorHeaps.at(static_cast<DescriptorHeap::Type>(1u << static_cast<uint32_t>(view)))->CreateView(resource.primitive.Get());
+    }
 
-        if ((descriptorHeapFlags & DescriptorHeap::Type::RenderTarget) != 0)
-            mDescriptorHeaps[DescriptorHeap::Type::RenderTarget]->CreateView(&handle);
+    void ResourceRegistry::FreeDescriptors(uint32_t heapType, uint32_t firstIndex, uint32_t count)
+    {
+        mDescriptorHeaps.at(static_cast<DescriptorHeap::Type>(heapType))->FreeTable(firstIndex, count);
     }
 
-    ResourceHandle ResourceRegistry::Create(ID3D12Resource* pResource, DescriptorHeapFlags descriptorHeapFlags)
+    void ResourceRegistry::Destroy(DeviceResource& resource)
     {
-        ResourceHandle handle;
-        handle.indexResource = Allocate();
+        resource.primitive.Reset();
+        resource.primitiveAlloc.Reset();
+    }
 
-        mResources[handle.indexResource].primitive.Attach(pResource);
-        mResources[handle.indexResource].primitiveAlloc = nullptr; // No need to track allocations for externally created resources.
+    ResourceHandle ResourceRegistry::Create(ID3D12Resource* pResource, DescriptorHeapFlags descriptorHeapFlags, MemoryCategory category)
+    {
+        DeviceResource resource;
+        resource.primitive.Attach(pResource); // No need to track allocations for externally created resources.
 
-        AddResourceToDescriptorHeaps(handle, descriptorHeapFlags);
+        // The memory is not ours (e.g. swap chain buffers), but it still counts against the budget.
+        const auto resourceDesc = pResource->GetDesc();
+        const auto memorySize   = gLogicalDevice->GetResourceAllocationInfo(0u, 1u, &resourceDesc).SizeInBytes;
 
-        return handle;
+        return mTable.Add(std::move(resource), descriptorHeapFlags, category, memorySize);
     }
 
-    ResourceHandle ResourceRegistry::Create(const CD3DX12_RESOURCE_DESC& resourceDesc, DescriptorHeapFlags descriptorHeapFlags, bool hostVisible)
+    ResourceHandle ResourceRegistry::Create(const CD3DX12_RESOURCE_DESC& resourceDesc,
+                                            DescriptorHeapFlags          descriptorHeapFlags,
+                                            bool                         hostVisible,
+                                            MemoryCategory               category)
     {
-        ResourceHandle handle;
-        handle.indexResource = Allocate();
-
         D3D12MA::ALLOCATION_DESC allocationDesc = { D3D12MA::ALLOCATION_FLAG_NONE, D3D12_HEAP_TYPE_DEFAULT };
 
         if (hostVisible)
@@ -72,55 +73,108 @@ namespace ICR
             pClearValue->Color[3] = 1.0f;
         }
 
+        DeviceResource resource;
+
         ThrowIfFailed(mAllocator->CreateResource(&allocationDesc,
                                                  &resourceDesc,
                                                  D3D12_RESOURCE_STATE_COMMON,
                                                  pClearValue,
-                                                 &mResources[handle.indexResource].primitiveAlloc,
-                                                 IID_PPV_ARGS(&mResources[handle.indexResource].primitive)));
+                                                 &resource.primitiveAlloc,
+                                                 IID_PPV_ARGS(&resource.primitive)));
 
         if (pClearValue)
             delete pClearValue;
 
-        AddResourceToDescriptorHeaps(handle, descriptorHeapFlags);
+        const uint64_t memorySize = resource.primitiveAlloc->GetSize();
 
-        return handle;
+        return mTable.Add(std::move(resource), descriptorHeapFlags, category, memorySize);
+    }
+
+    ResourceHandle ResourceRegistry::CreateReadback(uint64_t size)
+    {
+        D3D12MA::ALLOCATION_DESC allocationDesc = { D3D12MA::ALLOCATION_FLAG_NONE, D3D12_HEAP_TYPE_READBACK };
+
+        auto resourceDesc = CD3DX12_RESOURCE_DESC::Buffer(size);
+
+        DeviceResource resource;
+
+        ThrowIfFailed(mAllocator->CreateResource(&allocationDesc,
+                                                 &resourceDesc,
+                                                 D3D12_RESOURCE_STATE_COPY_DEST,
+                                                 nullptr,
+                                                 &resource.primitiveAlloc,
+                                                 IID_PPV_ARGS(&resource.primitive)));
+
+        const uint64_t memorySize = resource.primitiveAlloc->GetSize();
+
+        return mTable.Add(std::move(resource), 0u, MemoryCategory::Staging, memorySize);
+    }
+
+    ComPtr<D3D12MA::Allocation> ResourceRegistry::AllocateRenderTargetHeap(const D3D12_RESOURCE_ALLOCATION_INFO& allocationInfo)
+    {
+        D3D12MA::ALLOCATION_DESC allocationDesc = {};
+        {
+            allocationDesc.HeapType       = D3D12_HEAP_TYPE_DEFAULT;
+            allocationDesc.ExtraHeapFlags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+        }
+
+        ComPtr<D3D12MA::Allocation> heap;
+        ThrowIfFailed(mAllocator->AllocateMemory(&allocationDesc, &allocationInfo, &heap));
+
+        mTable.TrackMemory(MemoryCategory::PassOutputs, heap->GetSize());
+
+        return heap;
+    }
+
+    ResourceHandle ResourceRegistry::CreatePlaced(const CD3DX12_RESOURCE_DESC& resourceDesc,
+                                                  DescriptorHeapFlags          descriptorHeapFlags,
+                                                  D3D12MA::Allocation*         pHeap,
+                                                  uint64_t                     heapOffset)
+    {
+        D3D12_CLEAR_VALUE clearValue = {};
+        {
+            clearValue.Format   = resourceDesc.Format;
+            clearValue.Color[3] = 1.0f;
+        }
+
+        DeviceResource resource;
+
+        ThrowIfFailed(mAllocator->CreateAliasingResource(pHeap,
+                                                         heapOffset,
+                                                         &resourceDesc,
+                                                         D3D12_RESOURCE_STATE_COMMON,
+                                                         &clearValue,
+                                                         IID_PPV_ARGS(&resource.primitive)));
+
+        // The memory is owned by the heap, and accounted there.
+        return mTable.Add(std::move(resource), descriptorHeapFlags, MemoryCategory::PassOutputs, 0u);
     }
 
     ResourceHandle ResourceRegistry::CreateWithData(const CD3DX12_RESOURCE_DESC& resourceInfo,
                                                     DescriptorHeapFlags          descriptorHeapFlags,
                                                     const void*                  data,
-                                                    size_t                       size)
+                                                    size_t                       size,
+                                                    MemoryCategory               category)
     {
-        ResourceHandle handle = Create(resourceInfo, descriptorHeapFlags);
-
-        void* pMappedData = nullptr;
+        D3D12_SUBRESOURCE_DATA subresourceData = {};
         {
-            D3D12_RANGE range = { 0, 0 };
-            ThrowIfFailed(mResources[mStagingBuffer.indexResource].primitive->Map(0, &range, &pMappedData));
+            subresourceData.pData      = data;
+            subresourceData.RowPitch   = size / resourceInfo.Height;
+            subresourceData.SlicePitch = size;
         }
 
-        memcpy(pMappedData, data, size);
-
-        mResources[mStagingBuffer.indexResource].primitive->Unmap(0, nullptr);
+        return CreateWithData(resourceInfo, descriptorHeapFlags, &subresourceData, 1u, category);
+    }
 
-        ExecuteCommandListAndWait(gLogicalDevice.Get(),
-                                  gCommandQueue.Get(),
-                                  [&](ID3D12GraphicsCommandList* pCmd)
-                                  {
-                                      D3D12_SUBRESOURCE_DATA subresourceData = {};
-                                      subresourceData.pData                  = pMappedData;
-                                      subresourceData.RowPitch               = resourceInfo.Width * 4;
-                                      subresourceData.SlicePitch             = subresourceData.RowPitch * resourceInfo.Height;
+    ResourceHandle ResourceRegistry::CreateWithData(const CD3DX12_RESOURCE_DESC&  resourceInfo,
+                                                    DescriptorHeapFlags           descriptorHeapFlags,
+                                                    const D3D12_SUBRESOURCE_DATA* pSubresources,
+                                                    uint32_t                      subresourceCount,
+                                                    MemoryCategory                category)
+    {
+        ResourceHandle handle = Create(resourceInfo, descriptorHeapFlags, false, category);
 
-                                      UpdateSubresources(pCmd,
-                                                         mResources[handle.indexResource].primitive.Get(),
-                                                         mResources[mStagingBuffer.indexResource].primitive.Get(),
-                                                         0,
-                                                         0,
-                                                         1,
-                                                         &subresourceData);
-                                  });
+        gUploadQueue->Upload(Get(handle), 0u, pSubresources, subresourceCount);
 
         return handle;
     }
@@ -132,25 +186,160 @@ namespace ICR
         uint32_t heapCount = 0;
 
         if ((descriptorHeapFlags & DescriptorHeap::Type::Texture2D) != 0)
-            pHeaps[heapCount++] = mDescriptorHeaps[DescriptorHeap::Type::Texture2D]->GetHeap();
+            pHeaps[heapCount++] = mDescriptorHeaps.at(DescriptorHeap::Type::Texture2D)->GetHeap();
 
         if ((descriptorHeapFlags & DescriptorHeap::Type::Constants) != 0)
-            pHeaps[heapCount++] = mDescriptorHeaps[DescriptorHeap::Type::Constants]->GetHeap();
+            pHeaps[heapCount++] = mDescriptorHeaps.at(DescriptorHeap::Type::Constants)->GetHeap();
+
+        if ((descriptorHeapFlags & DescriptorHeap::Type::Sampler) != 0)
+            pHeaps[heapCount++] = mDescriptorHeaps.at(DescriptorHeap::Type::Sampler)->GetHeap();
 
         pCmd->SetDescriptorHeaps(heapCount, pHeaps);
     }
 
-    void ResourceRegistry::Release(const ResourceHandle& handle)
+    uint32_t ResourceRegistry::GetSamplerTable(const D3D12_SAMPLER_DESC* pSamplers, uint32_t samplerCount)
+    {
+        // Sampler descriptions are plain 32-bit fields without padding, so equal descriptions have equal bytes.
+        std::string key(reinterpret_cast<const char*>(pSamplers), samplerCount * sizeof(D3D12_SAMPLER_DESC));
+
+        std::lock_guard<std::mutex> samplerTablesLock(mSamplerTablesMutex);
+
+        auto samplerTable = mSamplerTables.find(key);
+
+        if (samplerTable != mSamplerTables.end())
+            return samplerTable->second;
+
+        auto* pSamplerHeap = mDescriptorHeaps.at(DescriptorHeap::Type::Sampler).get();
+
+        const uint32_t firstIndex = pSamplerHeap->AllocateTable(samplerCount);
+
+        for (uint32_t samplerIndex = 0u; samplerIndex < samplerCount; samplerIndex++)
+            gLogicalDevice->CreateSampler(&pSamplers[samplerIndex], pSamplerHeap->GetAddressCPU(firstIndex + samplerIndex));
+
+        mSamplerTables.emplace(std::move(key), firstIndex);
+
+        return firstIndex;
+    }
+
+    void ResourceRegistry::ReleaseDescriptorTable(DescriptorHeap::Type type, uint32_t firstIndex, uint32_t count)
+    {
+        mTable.ReleaseDescriptorTable(type, firstIndex, count);
+    }
+
+    void ResourceRegistry::Release(const ResourceHandle& handle) { mTable.Release(handle); }
+
+    void ResourceRegistry::ReleaseImmediate(const ResourceHandle& handle) { mTable.ReleaseImmediate(handle); }
+
+    void ResourceRegistry::ReleaseRenderTargetHeap(ComPtr<D3D12MA::Allocation>&& heap)
+    {
+        const uint64_t memorySize = heap->GetSize();
+
+        mTable.Release(DeviceResource { nullptr, std::move(heap) }, MemoryCategory::PassOutputs, memorySize);
+    }
+
+    void ResourceRegistry::ProcessDeferredReleases(uint64_t completedFenceValue, uint64_t nextFenceValue)
+    {
+        mTable.ProcessDeferredReleases(completedFenceValue, nextFenceValue);
+    }
+
+    ResourceRegistry::MemoryStats ResourceRegistry::GetMemoryStats()
     {
-        if (handle.indexResource == UINT_MAX)
-            throw std::runtime_error("ResourceRegistry: Invalid resource handle.");
+        const auto tableStats = mTable.GetMemoryStats();
 
-        mResources[handle.indexResource].primitive.Reset();
-        mResources[handle.indexResource].primitiveAlloc.Reset();
+        MemoryStats stats = {};
+        {
+            stats.categories       = tableStats.categories;
+            stats.trackedBytes     = tableStats.trackedBytes;
+            stats.peakTrackedBytes = tableStats.peakTrackedBytes;
+        }
+
+        D3D12MA::Budget localBudget    = {};
+        D3D12MA::Budget nonLocalBudget = {};
+        mAllocator->GetBudget(&localBudget, &nonLocalBudget);
+
+        stats.allocatorBytes      = localBudget.Stats.AllocationBytes + nonLocalBudget.Stats.AllocationBytes;
+        stats.allocatorBlockBytes = localBudget.Stats.BlockBytes + nonLocalBudget.Stats.BlockBytes;
+        stats.localUsageBytes     = localBudget.UsageBytes;
+        stats.localBudgetBytes    = localBudget.BudgetBytes;
+        stats.nonLocalUsageBytes  = nonLocalBudget.UsageBytes;
+        stats.nonLocalBudgetBytes = nonLocalBudget.BudgetBytes;
+
+        return stats;
+    }
+
+    nlohmann::json ResourceRegistry::GetMemoryReport()
+    {
+        const auto stats = GetMemoryStats();
+
+        nlohmann::json report;
+
+        for (size_t categoryIndex = 0u; categoryIndex < kMemoryCategoryCount; categoryIndex++)
+        {
+            const auto& categoryStats = stats.categories[categoryIndex];
 
-        if (handle.indexDescriptorTexture2D != UINT_MAX)
-            mDescriptorHeaps[DescriptorHeap::Type::Texture2D]->Free(handle.indexDescriptorTexture2D);
+            report["categories"][std::string(magic_enum::enum_name(static_cast<MemoryCategory>(categoryIndex)))] = {
+                { "count", categoryStats.count },
+                { "bytes", categoryStats.bytes },
+                { "peakBytes", categoryStats.peakBytes }
+            };
+        }
+
+        report["trackedBytes"]        = stats.trackedBytes;
+        report["peakTrackedBytes"]    = stats.peakTrackedBytes;
+        report["allocatorBytes"]      = stats.allocatorBytes;
+        report["allocatorBlockBytes"] = stats.allocatorBlockBytes;
+        report["localUsageBytes"]     = stats.localUsageBytes;
+        report["localBudgetBytes"]    = stats.localBudgetBytes;
+        report["nonLocalUsageBytes"]  = stats.nonLocalUsageBytes;
+        report["nonLocalBudgetBytes"] = stats.nonLocalBudgetBytes;
+
+        report["scopePeakBytes"] = GetMemoryScopePeaks();
+
+        // D3D12MA writes its statistics (per heap type, blocks and budgets) as JSON already.
+        WCHAR* pStatsString = nullptr;
+        mAllocator->BuildStatsString(&pStatsString, FALSE);
+
+        report["allocator"] = nlohmann::json::parse(FromWideStr(pStatsString));
+
+        mAllocator->FreeStatsString(pStatsString);
+
+        return report;
+    }
+
+    uint32_t ResourceRegistry::ReportLeaks()
+    {
+        uint32_t leakCount = 0u;
+        uint64_t leakBytes = 0u;
+
+        mTable.ForEachLive(
+            [&](const DeviceResource& resource, MemoryCategory category, uint64_t memorySize)
+            {
+                const auto resourceDesc = resource.primitive->GetDesc();
+
+                // Named through SetDebugName, if at all.
+                wchar_t name[128] = {};
+                UINT    nameSize  = sizeof(name) - sizeof(wchar_t);
+
+                if (FAILED(resource.primitive->GetPrivateData(WKPDID_D3DDebugObjectNameW, &nameSize, name)))
+                    name[0] = L'\0';
+
+                spdlog::warn("ResourceRegistry: Leaked {} resource '{}' ({}x{} {}, {:.1f} KB).",
+                             magic_enum::enum_name(category),
+                             FromWideStr(name),
+                             resourceDesc.Width,
+                             resourceDesc.Height,
+                             magic_enum::enum_name(resourceDesc.Format),
+                             memorySize / 1024.0);
+
+                leakCount++;
+                leakBytes += memorySize;
+            });
+
+        if (leakCount > 0u)
+            spdlog::warn("ResourceRegistry: {} resources ({:.1f} MB) leaked.", leakCount, leakBytes / (1024.0 * 1024.0));
+        else
+            spdlog::info("ResourceRegistry: No leaked resources.");
 
-        mFreeIndices.push(handle.indexResource);
+        return leakCount;
     }
 } // namespace ICR
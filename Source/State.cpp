@@ -1,6 +1,10 @@
 #include <State.h>
 #include <ResourceRegistry.h>
 #include <Blitter.h>
+#include <MediaCache.h>
+#include <UploadQueue.h>
+#include <ConstantAllocator.h>
+#include <RenderTargetPool.h>
 
 namespace ICR
 {
@@ -74,6 +78,13 @@ namespace ICR
     ScrollingBuffer gDeltaTimeBuffer;
     ScrollingBuffer gDeltaTimeMovingAverageBuffer;
 
+    // What the performance graph (and the moving average) measures: 0 = frame time (ms), 1 = frames-per-second.
+    int gPerformanceGraphMode;
+
+    // Internal resolution scale (per axis) of the render input under dynamic resolution, 0 while it renders at full resolution.
+    float           gResolutionScale = 0.0f;
+    ScrollingBuffer gResolutionScaleBuffer;
+
     // V-Sync Interval requested by user.
     int gSyncInterval;
 
@@ -103,4 +114,16 @@ namespace ICR
     std::unique_ptr<Blitter> gBlitter;
 
     std::unique_ptr<ResourceRegistry> gResourceRegistry;
+
+    // Declared after the registry so that it is destroyed first.
+    std::unique_ptr<MediaCache> gMediaCache;
+
+    // Also holds staging buffers from the registry.
+    std::unique_ptr<UploadQueue> gUploadQueue;
+
+    // Per-frame constants, paged for the buffering at device creation (a later, deeper one only waits more often).
+    std::unique_ptr<ConstantAllocator> gConstantAllocator;
+
+    // Render targets and transient heaps of released render graphs, kept for the next ones.
+    std::unique_ptr<RenderTargetPool> gRenderTargetPool;
 } // namespace ICR
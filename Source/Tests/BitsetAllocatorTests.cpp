@@ -0,0 +1,313 @@
+#include <BitsetAllocator.h>
+#include <UnitTest.h>
+
+#include <algorithm>
+#include <deque>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace ICR;
+
+constexpr uint32_t kPageSize = BitsetAllocator::kPageSize;
+
+// Allocation
+// -------------------------------------------------
+
+static void TestSingleIndices()
+{
+    BitsetAllocator allocator(kPageSize, kPageSize);
+
+    for (uint32_t index = 0u; index < 4u; index++)
+        CHECK(allocator.Allocate() == index);
+
+    CHECK(allocator.IsAllocated(2u));
+    CHECK(!allocator.IsAllocated(4u));
+    CHECK(!allocator.IsAllocated(kPageSize * 100u));
+
+    // The lowest free index is handed out first.
+    allocator.Free(1u);
+
+    CHECK(!allocator.IsAllocated(1u));
+    CHECK(allocator.Allocate() == 1u);
+    CHECK(allocator.GetUsedCount() == 4u);
+}
+
+static void TestRanges()
+{
+    BitsetAllocator allocator(4u * kPageSize, 4u * kPageSize);
+
+    CHECK(allocator.Allocate(0u) == BitsetAllocator::kInvalidIndex);
+
+    const uint32_t first = allocator.Allocate(8u);
+
+    CHECK(first == 0u);
+
+    // Crossing into the next word, and longer than a word.
+    const uint32_t crossing  = allocator.Allocate(kPageSize);
+    const uint32_t longRange = allocator.Allocate(kPageSize + 10u);
+
+    CHECK(crossing == 8u);
+    CHECK(longRange == 8u + kPageSize);
+    CHECK(allocator.GetUsedCount() == 8u + kPageSize + kPageSize + 10u);
+
+    // A range only fits where there is room for all of it.
+    allocator.Free(2u, 4u);
+
+    CHECK(allocator.Allocate(5u) == 18u + 2u * kPageSize);
+    CHECK(allocator.Allocate(4u) == 2u);
+
+    CHECK(allocator.Allocate(4u * kPageSize + 1u) == BitsetAllocator::kInvalidIndex);
+}
+
+static void TestGrowth()
+{
+    BitsetAllocator allocator(kPageSize, 4u * kPageSize);
+
+    CHECK(allocator.GetCapacity() == kPageSize);
+
+    for (uint32_t index = 0u; index < kPageSize; index++)
+        allocator.Allocate();
+
+    CHECK(allocator.GetCapacity() == kPageSize);
+
+    // Doubles when nothing fits, a range starting in the old capacity continues into the new pages.
+    allocator.Free(kPageSize - 2u, 2u);
+
+    CHECK(allocator.Allocate(4u) == kPageSize - 2u);
+    CHECK(allocator.GetCapacity() == 2u * kPageSize);
+
+    // Grows as far as needed at once, but never past the maximum.
+    CHECK(allocator.Allocate(2u * kPageSize) == kPageSize + 2u);
+    CHECK(allocator.GetCapacity() == 4u * kPageSize);
+
+    while (allocator.GetUsedCount() < 4u * kPageSize)
+        CHECK(allocator.Allocate() != BitsetAllocator::kInvalidIndex);
+
+    CHECK(allocator.Allocate() == BitsetAllocator::kInvalidIndex);
+    CHECK(allocator.GetCapacity() == 4u * kPageSize);
+
+    CHECK_THROWS(BitsetAllocator(2u * kPageSize, kPageSize), std::invalid_argument);
+}
+
+static void TestInvalidFrees()
+{
+    BitsetAllocator allocator(kPageSize, kPageSize);
+
+    const uint32_t first = allocator.Allocate(4u);
+
+    CHECK_THROWS(allocator.Free(kPageSize), std::runtime_error);
+    CHECK_THROWS(allocator.Free(first, 0u), std::runtime_error);
+    CHECK_THROWS(allocator.Free(kPageSize - 1u, 2u), std::runtime_error);
+
+    // Partly allocated: rejected as a whole, nothing is freed.
+    CHECK_THROWS(allocator.Free(first + 2u, 4u), std::runtime_error);
+    CHECK(allocator.IsAllocated(first + 2u));
+    CHECK(allocator.GetUsedCount() == 4u);
+
+    allocator.Free(first, 4u);
+
+    CHECK_THROWS(allocator.Free(first, 4u), std::runtime_error);
+    CHECK(allocator.GetUsedCount() == 0u);
+}
+
+// Stats
+// -------------------------------------------------
+
+static void TestFragmentation()
+{
+    BitsetAllocator allocator(2u * kPageSize, 4u * kPageSize);
+
+    for (uint32_t index = 0u; index < 2u * kPageSize; index++)
+        allocator.Allocate();
+
+    // Every other index free: plenty of room, but no two in a row.
+    for (uint32_t index = 0u; index < 2u * kPageSize; index += 2u)
+        allocator.Free(index);
+
+    auto stats = allocator.GetStats();
+
+    CHECK(stats.usedCount == kPageSize);
+    CHECK(stats.largestFreeRange == 1u);
+    CHECK(stats.fragmentation == 1.0f - 1.0f / kPageSize);
+
+    // So a range has to grow the capacity, single indices still fill the holes.
+    CHECK(allocator.Allocate(2u) == 2u * kPageSize);
+    CHECK(allocator.Allocate() == 0u);
+
+    for (uint32_t index = 0u; index < 2u * kPageSize + 2u; index++)
+    {
+        if (allocator.IsAllocated(index))
+            allocator.Free(index);
+    }
+
+    stats = allocator.GetStats();
+
+    CHECK(stats.usedCount == 0u);
+    CHECK(stats.largestFreeRange == stats.capacity);
+    CHECK(stats.fragmentation == 0.0f);
+}
+
+static void TestHighWaterMark()
+{
+    BitsetAllocator allocator(kPageSize, 4u * kPageSize);
+
+    const uint32_t first  = allocator.Allocate(10u);
+    const uint32_t second = allocator.Allocate(20u);
+
+    allocator.Free(first, 10u);
+    allocator.Free(second, 20u);
+
+    allocator.Allocate(5u);
+
+    const auto stats = allocator.GetStats();
+
+    CHECK(stats.highWaterMark == 30u);
+    CHECK(stats.usedCount == 5u);
+    CHECK(stats.maxCapacity == 4u * kPageSize);
+}
+
+// Reloads
+// -------------------------------------------------
+
+static void TestReloadCycles()
+{
+    constexpr uint32_t kReloadCount        = 5000u;
+    constexpr uint32_t kMaxRenderPasses    = 6u;
+    constexpr uint32_t kResizesPerReload   = 4u;
+    constexpr uint32_t kInputTableSize     = 8u;
+    constexpr uint32_t kFramesInFlight     = 2u;
+    constexpr uint32_t kWarmUpReloadCount  = 100u;
+    constexpr uint32_t kMaxDescriptorCount = 65536u;
+
+    // Replays the descriptor allocations of shader reloads and resizes, like the shader resource and render target heaps see
+    // them, each heap with a shadow of the indices handed out.
+    struct Heap
+    {
+        BitsetAllocator   allocator;
+        std::vector<bool> live;
+    };
+
+    Heap views         = { BitsetAllocator(1024u, kMaxDescriptorCount), std::vector<bool>(kMaxDescriptorCount, false) };
+    Heap renderTargets = { BitsetAllocator(1024u, kMaxDescriptorCount), std::vector<bool>(kMaxDescriptorCount, false) };
+
+    struct PendingFree
+    {
+        Heap*    pHeap;
+        uint32_t firstIndex;
+        uint32_t count;
+    };
+
+    // Released descriptors come back a few frames later, like the registry's deferred releases.
+    std::deque<std::vector<PendingFree>> pendingFrames(kFramesInFlight);
+
+    uint32_t exhaustedCount         = 0u;
+    uint32_t overlappingAllocations = 0u;
+
+    auto Allocate = [&](Heap& heap, uint32_t count)
+    {
+        const uint32_t firstIndex = heap.allocator.Allocate(count);
+
+        if (firstIndex == BitsetAllocator::kInvalidIndex)
+        {
+            exhaustedCount++;
+            return PendingFree { &heap, 0u, 0u };
+        }
+
+        for (uint32_t index = firstIndex; index < firstIndex + count; index++)
+        {
+            if (heap.live[index])
+                overlappingAllocations++;
+
+            heap.live[index] = true;
+        }
+
+        return PendingFree { &heap, firstIndex, count };
+    };
+
+    auto EndFrame = [&]()
+    {
+        for (const auto& pendingFree : pendingFrames.front())
+        {
+            if (pendingFree.count == 0u)
+                continue;
+
+            pendingFree.pHeap->allocator.Free(pendingFree.firstIndex, pendingFree.count);
+
+            std::fill_n(pendingFree.pHeap->live.begin() + pendingFree.firstIndex, pendingFree.count, false);
+        }
+
+        pendingFrames.pop_front();
+        pendingFrames.emplace_back();
+    };
+
+    std::mt19937 random(0u);
+
+    uint32_t warmCapacity = 0u;
+
+    for (uint32_t reload = 0u; reload < kReloadCount; reload++)
+    {
+        const uint32_t renderPassCount = 1u + random() % kMaxRenderPasses;
+
+        // Every pass: an input table released with the pass, and a view and render target view per output (two with history)
+        // released on the next resize.
+        std::vector<PendingFree> inputTables;
+        std::vector<uint32_t>    outputCounts;
+
+        for (uint32_t renderPassIndex = 0u; renderPassIndex < renderPassCount; renderPassIndex++)
+        {
+            inputTables.push_back(Allocate(views, kInputTableSize));
+            outputCounts.push_back(1u + random() % 2u);
+        }
+
+        for (uint32_t resize = 0u; resize < kResizesPerReload; resize++)
+        {
+            for (uint32_t outputCount : outputCounts)
+            {
+                for (uint32_t outputIndex = 0u; outputIndex < outputCount; outputIndex++)
+                {
+                    pendingFrames.back().push_back(Allocate(views, 1u));
+                    pendingFrames.back().push_back(Allocate(renderTargets, 1u));
+                }
+            }
+
+            EndFrame();
+        }
+
+        pendingFrames.back().insert(pendingFrames.back().end(), inputTables.begin(), inputTables.end());
+
+        EndFrame();
+
+        if (reload + 1u == kWarmUpReloadCount)
+            warmCapacity = views.allocator.GetCapacity() + renderTargets.allocator.GetCapacity();
+    }
+
+    for (uint32_t frame = 0u; frame < kFramesInFlight; frame++)
+        EndFrame();
+
+    const auto viewStats         = views.allocator.GetStats();
+    const auto renderTargetStats = renderTargets.allocator.GetStats();
+
+    // Neither leaks nor keeps growing once the working set was reached.
+    CHECK(exhaustedCount == 0u);
+    CHECK(overlappingAllocations == 0u);
+    CHECK(viewStats.usedCount == 0u);
+    CHECK(renderTargetStats.usedCount == 0u);
+    CHECK(viewStats.capacity + renderTargetStats.capacity == warmCapacity);
+    CHECK(viewStats.highWaterMark <= viewStats.capacity);
+    CHECK(viewStats.fragmentation == 0.0f);
+    CHECK(renderTargetStats.fragmentation == 0.0f);
+}
+
+int main()
+{
+    return UnitTest::Run({
+        { "SingleIndices", TestSingleIndices },
+        { "Ranges", TestRanges },
+        { "Growth", TestGrowth },
+        { "InvalidFrees", TestInvalidFrees },
+        { "Fragmentation", TestFragmentation },
+        { "HighWaterMark", TestHighWaterMark },
+        { "ReloadCycles", TestReloadCycles },
+    });
+}
@@ -0,0 +1,93 @@
+#ifndef MOCK_RESOURCE_FACTORY_H
+#define MOCK_RESOURCE_FACTORY_H
+
+#include <BitsetAllocator.h>
+#include <ResourceTable.h>
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+namespace ICR
+{
+    // Stands in for the device: a resource is a serial number tagged with the thread that created it.
+    struct MockResource
+    {
+        uint64_t serial = 0u;
+        uint32_t owner  = UINT32_MAX;
+    };
+
+    // Resource factory without a device. Descriptors come from a bitset allocator per view type, as in the descriptor heaps, so
+    // that leaked or double-freed descriptors show in the used counts (or throw).
+    class MockResourceFactory : public ResourceFactory<MockResource>
+    {
+    public:
+
+        MockResourceFactory() : mDestroyedCount(0u)
+        {
+            for (auto& heap : mHeaps)
+                heap = std::make_unique<BitsetAllocator>(64u, 16384u);
+        }
+
+        uint32_t CreateView(const MockResource&, ResourceView view) override
+        {
+            std::lock_guard<std::mutex> heapsLock(mHeapsMutex);
+
+            const uint32_t index = mHeaps[static_cast<size_t>(view)]->Allocate();
+
+            if (index == BitsetAllocator::kInvalidIndex)
+                throw std::runtime_error("MockResourceFactory: Maximum number of descriptors reached.");
+
+            return index;
+        }
+
+        void FreeDescriptors(uint32_t heapType, uint32_t firstIndex, uint32_t count) override
+        {
+            std::lock_guard<std::mutex> heapsLock(mHeapsMutex);
+
+            mHeaps[std::countr_zero(heapType)]->Free(firstIndex, count);
+        }
+
+        void Destroy(MockResource& resource) override
+        {
+            resource = {};
+
+            mDestroyedCount.fetch_add(1u, std::memory_order_relaxed);
+        }
+
+        // Descriptor tables live in the heap of a view type, like the sampler tables of the registry in theirs.
+        uint32_t AllocateTable(ResourceView view, uint32_t count)
+        {
+            std::lock_guard<std::mutex> heapsLock(mHeapsMutex);
+
+            return mHeaps[static_cast<size_t>(view)]->Allocate(count);
+        }
+
+        uint32_t GetUsedCount(ResourceView view)
+        {
+            std::lock_guard<std::mutex> heapsLock(mHeapsMutex);
+
+            return mHeaps[static_cast<size_t>(view)]->GetUsedCount();
+        }
+
+        bool IsAllocated(ResourceView view, uint32_t index)
+        {
+            std::lock_guard<std::mutex> heapsLock(mHeapsMutex);
+
+            return mHeaps[static_cast<size_t>(view)]->IsAllocated(index);
+        }
+
+        inline uint32_t GetDestroyedCount() const { return mDestroyedCount.load(std::memory_order_relaxed); }
+
+    private:
+
+        std::mutex                                                        mHeapsMutex;
+        std::array<std::unique_ptr<BitsetAllocator>, kResourceViewCount> mHeaps;
+        std::atomic<uint32_t>                                             mDestroyedCount;
+    };
+} // namespace ICR
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef SYNTHETIC_RENDER_GRAPH_H
+#define SYNTHETIC_RENDER_GRAPH_H
+
+#include <RenderGraphCompiler.h>
+#include <RenderGraphSchedule.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace ICR
+{
+    // Every pass samples up to four outputs, mostly of the passes shortly before it, some from the previous frame (its own or a
+    // later pass). The last pass is the final one and samples four.
+    inline std::vector<PassDeclaration> CreateSyntheticGraph(uint32_t passCount, uint32_t seed)
+    {
+        std::mt19937 random(seed);
+
+        std::vector<PassDeclaration> passes(passCount);
+
+        for (uint32_t passIndex = 0u; passIndex < passCount; passIndex++)
+        {
+            auto& pass = passes[passIndex];
+
+            pass.outputID = static_cast<int>(passIndex);
+            pass.final    = passIndex + 1u == passCount;
+
+            const uint32_t inputCount = pass.final ? 4u : random() % 5u;
+
+            for (uint32_t inputIndex = 0u; inputIndex < inputCount; inputIndex++)
+            {
+                uint32_t inputPass;
+
+                if (passIndex == 0u || random() % 8u == 0u)
+                    inputPass = random() % passCount; // History, or a regular input by chance.
+                else
+                    inputPass = passIndex - 1u - random() % std::min(passIndex, 16u);
+
+                pass.inputIDs.push_back(static_cast<int>(inputPass));
+            }
+        }
+
+        return passes;
+    }
+
+    // Accesses of the scheduled levels, every output a resource of its own. Previous frame outputs are separate resources (the
+    // other half of the double buffer), IDs offset by the pass count.
+    inline std::vector<std::vector<RenderGraphCompiler::PassAccess>> CreateLevelAccesses(const std::vector<PassDeclaration>& passes,
+                                                                                         const RenderGraphSchedule&          schedule)
+    {
+        const auto passCount = static_cast<uint32_t>(passes.size());
+
+        std::vector<std::vector<RenderGraphCompiler::PassAccess>> levelAccesses;
+
+        for (const auto& level : schedule.GetLevels())
+        {
+            auto& passAccesses = levelAccesses.emplace_back();
+
+            for (auto passIndex : level)
+            {
+                RenderGraphCompiler::PassAccess passAccess;
+
+                passAccess.writes.push_back(static_cast<uint32_t>(passes[passIndex].outputID));
+
+                for (int inputID : passes[passIndex].inputIDs)
+                {
+                    const uint32_t resource = schedule.IsHistoryInput(passIndex, inputID) ? passCount + inputID : inputID;
+
+                    if (std::find(passAccess.reads.begin(), passAccess.reads.end(), resource) == passAccess.reads.end())
+                        passAccess.reads.push_back(resource);
+                }
+
+                passAccesses.push_back(std::move(passAccess));
+            }
+        }
+
+        return levelAccesses;
+    }
+} // namespace ICR
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef UNIT_TEST_H
+#define UNIT_TEST_H
+
+#include <cstdio>
+#include <exception>
+#include <vector>
+
+// Minimal test harness for the core library, so that the tests build with nothing but the standard library. A test is a plain
+// function making checks, a test executable runs a list of them and fails if any check failed or any test threw.
+
+#define CHECK(condition) ICR::UnitTest::Check((condition), #condition, __FILE__, __LINE__)
+
+#define CHECK_THROWS(expression, exceptionType)                                                                                       \
+    do                                                                                                                                \
+    {                                                                                                                                 \
+        bool thrown = false;                                                                                                          \
+        try                                                                                                                           \
+        {                                                                                                                             \
+            (void)(expression);                                                                                                       \
+        }                                                                                                                             \
+        catch (const exceptionType&)                                                                                                  \
+        {                                                                                                                             \
+            thrown = true;                                                                                                            \
+        }                                                                                                                             \
+        ICR::UnitTest::Check(thrown, #expression " throws " #exceptionType, __FILE__, __LINE__);                                      \
+    } while (false)
+
+namespace ICR::UnitTest
+{
+    struct TestCase
+    {
+        const char* name;
+        void (*function)();
+    };
+
+    inline int& GetFailureCount()
+    {
+        static int failureCount = 0;
+        return failureCount;
+    }
+
+    inline void Check(bool passed, const char* expression, const char* file, int line)
+    {
+        if (passed)
+            return;
+
+        GetFailureCount()++;
+
+        std::fprintf(stderr, "%s:%d: Check failed: %s\n", file, line, expression);
+    }
+
+    // Returns the exit code of the test executable.
+    inline int Run(const std::vector<TestCase>& testCases)
+    {
+        int failedCount = 0;
+
+        for (const auto& testCase : testCases)
+        {
+            const int previousFailureCount = GetFailureCount();
+
+            try
+            {
+                testCase.function();
+            }
+            catch (const std::exception& exception)
+            {
+                GetFailureCount()++;
+
+                std::fprintf(stderr, "%s: Unexpected exception: %s\n", testCase.name, exception.what());
+            }
+
+            const bool passed = GetFailureCount() == previousFailureCount;
+
+            failedCount += passed ? 0 : 1;
+
+            std::printf("[%s] %s\n", passed ? "PASS" : "FAIL", testCase.name);
+        }
+
+        std::printf("%zu tests, %d failed.\n", testCases.size(), failedCount);
+
+        return failedCount == 0 ? 0 : 1;
+    }
+} // namespace ICR::UnitTest
+
+#endif
@@ -0,0 +1,91 @@
+#include <SyntheticRenderGraph.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+using namespace ICR;
+
+// Measures what building a render graph costs on the CPU: scheduling, transient placement and barrier planning, on synthetic
+// graphs far larger than any ShaderToy, so that regressions in their complexity show. Prints the best of a number of runs
+// (first argument, 10 by default) per graph size.
+
+template <typename Function>
+static double MeasureBestMs(int runCount, Function&& function)
+{
+    double bestMs = 1e30;
+
+    for (int run = 0; run < runCount; run++)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        function();
+
+        bestMs = std::min(bestMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    return bestMs;
+}
+
+int main(int argc, char** argv)
+{
+    const int runCount = argc > 1 ? std::max(std::atoi(argv[1]), 1) : 10;
+
+    std::printf("%8s %8s %8s %14s %14s %14s\n", "Passes", "Levels", "Culled", "Schedule (ms)", "Placement (ms)", "Barriers (ms)");
+
+    for (uint32_t passCount : { 16u, 64u, 256u, 1024u, 4096u })
+    {
+        const auto passes = CreateSyntheticGraph(passCount, passCount);
+
+        // Schedule
+        // ------------------------------------------------
+
+        std::unique_ptr<RenderGraphSchedule> schedule;
+
+        const double scheduleMs = MeasureBestMs(runCount, [&]() { schedule = std::make_unique<RenderGraphSchedule>(passes); });
+
+        // Placement, of the outputs that do not outlive the frame.
+        // ------------------------------------------------
+
+        std::vector<TransientAllocation> transientAllocations;
+
+        for (size_t passIndex = 0u; passIndex < passes.size(); passIndex++)
+        {
+            if (schedule->IsCulled(passIndex))
+                continue;
+
+            const auto& lifetime = schedule->GetLifetimes()[passIndex];
+
+            if (!lifetime.history)
+                transientAllocations.push_back({ (1u + passIndex % 4u) * 8u * 1024u * 1024u, lifetime.firstLevel, lifetime.lastLevel, 0u });
+        }
+
+        const double placementMs = MeasureBestMs(runCount,
+                                                 [&]()
+                                                 {
+                                                     auto allocations = transientAllocations;
+                                                     PlaceTransientAllocations(allocations, 64u * 1024u);
+                                                 });
+
+        // Barriers, every output a resource of its own.
+        // ------------------------------------------------
+
+        const auto levelAccesses = CreateLevelAccesses(passes, *schedule);
+
+        RenderGraphCompiler compiler;
+
+        const double barriersMs = MeasureBestMs(runCount, [&]() { compiler.Compile(levelAccesses, { passCount - 1u }); });
+
+        std::printf("%8u %8zu %8zu %14.3f %14.3f %14.3f\n",
+                    passCount,
+                    schedule->GetLevels().size(),
+                    schedule->GetCulledPasses().size(),
+                    scheduleMs,
+                    placementMs,
+                    barriersMs);
+    }
+
+    return 0;
+}
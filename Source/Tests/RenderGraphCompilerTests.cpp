@@ -0,0 +1,241 @@
+#include <RenderGraphCompiler.h>
+#include <UnitTest.h>
+
+#include <stdexcept>
+
+using namespace ICR;
+
+using Split = ResourceBarrier::Split;
+
+// State tracking
+// -------------------------------------------------
+
+static void TestStateTracking()
+{
+    RenderGraphCompiler compiler;
+
+    // Unknown resources are common.
+    CHECK(compiler.GetState(7u) == ResourceState::Common);
+
+    compiler.SetState(7u, ResourceState::ShaderResource);
+    CHECK(compiler.GetState(7u) == ResourceState::ShaderResource);
+
+    compiler.Reset();
+    CHECK(compiler.GetState(7u) == ResourceState::Common);
+}
+
+static void TestStatesCarryAcrossFrames()
+{
+    RenderGraphCompiler compiler;
+
+    // Written by the only level, read after the graph.
+    const std::vector<std::vector<RenderGraphCompiler::PassAccess>> levels = { { { {}, { 1u } } } };
+
+    compiler.Compile(levels, { 1u });
+
+    CHECK(compiler.GetState(1u) == ResourceState::ShaderResource);
+
+    // The next frame starts from where the last one left the resource.
+    auto plan = compiler.Compile(levels, { 1u });
+
+    CHECK(plan.levelBarriers[0] == std::vector<ResourceBarrier>({ { 1u, ResourceState::ShaderResource, ResourceState::RenderTarget, Split::None } }));
+    CHECK(plan.exitBarriers == std::vector<ResourceBarrier>({ { 1u, ResourceState::RenderTarget, ResourceState::ShaderResource, Split::None } }));
+}
+
+static void TestEmptyGraph()
+{
+    RenderGraphCompiler compiler;
+
+    auto plan = compiler.Compile({}, {});
+
+    CHECK(plan.levelBarriers.empty());
+    CHECK(plan.exitBarriers.empty());
+
+    // A level without accesses still gets its (empty) batch.
+    plan = compiler.Compile({ {}, {} }, {});
+
+    CHECK(plan.levelBarriers.size() == 2u);
+    CHECK(plan.levelBarriers[0].empty());
+    CHECK(plan.levelBarriers[1].empty());
+}
+
+static void TestReadWriteConflict()
+{
+    RenderGraphCompiler compiler;
+
+    // Passes of a level run concurrently, one of them cannot sample what another renders to.
+    const std::vector<std::vector<RenderGraphCompiler::PassAccess>> levels = { { { {}, { 1u } }, { { 1u }, { 2u } } } };
+
+    CHECK_THROWS(compiler.Compile(levels, {}), std::runtime_error);
+}
+
+// Barrier plans
+// -------------------------------------------------
+
+using Levels   = std::vector<std::vector<RenderGraphCompiler::PassAccess>>;
+using Barriers = std::vector<ResourceBarrier>;
+
+constexpr auto kCommon         = ResourceState::Common;
+constexpr auto kRenderTarget   = ResourceState::RenderTarget;
+constexpr auto kShaderResource = ResourceState::ShaderResource;
+
+static void TestReadAfterWrite()
+{
+    RenderGraphCompiler compiler;
+
+    // Sampled last frame, rendered to by level 0 and sampled by level 1 right after.
+    compiler.SetState(1u, kShaderResource);
+    compiler.SetState(2u, kRenderTarget);
+
+    auto plan = compiler.Compile({ { { {}, { 1u } } }, { { { 1u }, { 2u } } } }, {});
+
+    CHECK(plan.levelBarriers.size() == 2u);
+    CHECK(plan.levelBarriers[0] == Barriers({ { 1u, kShaderResource, kRenderTarget, Split::None } }));
+    CHECK(plan.levelBarriers[1] == Barriers({ { 1u, kRenderTarget, kShaderResource, Split::None } }));
+    CHECK(plan.exitBarriers.empty());
+}
+
+static void TestHistoryPingPong()
+{
+    RenderGraphCompiler compiler;
+
+    // A pass sampling its previous output: the halves of the double buffer swap roles every frame, the presented half is read
+    // after the graph.
+    auto CompileFrame = [&](uint32_t current, uint32_t previous) { return compiler.Compile({ { { { previous }, { current } } } }, { current }); };
+
+    auto plan = CompileFrame(10u, 11u);
+
+    CHECK(plan.levelBarriers[0] == Barriers({ { 10u, kCommon, kRenderTarget, Split::None }, { 11u, kCommon, kShaderResource, Split::None } }));
+    CHECK(plan.exitBarriers == Barriers({ { 10u, kRenderTarget, kShaderResource, Split::None } }));
+
+    // Last frame's output is still readable from its exit barrier, only the half that is rendered to transitions.
+    for (int frame = 1; frame < 5; frame++)
+    {
+        const uint32_t current  = frame % 2 == 0 ? 10u : 11u;
+        const uint32_t previous = frame % 2 == 0 ? 11u : 10u;
+
+        plan = CompileFrame(current, previous);
+
+        CHECK(plan.levelBarriers[0] == Barriers({ { current, kShaderResource, kRenderTarget, Split::None } }));
+        CHECK(plan.exitBarriers == Barriers({ { current, kRenderTarget, kShaderResource, Split::None } }));
+    }
+}
+
+static void TestAliasing()
+{
+    RenderGraphCompiler compiler;
+
+    // 1 and 2 are placed at the same offset of a transient heap with disjoint lifetimes, 3 and 4 have memory of their own.
+    compiler.SetAliased(1u);
+    compiler.SetAliased(2u);
+
+    const Levels levels = {
+        { { {}, { 1u } } },
+        { { { 1u }, { 3u } } },
+        { { {}, { 2u } } },
+        { { { 2u, 3u }, { 4u } } },
+    };
+
+    for (int frame = 0; frame < 2; frame++)
+    {
+        auto plan = compiler.Compile(levels, { 4u });
+
+        // Every frame the aliased resources take over the memory again, at their first use.
+        CHECK(plan.levelActivations == std::vector<std::vector<uint32_t>>({ { 1u }, {}, { 2u }, {} }));
+
+        const auto initialState = frame == 0 ? kCommon : kShaderResource;
+
+        // Aliased transitions stay in the level that needs them, the others are split across the idle levels in between.
+        CHECK(plan.levelBarriers[0] == Barriers({ { 1u, initialState, kRenderTarget, Split::None },
+                                                  { 3u, initialState, kRenderTarget, Split::Begin },
+                                                  { 4u, initialState, kRenderTarget, Split::Begin } }));
+
+        CHECK(plan.levelBarriers[1] == Barriers({ { 1u, kRenderTarget, kShaderResource, Split::None },
+                                                  { 3u, initialState, kRenderTarget, Split::End } }));
+
+        CHECK(plan.levelBarriers[2] == Barriers({ { 2u, initialState, kRenderTarget, Split::None },
+                                                  { 3u, kRenderTarget, kShaderResource, Split::Begin } }));
+
+        CHECK(plan.levelBarriers[3] == Barriers({ { 2u, kRenderTarget, kShaderResource, Split::None },
+                                                  { 3u, kRenderTarget, kShaderResource, Split::End },
+                                                  { 4u, initialState, kRenderTarget, Split::End } }));
+
+        CHECK(plan.exitBarriers == Barriers({ { 4u, kRenderTarget, kShaderResource, Split::None } }));
+    }
+}
+
+static void TestSplitPlacement()
+{
+    RenderGraphCompiler compiler;
+
+    // Written in level 0 and sampled in level 3: the transition begins right after the write and ends ahead of the read. The
+    // other outputs stay render targets and need nothing.
+    compiler.SetState(2u, kRenderTarget);
+    compiler.SetState(3u, kRenderTarget);
+    compiler.SetState(4u, kRenderTarget);
+
+    auto plan = compiler.Compile({ { { {}, { 1u } } }, { { {}, { 2u } } }, { { {}, { 3u } } }, { { { 1u }, { 4u } } } }, {});
+
+    CHECK(plan.levelBarriers[0] == Barriers({ { 1u, kCommon, kRenderTarget, Split::None } }));
+    CHECK(plan.levelBarriers[1] == Barriers({ { 1u, kRenderTarget, kShaderResource, Split::Begin } }));
+    CHECK(plan.levelBarriers[2].empty());
+    CHECK(plan.levelBarriers[3] == Barriers({ { 1u, kRenderTarget, kShaderResource, Split::End } }));
+
+    // The exit reads are recorded into their own submission, transitions into them are never split.
+    RenderGraphCompiler exitCompiler;
+
+    exitCompiler.SetState(2u, kRenderTarget);
+
+    plan = exitCompiler.Compile({ { { {}, { 1u } } }, { { {}, { 2u } } } }, { 1u });
+
+    CHECK(plan.levelBarriers[0] == Barriers({ { 1u, kCommon, kRenderTarget, Split::None } }));
+    CHECK(plan.levelBarriers[1].empty());
+    CHECK(plan.exitBarriers == Barriers({ { 1u, kRenderTarget, kShaderResource, Split::None } }));
+}
+
+static void TestNoRedundantTransitions()
+{
+    RenderGraphCompiler compiler;
+
+    compiler.SetState(2u, kRenderTarget);
+    compiler.SetState(3u, kRenderTarget);
+    compiler.SetState(4u, kRenderTarget);
+
+    // Output 1 is sampled by two passes of level 1 and again in level 2, it transitions once. Outputs already in the state a
+    // level needs get no barrier at all.
+    const Levels levels = {
+        { { {}, { 1u } } },
+        { { { 1u }, { 2u } }, { { 1u }, { 3u } } },
+        { { { 1u, 2u, 3u }, { 4u } } },
+    };
+
+    auto plan = compiler.Compile(levels, { 4u });
+
+    CHECK(plan.levelBarriers[0] == Barriers({ { 1u, kCommon, kRenderTarget, Split::None } }));
+    CHECK(plan.levelBarriers[1] == Barriers({ { 1u, kRenderTarget, kShaderResource, Split::None } }));
+    CHECK(plan.levelBarriers[2] == Barriers({ { 2u, kRenderTarget, kShaderResource, Split::None },
+                                              { 3u, kRenderTarget, kShaderResource, Split::None } }));
+    CHECK(plan.exitBarriers == Barriers({ { 4u, kRenderTarget, kShaderResource, Split::None } }));
+
+    // Only sampling what is already readable needs nothing, in the levels or ahead of the exit reads.
+    plan = compiler.Compile({ { { { 1u, 2u }, {} } }, { { { 3u }, {} } } }, { 4u });
+
+    CHECK(plan.levelBarriers[0].empty());
+    CHECK(plan.levelBarriers[1].empty());
+    CHECK(plan.exitBarriers.empty());
+}
+
+int main()
+{
+    return UnitTest::Run({
+        { "StateTracking", TestStateTracking },
+        { "StatesCarryAcrossFrames", TestStatesCarryAcrossFrames },
+        { "EmptyGraph", TestEmptyGraph },
+        { "ReadWriteConflict", TestReadWriteConflict },
+        { "ReadAfterWrite", TestReadAfterWrite },
+        { "HistoryPingPong", TestHistoryPingPong },
+        { "Aliasing", TestAliasing },
+        { "SplitPlacement", TestSplitPlacement },
+        { "NoRedundantTransitions", TestNoRedundantTransitions },
+    });
+}
@@ -0,0 +1,186 @@
+#include <RenderGraphRecorder.h>
+#include <SyntheticRenderGraph.h>
+
+#ifdef HAVE_TASKFLOW
+#include <taskflow/taskflow.hpp>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+
+using namespace ICR;
+
+// Measures the per-frame CPU cost of dispatching a render graph the way the renderer does, without a device: the barrier plan
+// compiled from the schedule's levels, and the levels recorded in parallel into command lists from the per-thread cache, with
+// stub command lists and dispatches. With Taskflow available, the executor per frame the renderer used before (tasks of the
+// passes serialized on a mutex) is measured next to it. Prints the average over a number of frames (first argument, 1000 by
+// default) per graph size.
+
+constexpr uint64_t kFramesInFlight = 2u;
+
+// Keeps what the device would record, so that the recording is not optimized away.
+struct StubCommandList
+{
+    std::vector<uint32_t> barrierResources;
+    uint32_t              dispatchCount = 0u;
+    bool                  open          = false;
+};
+
+class StubCommandListFactory : public CommandListFactory<StubCommandList>
+{
+public:
+
+    void Create(StubCommandList& commandList) override { Reset(commandList); }
+
+    void Reset(StubCommandList& commandList) override
+    {
+        commandList.barrierResources.clear();
+        commandList.dispatchCount = 0u;
+        commandList.open          = true;
+    }
+};
+
+class StubLevelRecorder : public LevelRecorder<StubCommandList>
+{
+public:
+
+    StubLevelRecorder(const std::vector<std::vector<size_t>>& levels, std::atomic<uint64_t>& dispatchCount) :
+        mLevels(levels),
+        mDispatchCount(dispatchCount)
+    {}
+
+    void Begin(StubCommandList&) override {}
+
+    void RecordAliasing(StubCommandList& commandList, const std::vector<uint32_t>& resources) override
+    {
+        commandList.barrierResources.insert(commandList.barrierResources.end(), resources.begin(), resources.end());
+    }
+
+    // A batch translated into device barriers, as the renderer does.
+    void RecordBarriers(StubCommandList& commandList, const std::vector<ResourceBarrier>& barriers) override
+    {
+        for (const auto& barrier : barriers)
+            commandList.barrierResources.push_back(barrier.resource);
+    }
+
+    void RecordDiscards(StubCommandList&, const std::vector<uint32_t>&) override {}
+
+    void RecordPasses(StubCommandList& commandList, size_t levelIndex) override
+    {
+        commandList.dispatchCount += static_cast<uint32_t>(mLevels[levelIndex].size());
+
+        mDispatchCount.fetch_add(mLevels[levelIndex].size(), std::memory_order_relaxed);
+    }
+
+    void End(StubCommandList& commandList) override { commandList.open = false; }
+
+private:
+
+    const std::vector<std::vector<size_t>>& mLevels;
+    std::atomic<uint64_t>&                  mDispatchCount;
+};
+
+int main(int argc, char** argv)
+{
+    const int frameCount = argc > 1 ? std::max(std::atoi(argv[1]), 1) : 1000;
+
+    std::printf("%8s %8s %14s %14s %14s\n", "Passes", "Levels", "Executor (ms)", "Schedule (ms)", "Lists");
+
+    for (uint32_t passCount : { 1u, 5u, 20u, 64u, 256u })
+    {
+        const auto passes = CreateSyntheticGraph(passCount, passCount);
+
+        const RenderGraphSchedule schedule(passes);
+
+        std::atomic<uint64_t> dispatchCount = 0u;
+
+        // Executor
+        // ------------------------------------------------
+
+#ifdef HAVE_TASKFLOW
+        double executorMs;
+        {
+            std::mutex   commandMutex;
+            tf::Taskflow taskflow;
+
+            std::vector<tf::Task> tasks;
+
+            for (size_t passIndex = 0u; passIndex < passes.size(); passIndex++)
+            {
+                tasks.push_back(taskflow.emplace(
+                    [&]()
+                    {
+                        std::lock_guard<std::mutex> commandLock(commandMutex);
+                        dispatchCount.fetch_add(1u, std::memory_order_relaxed);
+                    }));
+            }
+
+            for (size_t levelIndex = 1u; levelIndex < schedule.GetLevels().size(); levelIndex++)
+            {
+                for (auto passIndex : schedule.GetLevels()[levelIndex])
+                {
+                    for (auto previousPassIndex : schedule.GetLevels()[levelIndex - 1u])
+                        tasks[previousPassIndex].precede(tasks[passIndex]);
+                }
+            }
+
+            auto start = std::chrono::steady_clock::now();
+
+            for (int frame = 0; frame < frameCount; frame++)
+            {
+                tf::Executor executor;
+                executor.run(taskflow).wait();
+            }
+
+            executorMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frameCount;
+        }
+#endif
+
+        // Schedule, planned and recorded every frame.
+        // ------------------------------------------------
+
+        const auto levelAccesses = CreateLevelAccesses(passes, schedule);
+
+        RenderGraphCompiler compiler;
+
+        StubCommandListFactory            factory;
+        CommandListCache<StubCommandList> cache(&factory);
+        StubLevelRecorder                 recorder(schedule.GetLevels(), dispatchCount);
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (int frame = 0; frame < frameCount; frame++)
+        {
+            const uint64_t fenceValue = static_cast<uint64_t>(frame) + 1u;
+
+            const auto plan = compiler.Compile(levelAccesses, { passCount - 1u });
+
+            const auto levelCommandLists = RecordLevels(cache,
+                                                        recorder,
+                                                        plan,
+                                                        0u,
+                                                        schedule.GetLevels().size(),
+                                                        true,
+                                                        fenceValue > kFramesInFlight ? fenceValue - kFramesInFlight : 0u);
+
+            if (levelCommandLists.size() != schedule.GetLevels().size())
+                return EXIT_FAILURE;
+
+            cache.Retire(fenceValue);
+        }
+
+        const double scheduleMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frameCount;
+
+#ifdef HAVE_TASKFLOW
+        std::printf("%8u %8zu %14.4f %14.4f %14u\n", passCount, schedule.GetLevels().size(), executorMs, scheduleMs, cache.GetCommandListCount());
+#else
+        std::printf("%8u %8zu %14s %14.4f %14u\n", passCount, schedule.GetLevels().size(), "-", scheduleMs, cache.GetCommandListCount());
+#endif
+    }
+
+    return 0;
+}
@@ -0,0 +1,291 @@
+#include <RenderGraphSchedule.h>
+#include <UnitTest.h>
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+
+using namespace ICR;
+
+// Levels
+// -------------------------------------------------
+
+static void TestLevels()
+{
+    // Two independent producers, a pass combining them and the final pass reading the combination and the first producer.
+    RenderGraphSchedule schedule({ { 10, {} }, { 11, {} }, { 12, { 10, 11 } }, { 13, { 12, 10 }, true } });
+
+    const std::vector<std::vector<size_t>> expectedLevels = { { 0, 1 }, { 2 }, { 3 } };
+
+    CHECK(schedule.GetLevels() == expectedLevels);
+    CHECK(schedule.GetCulledPasses().empty());
+
+    for (const auto& historyInputIDs : schedule.GetHistoryInputIDs())
+        CHECK(historyInputIDs.empty());
+}
+
+static void TestFinalPassRunsLast()
+{
+    // Declared first, the final pass still executes after the pass it reads from, which is a dependency and not history.
+    RenderGraphSchedule schedule({ { 20, { 21 }, true }, { 21, {} } });
+
+    const std::vector<std::vector<size_t>> expectedLevels = { { 1 }, { 0 } };
+
+    CHECK(schedule.GetLevels() == expectedLevels);
+    CHECK(!schedule.IsHistoryInput(0, 21));
+}
+
+static void TestExternalInputsIgnored()
+{
+    // Media and other inputs no pass writes are not part of the schedule.
+    RenderGraphSchedule schedule({ { 1, { 99, 98 }, true } });
+
+    const std::vector<std::vector<size_t>> expectedLevels = { { 0 } };
+
+    CHECK(schedule.GetLevels() == expectedLevels);
+    CHECK(schedule.GetHistoryInputIDs()[0].empty());
+}
+
+static void TestInvalidDeclarations()
+{
+    CHECK_THROWS(RenderGraphSchedule({ { 1, {} }, { 1, {} } }), std::runtime_error);
+    CHECK_THROWS(RenderGraphSchedule({ { 1, {}, true }, { 2, {}, true } }), std::runtime_error);
+}
+
+// History and self-reference rules
+// -------------------------------------------------
+
+static void TestSelfReference()
+{
+    // An accumulation buffer reading its own previous frame, presented by the final pass.
+    RenderGraphSchedule schedule({ { 1, { 1 } }, { 2, { 1 }, true } });
+
+    const std::vector<std::vector<size_t>> expectedLevels = { { 0 }, { 1 } };
+
+    CHECK(schedule.GetLevels() == expectedLevels);
+    CHECK(schedule.GetHistoryInputIDs()[0] == std::vector<int>({ 1 }));
+    CHECK(schedule.IsHistoryInput(0, 1));
+    CHECK(!schedule.IsHistoryInput(1, 1));
+}
+
+static void TestReadBeforeWrite()
+{
+    // Pass 0 reads the output of pass 1, which only runs after it: that is last frame's output. Pass 1 reading pass 0 is a
+    // regular dependency.
+    RenderGraphSchedule schedule({ { 1, { 2 } }, { 2, { 1 } }, { 3, { 2 }, true } });
+
+    const std::vector<std::vector<size_t>> expectedLevels = { { 0 }, { 1 }, { 2 } };
+
+    CHECK(schedule.GetLevels() == expectedLevels);
+    CHECK(schedule.IsHistoryInput(0, 2));
+    CHECK(!schedule.IsHistoryInput(1, 1));
+    CHECK(!schedule.IsHistoryInput(2, 2));
+}
+
+static void TestFinalOutputReadAsHistory()
+{
+    // A buffer pass reading the presented image of the previous frame.
+    RenderGraphSchedule schedule({ { 1, { 2 }, true }, { 2, { 1 } } });
+
+    const std::vector<std::vector<size_t>> expectedLevels = { { 1 }, { 0 } };
+
+    CHECK(schedule.GetLevels() == expectedLevels);
+    CHECK(schedule.IsHistoryInput(1, 1));
+    CHECK(!schedule.IsHistoryInput(0, 2));
+    CHECK(schedule.GetLifetimes()[0].history);
+}
+
+// Culling
+// -------------------------------------------------
+
+static void TestCulling()
+{
+    // Pass 0 only feeds itself, pass 1 feeds nothing at all, pass 2 and 3 reach the final pass.
+    RenderGraphSchedule schedule({ { 1, { 1 } }, { 2, { 3 } }, { 3, {} }, { 4, { 3 }, true } });
+
+    const std::vector<std::vector<size_t>> expectedLevels = { { 2 }, { 3 } };
+
+    CHECK(schedule.GetLevels() == expectedLevels);
+    CHECK(schedule.GetCulledPasses() == std::vector<size_t>({ 0, 1 }));
+    CHECK(schedule.IsCulled(0));
+    CHECK(schedule.IsCulled(1));
+    CHECK(!schedule.IsCulled(2));
+    CHECK(!schedule.IsCulled(3));
+}
+
+static void TestHistoryEdgesKeepPassesAlive()
+{
+    // Pass 1 runs after pass 0 and is only read by it through history, that still reaches the final pass.
+    RenderGraphSchedule schedule({ { 1, { 2 } }, { 2, {} }, { 3, { 1 }, true } });
+
+    const std::vector<std::vector<size_t>> expectedLevels = { { 0, 1 }, { 2 } };
+
+    CHECK(schedule.GetLevels() == expectedLevels);
+    CHECK(schedule.GetCulledPasses().empty());
+    CHECK(schedule.GetLifetimes()[1].history);
+}
+
+static void TestNoFinalPass()
+{
+    // Without a final pass there is nothing to walk back from, everything runs.
+    RenderGraphSchedule schedule({ { 1, {} }, { 2, { 1 } } });
+
+    const std::vector<std::vector<size_t>> expectedLevels = { { 0 }, { 1 } };
+
+    CHECK(schedule.GetLevels() == expectedLevels);
+    CHECK(schedule.GetCulledPasses().empty());
+}
+
+// Lifetimes
+// -------------------------------------------------
+
+static void TestLifetimes()
+{
+    RenderGraphSchedule schedule({ { 10, {} }, { 11, {} }, { 12, { 10, 11 } }, { 13, { 12, 10 }, true } });
+
+    const auto& lifetimes = schedule.GetLifetimes();
+
+    // Written in level 0, last read by the final pass in level 2.
+    CHECK(!lifetimes[0].history);
+    CHECK(lifetimes[0].firstLevel == 0u);
+    CHECK(lifetimes[0].lastLevel == 2u);
+
+    CHECK(lifetimes[1].firstLevel == 0u);
+    CHECK(lifetimes[1].lastLevel == 1u);
+
+    CHECK(lifetimes[2].firstLevel == 1u);
+    CHECK(lifetimes[2].lastLevel == 2u);
+
+    // The final output is read after the graph.
+    CHECK(lifetimes[3].firstLevel == 2u);
+    CHECK(lifetimes[3].lastLevel == schedule.GetLevels().size());
+}
+
+static void TestHistoryLifetimes()
+{
+    // Read through history only: the output outlives the frame, but no level of this frame reads it after it was written.
+    RenderGraphSchedule schedule({ { 1, { 2 } }, { 2, {} }, { 3, { 1 }, true } });
+
+    const auto& lifetimes = schedule.GetLifetimes();
+
+    CHECK(lifetimes[1].history);
+    CHECK(lifetimes[1].firstLevel == 0u);
+    CHECK(lifetimes[1].lastLevel == 0u);
+
+    // Read through history by itself and within the frame by the final pass, both apply.
+    RenderGraphSchedule accumulation({ { 1, { 1 } }, { 2, {} }, { 3, { 2, 1 }, true } });
+
+    const auto& accumulationLifetimes = accumulation.GetLifetimes();
+
+    CHECK(accumulationLifetimes[0].history);
+    CHECK(accumulationLifetimes[0].firstLevel == 0u);
+    CHECK(accumulationLifetimes[0].lastLevel == 1u);
+    CHECK(!accumulationLifetimes[1].history);
+}
+
+// Transient placement
+// -------------------------------------------------
+
+static void TestPlacementOverlap()
+{
+    // Alive at the same time, so they must not share memory. The second one is pushed past the first, aligned.
+    std::vector<TransientAllocation> allocations = { { 100u, 0u, 1u, 0u }, { 50u, 1u, 2u, 0u } };
+
+    const uint64_t heapSize = PlaceTransientAllocations(allocations, 64u);
+
+    CHECK(allocations[0].heapOffset == 0u);
+    CHECK(allocations[1].heapOffset == 128u);
+    CHECK(heapSize == 178u);
+}
+
+static void TestPlacementAliasing()
+{
+    // Disjoint lifetimes share the same memory.
+    std::vector<TransientAllocation> allocations = { { 100u, 0u, 0u, 0u }, { 100u, 1u, 1u, 0u }, { 60u, 2u, 3u, 0u } };
+
+    const uint64_t heapSize = PlaceTransientAllocations(allocations, 64u);
+
+    for (const auto& allocation : allocations)
+        CHECK(allocation.heapOffset == 0u);
+
+    CHECK(heapSize == 100u);
+}
+
+static void TestPlacementLargestFirst()
+{
+    // The long-lived allocation overlaps both short ones, which alias each other at offset zero since they are larger.
+    std::vector<TransientAllocation> allocations = { { 128u, 0u, 1u, 0u }, { 256u, 0u, 0u, 0u }, { 256u, 1u, 1u, 0u } };
+
+    const uint64_t heapSize = PlaceTransientAllocations(allocations, 256u);
+
+    CHECK(allocations[1].heapOffset == 0u);
+    CHECK(allocations[2].heapOffset == 0u);
+    CHECK(allocations[0].heapOffset == 256u);
+    CHECK(heapSize == 384u);
+}
+
+static void TestPlacementRandom()
+{
+    constexpr uint64_t kAlignment = 64u * 1024u;
+
+    std::mt19937 random(0u);
+
+    for (int graph = 0; graph < 100; graph++)
+    {
+        std::vector<TransientAllocation> allocations(1u + random() % 32u);
+
+        uint64_t totalSize = 0u;
+
+        for (auto& allocation : allocations)
+        {
+            allocation.size       = (1u + random() % 64u) * kAlignment - random() % kAlignment;
+            allocation.firstLevel = random() % 8u;
+            allocation.lastLevel  = allocation.firstLevel + random() % 4u;
+
+            totalSize += allocation.size + kAlignment;
+        }
+
+        const uint64_t heapSize = PlaceTransientAllocations(allocations, kAlignment);
+
+        CHECK(heapSize <= totalSize);
+
+        for (size_t a = 0u; a < allocations.size(); a++)
+        {
+            CHECK(allocations[a].heapOffset % kAlignment == 0u);
+            CHECK(allocations[a].heapOffset + allocations[a].size <= heapSize);
+
+            for (size_t b = a + 1u; b < allocations.size(); b++)
+            {
+                const bool overlapsInTime = allocations[a].firstLevel <= allocations[b].lastLevel &&
+                                            allocations[b].firstLevel <= allocations[a].lastLevel;
+
+                const bool overlapsInMemory = allocations[a].heapOffset < allocations[b].heapOffset + allocations[b].size &&
+                                              allocations[b].heapOffset < allocations[a].heapOffset + allocations[a].size;
+
+                CHECK(!(overlapsInTime && overlapsInMemory));
+            }
+        }
+    }
+}
+
+int main()
+{
+    return UnitTest::Run({
+        { "Levels", TestLevels },
+        { "FinalPassRunsLast", TestFinalPassRunsLast },
+        { "ExternalInputsIgnored", TestExternalInputsIgnored },
+        { "InvalidDeclarations", TestInvalidDeclarations },
+        { "SelfReference", TestSelfReference },
+        { "ReadBeforeWrite", TestReadBeforeWrite },
+        { "FinalOutputReadAsHistory", TestFinalOutputReadAsHistory },
+        { "Culling", TestCulling },
+        { "HistoryEdgesKeepPassesAlive", TestHistoryEdgesKeepPassesAlive },
+        { "NoFinalPass", TestNoFinalPass },
+        { "Lifetimes", TestLifetimes },
+        { "HistoryLifetimes", TestHistoryLifetimes },
+        { "PlacementOverlap", TestPlacementOverlap },
+        { "PlacementAliasing", TestPlacementAliasing },
+        { "PlacementLargestFirst", TestPlacementLargestFirst },
+        { "PlacementRandom", TestPlacementRandom },
+    });
+}
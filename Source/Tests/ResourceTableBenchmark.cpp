@@ -0,0 +1,127 @@
+#include <MockResourceFactory.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+using namespace ICR;
+
+// Measures the allocation throughput of the resource registry's bookkeeping without a device: batches of handles allocated and
+// freed from several threads at once, through the locked free list the registry used before, the slot allocator alone, and the
+// whole table (slots, descriptor views and memory accounting) with mock resources. Prints millions of allocations per second
+// per thread count, the first argument is the number of allocations per thread (100000 by default).
+
+constexpr uint32_t kCapacity  = 1024u;
+constexpr uint32_t kBatchSize = 32u;
+
+static double MeasureMillionsPerSecond(uint32_t                                    threadCount,
+                                       uint32_t                                    iterationsPerThread,
+                                       const std::function<uint32_t()>&            Allocate,
+                                       const std::function<void(uint32_t handle)>& Free)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+
+    for (uint32_t threadIndex = 0u; threadIndex < threadCount; threadIndex++)
+    {
+        threads.emplace_back(
+            [&]()
+            {
+                uint32_t handles[kBatchSize];
+
+                for (uint32_t iteration = 0u; iteration < iterationsPerThread; iteration += kBatchSize)
+                {
+                    for (auto& handle : handles)
+                        handle = Allocate();
+
+                    for (auto handle : handles)
+                        Free(handle);
+                }
+            });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    return static_cast<double>(threadCount) * iterationsPerThread / seconds / 1e6;
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t iterationsPerThread = argc > 1 ? static_cast<uint32_t>(std::max(std::atoi(argv[1]), 1)) : 100000u;
+    const uint32_t maxThreadCount      = std::clamp(std::thread::hardware_concurrency(), 1u, kCapacity / kBatchSize);
+
+    std::printf("%8s %16s %16s %16s\n", "Threads", "Locked (M/s)", "Slots (M/s)", "Table (M/s)");
+
+    for (uint32_t threadCount = 1u; threadCount <= maxThreadCount; threadCount *= 2u)
+    {
+        // Locked free list
+        // ------------------------------------------------
+
+        std::mutex           freeIndicesMutex;
+        std::queue<uint32_t> freeIndices;
+
+        for (uint32_t index = 0u; index < kCapacity; index++)
+            freeIndices.push(index);
+
+        const double lockedMillions = MeasureMillionsPerSecond(
+            threadCount,
+            iterationsPerThread,
+            [&]()
+            {
+                std::lock_guard<std::mutex> freeIndicesLock(freeIndicesMutex);
+
+                const uint32_t index = freeIndices.front();
+                freeIndices.pop();
+
+                return index;
+            },
+            [&](uint32_t index)
+            {
+                std::lock_guard<std::mutex> freeIndicesLock(freeIndicesMutex);
+                freeIndices.push(index);
+            });
+
+        // Slot allocator
+        // ------------------------------------------------
+
+        SlotAllocator slots(kCapacity);
+
+        const double slotMillions = MeasureMillionsPerSecond(
+            threadCount,
+            iterationsPerThread,
+            [&]() { return slots.Allocate(); },
+            [&](uint32_t handle) { slots.Free(handle); });
+
+        // Table, a texture view per resource and released right away, as the free lists above.
+        // ------------------------------------------------
+
+        MockResourceFactory         factory;
+        ResourceTable<MockResource> table(kCapacity, &factory);
+
+        const double tableMillions = MeasureMillionsPerSecond(
+            threadCount,
+            iterationsPerThread,
+            [&]() { return table.Add({}, 1u << static_cast<uint32_t>(ResourceView::Texture2D), MemoryCategory::Other, 1u).indexResource; },
+            [&](uint32_t handle)
+            {
+                ResourceHandle resourceHandle;
+                resourceHandle.indexResource = handle;
+
+                table.ReleaseImmediate(resourceHandle);
+            });
+
+        std::printf("%8u %16.2f %16.2f %16.2f\n", threadCount, lockedMillions, slotMillions, tableMillions);
+    }
+
+    return 0;
+}
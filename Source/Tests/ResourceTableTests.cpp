@@ -0,0 +1,418 @@
+#include <MockResourceFactory.h>
+#include <UnitTest.h>
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+using namespace ICR;
+
+constexpr uint32_t kViewMaskAll = (1u << kResourceViewCount) - 1u;
+
+static uint32_t ViewBit(ResourceView view) { return 1u << static_cast<uint32_t>(view); }
+
+// Handles
+// -------------------------------------------------
+
+static void TestAddAndGet()
+{
+    MockResourceFactory         factory;
+    ResourceTable<MockResource> table(16u, &factory);
+
+    const auto handle = table.Add({ 7u, 0u }, ViewBit(ResourceView::Texture2D) | ViewBit(ResourceView::Constants), MemoryCategory::Media, 256u);
+
+    CHECK(table.Get(handle).serial == 7u);
+    CHECK(table.GetMemorySize(handle) == 256u);
+    CHECK(table.GetLiveCount() == 1u);
+
+    // Only the requested views.
+    CHECK(handle.indexDescriptorTexture2D != UINT32_MAX);
+    CHECK(handle.indexDescriptorRenderTarget == UINT32_MAX);
+    CHECK(handle.indexDescriptorConstants != UINT32_MAX);
+    CHECK(factory.IsAllocated(ResourceView::Texture2D, handle.indexDescriptorTexture2D));
+    CHECK(factory.IsAllocated(ResourceView::Constants, handle.indexDescriptorConstants));
+    CHECK(factory.GetUsedCount(ResourceView::RenderTarget) == 0u);
+}
+
+static void TestStaleHandles()
+{
+    MockResourceFactory         factory;
+    ResourceTable<MockResource> table(1u, &factory);
+
+    CHECK_THROWS(table.Get(ResourceHandle()), std::runtime_error);
+
+    const auto handle = table.Add({ 1u, 0u }, 0u, MemoryCategory::Other, 0u);
+
+    table.Release(handle);
+
+    CHECK_THROWS(table.Get(handle), std::runtime_error);
+    CHECK_THROWS(table.Release(handle), std::runtime_error);
+    CHECK_THROWS(table.ReleaseImmediate(handle), std::runtime_error);
+    CHECK_THROWS(table.SetMemoryCategory(handle, MemoryCategory::History), std::runtime_error);
+
+    // The only slot is handed out again, the old handle still does not match it.
+    const auto reusedHandle = table.Add({ 2u, 0u }, 0u, MemoryCategory::Other, 0u);
+
+    CHECK(SlotAllocator::GetIndex(reusedHandle.indexResource) == SlotAllocator::GetIndex(handle.indexResource));
+    CHECK(table.Get(reusedHandle).serial == 2u);
+    CHECK_THROWS(table.Get(handle), std::runtime_error);
+}
+
+static void TestCapacity()
+{
+    MockResourceFactory         factory;
+    ResourceTable<MockResource> table(2u, &factory);
+
+    table.Add({}, 0u, MemoryCategory::Other, 0u);
+    table.Add({}, 0u, MemoryCategory::Other, 0u);
+
+    CHECK_THROWS(table.Add({}, 0u, MemoryCategory::Other, 0u), std::runtime_error);
+}
+
+// Releases
+// -------------------------------------------------
+
+static void TestDeferredRelease()
+{
+    MockResourceFactory         factory;
+    ResourceTable<MockResource> table(16u, &factory);
+
+    const auto handle = table.Add({ 1u, 0u }, kViewMaskAll, MemoryCategory::History, 1000u);
+
+    table.Release(handle);
+
+    // The handle is retired right away, the resource, its descriptors and its memory stay until the GPU is done with it.
+    CHECK(table.GetLiveCount() == 0u);
+    CHECK(factory.GetDestroyedCount() == 0u);
+    CHECK(factory.IsAllocated(ResourceView::RenderTarget, handle.indexDescriptorRenderTarget));
+    CHECK(table.GetMemoryStats().trackedBytes == 1000u);
+    CHECK(table.GetDeferredReleaseStats().pendingCount == 1u);
+    CHECK(table.GetDeferredReleaseStats().pendingBytes == 1000u);
+
+    // Released while frame 4 may still be in flight, so tagged with the next value signaled, 5.
+    table.ProcessDeferredReleases(3u, 5u);
+    table.ProcessDeferredReleases(4u, 6u);
+
+    CHECK(factory.GetDestroyedCount() == 0u);
+
+    // Released after the first one was tagged, tagged with a later value.
+    const auto laterHandle = table.Add({ 2u, 0u }, ViewBit(ResourceView::Texture2D), MemoryCategory::History, 500u);
+
+    table.Release(laterHandle);
+    table.ProcessDeferredReleases(5u, 7u);
+
+    CHECK(factory.GetDestroyedCount() == 1u);
+    CHECK(!factory.IsAllocated(ResourceView::RenderTarget, handle.indexDescriptorRenderTarget));
+    CHECK(factory.IsAllocated(ResourceView::Texture2D, laterHandle.indexDescriptorTexture2D));
+    CHECK(table.GetMemoryStats().trackedBytes == 500u);
+
+    auto deferredReleaseStats = table.GetDeferredReleaseStats();
+
+    CHECK(deferredReleaseStats.pendingCount == 1u);
+    CHECK(deferredReleaseStats.reclaimedCount == 1u);
+    CHECK(deferredReleaseStats.reclaimedBytes == 1000u);
+
+    table.FlushDeferredReleases();
+
+    deferredReleaseStats = table.GetDeferredReleaseStats();
+
+    CHECK(factory.GetDestroyedCount() == 2u);
+    CHECK(deferredReleaseStats.pendingCount == 0u);
+    CHECK(deferredReleaseStats.reclaimedBytes == 1500u);
+
+    for (size_t viewIndex = 0u; viewIndex < kResourceViewCount; viewIndex++)
+        CHECK(factory.GetUsedCount(static_cast<ResourceView>(viewIndex)) == 0u);
+}
+
+static void TestReleaseImmediate()
+{
+    MockResourceFactory         factory;
+    ResourceTable<MockResource> table(16u, &factory);
+
+    const auto handle = table.Add({ 1u, 0u }, kViewMaskAll, MemoryCategory::SwapChain, 64u);
+
+    table.ReleaseImmediate(handle);
+
+    CHECK(factory.GetDestroyedCount() == 1u);
+    CHECK(table.GetDeferredReleaseStats().pendingCount == 0u);
+    CHECK(table.GetMemoryStats().trackedBytes == 0u);
+
+    for (size_t viewIndex = 0u; viewIndex < kResourceViewCount; viewIndex++)
+        CHECK(factory.GetUsedCount(static_cast<ResourceView>(viewIndex)) == 0u);
+}
+
+static void TestEveryViewCombination()
+{
+    MockResourceFactory         factory;
+    ResourceTable<MockResource> table(256u, &factory);
+
+    // Every combination of the registry's descriptor heap flags, the bits past the views (raw buffers, samplers) have none.
+    constexpr uint32_t kFlagsCombinationCount = 1u << 5u;
+    constexpr uint32_t kResourcesPerFlags     = 4u;
+
+    std::vector<ResourceHandle> handles;
+
+    for (uint32_t flags = 0u; flags < kFlagsCombinationCount; flags++)
+    {
+        for (uint32_t resourceIndex = 0u; resourceIndex < kResourcesPerFlags; resourceIndex++)
+            handles.push_back(table.Add({ flags, 0u }, flags, MemoryCategory::PassOutputs, 16u));
+    }
+
+    // A view per flag set, for half of the combinations each.
+    for (size_t viewIndex = 0u; viewIndex < kResourceViewCount; viewIndex++)
+        CHECK(factory.GetUsedCount(static_cast<ResourceView>(viewIndex)) == kFlagsCombinationCount / 2u * kResourcesPerFlags);
+
+    for (const auto& handle : handles)
+        table.Release(handle);
+
+    table.ProcessDeferredReleases(0u, 1u);
+    table.ProcessDeferredReleases(1u, 2u);
+
+    // Nothing leaks, in any heap.
+    for (size_t viewIndex = 0u; viewIndex < kResourceViewCount; viewIndex++)
+        CHECK(factory.GetUsedCount(static_cast<ResourceView>(viewIndex)) == 0u);
+
+    CHECK(factory.GetDestroyedCount() == handles.size());
+    CHECK(table.GetMemoryStats().trackedBytes == 0u);
+    CHECK(table.GetDeferredReleaseStats().pendingCount == 0u);
+}
+
+static void TestHandlelessReleases()
+{
+    MockResourceFactory         factory;
+    ResourceTable<MockResource> table(16u, &factory);
+
+    // A heap resources are placed into, accounted from its creation on.
+    table.TrackMemory(MemoryCategory::PassOutputs, 4096u);
+    table.Release(MockResource { 1u, 0u }, MemoryCategory::PassOutputs, 4096u);
+
+    // A descriptor table.
+    const uint32_t firstIndex = factory.AllocateTable(ResourceView::Texture2D, 8u);
+
+    table.ReleaseDescriptorTable(ViewBit(ResourceView::Texture2D), firstIndex, 8u);
+
+    CHECK(table.GetDeferredReleaseStats().pendingCount == 2u);
+    CHECK(table.GetDeferredReleaseStats().pendingBytes == 4096u);
+    CHECK(factory.GetUsedCount(ResourceView::Texture2D) == 8u);
+
+    table.ProcessDeferredReleases(0u, 1u);
+    table.ProcessDeferredReleases(1u, 2u);
+
+    const auto memoryStats = table.GetMemoryStats();
+
+    // Only the heap is a resource, the table carries no memory.
+    CHECK(factory.GetDestroyedCount() == 1u);
+    CHECK(factory.GetUsedCount(ResourceView::Texture2D) == 0u);
+    CHECK(memoryStats.trackedBytes == 0u);
+    CHECK(memoryStats.categories[static_cast<size_t>(MemoryCategory::PassOutputs)].count == 0u);
+    CHECK(memoryStats.categories[static_cast<size_t>(MemoryCategory::PassOutputs)].peakBytes == 4096u);
+}
+
+// Memory accounting
+// -------------------------------------------------
+
+static void TestMemoryAccounting()
+{
+    MockResourceFactory         factory;
+    ResourceTable<MockResource> table(16u, &factory);
+
+    auto GetCategoryStats = [&](MemoryCategory category) { return table.GetMemoryStats().categories[static_cast<size_t>(category)]; };
+
+    table.SetMemoryScope("First");
+
+    const auto first  = table.Add({}, 0u, MemoryCategory::PassOutputs, 100u);
+    const auto second = table.Add({}, 0u, MemoryCategory::PassOutputs, 300u);
+
+    CHECK(GetCategoryStats(MemoryCategory::PassOutputs).count == 2u);
+    CHECK(GetCategoryStats(MemoryCategory::PassOutputs).bytes == 400u);
+
+    // Handed over to another use, the memory follows.
+    table.SetMemoryCategory(second, MemoryCategory::History);
+
+    CHECK(GetCategoryStats(MemoryCategory::PassOutputs).bytes == 100u);
+    CHECK(GetCategoryStats(MemoryCategory::PassOutputs).peakBytes == 400u);
+    CHECK(GetCategoryStats(MemoryCategory::History).bytes == 300u);
+
+    table.ReleaseImmediate(first);
+    table.ReleaseImmediate(second);
+
+    table.SetMemoryScope("Second");
+
+    const auto third = table.Add({}, 0u, MemoryCategory::Media, 50u);
+
+    table.SetMemoryScope("");
+
+    // Outside of any scope.
+    const auto fourth = table.Add({}, 0u, MemoryCategory::Media, 1000u);
+
+    const auto memoryStats      = table.GetMemoryStats();
+    const auto memoryScopePeaks = table.GetMemoryScopePeaks();
+
+    CHECK(memoryStats.trackedBytes == 1050u);
+    CHECK(memoryStats.peakTrackedBytes == 1050u);
+    CHECK(memoryScopePeaks.at("First") == 400u);
+    CHECK(memoryScopePeaks.at("Second") == 50u);
+
+    table.ReleaseImmediate(third);
+    table.ReleaseImmediate(fourth);
+
+    CHECK(table.GetMemoryStats().trackedBytes == 0u);
+}
+
+static void TestForEachLive()
+{
+    MockResourceFactory         factory;
+    ResourceTable<MockResource> table(16u, &factory);
+
+    const auto leaked   = table.Add({ 1u, 0u }, 0u, MemoryCategory::Media, 10u);
+    const auto released = table.Add({ 2u, 0u }, 0u, MemoryCategory::Media, 20u);
+
+    table.Release(released);
+
+    uint32_t liveCount = 0u;
+
+    table.ForEachLive(
+        [&](const MockResource& resource, MemoryCategory category, uint64_t size)
+        {
+            CHECK(resource.serial == 1u);
+            CHECK(category == MemoryCategory::Media);
+            CHECK(size == 10u);
+
+            liveCount++;
+        });
+
+    CHECK(liveCount == 1u);
+    CHECK(table.Get(leaked).serial == 1u);
+}
+
+// Concurrency
+// -------------------------------------------------
+
+static void TestConcurrentAddRelease()
+{
+    constexpr uint32_t kCapacity            = 1024u;
+    constexpr uint32_t kIterationsPerThread = 20000u;
+
+    const uint32_t threadCount = std::clamp(std::thread::hardware_concurrency(), 2u, 16u);
+
+    MockResourceFactory         factory;
+    ResourceTable<MockResource> table(kCapacity, &factory);
+
+    std::atomic<uint64_t> serial            = 0u;
+    std::atomic<uint32_t> createdCount      = 0u;
+    std::atomic<uint32_t> ownershipErrors   = 0u;
+    std::atomic<uint32_t> staleHandleErrors = 0u;
+
+    // Each thread creates and releases at random, verifying that nobody else touched its resources and descriptors, and that
+    // its released handles are rejected even once their slot is handed out again. Checks are counted and made on the main
+    // thread, the harness is not thread-safe.
+    auto ThreadFunction = [&](uint32_t threadIndex)
+    {
+        std::vector<std::pair<ResourceHandle, uint64_t>> liveHandles;
+        std::vector<ResourceHandle>                      releasedHandles;
+        std::mt19937                                     random(threadIndex);
+
+        auto ReleaseLiveHandle = [&](size_t liveIndex)
+        {
+            auto [handle, handleSerial] = liveHandles[liveIndex];
+
+            liveHandles[liveIndex] = liveHandles.back();
+            liveHandles.pop_back();
+
+            const auto& resource = table.Get(handle);
+
+            if (resource.serial != handleSerial || resource.owner != threadIndex ||
+                !factory.IsAllocated(ResourceView::Texture2D, handle.indexDescriptorTexture2D))
+                ownershipErrors++;
+
+            if (random() % 2u == 0u)
+                table.Release(handle);
+            else
+                table.ReleaseImmediate(handle);
+
+            releasedHandles.push_back(handle);
+        };
+
+        for (uint32_t iteration = 0u; iteration < kIterationsPerThread; iteration++)
+        {
+            const bool add = liveHandles.empty() || (liveHandles.size() < kCapacity / threadCount && random() % 2u == 0u);
+
+            if (!add)
+            {
+                ReleaseLiveHandle(random() % liveHandles.size());
+                continue;
+            }
+
+            const MockResource resource = { serial.fetch_add(1u, std::memory_order_relaxed) + 1u, threadIndex };
+
+            liveHandles.push_back({ table.Add(MockResource(resource), ViewBit(ResourceView::Texture2D), MemoryCategory::Other, 1u),
+                                    resource.serial });
+
+            createdCount++;
+
+            // Every so often, one of the handles released before must be rejected.
+            if (!releasedHandles.empty() && iteration % 16u == 0u)
+            {
+                try
+                {
+                    table.Get(releasedHandles[random() % releasedHandles.size()]);
+                    staleHandleErrors++;
+                }
+                catch (const std::runtime_error&)
+                {
+                }
+            }
+        }
+
+        while (!liveHandles.empty())
+            ReleaseLiveHandle(liveHandles.size() - 1u);
+    };
+
+    // Meanwhile the render thread keeps processing the deferred releases.
+    std::atomic<bool> running = true;
+
+    std::thread renderThread(
+        [&]()
+        {
+            for (uint64_t fenceValue = 1u; running.load(); fenceValue++)
+                table.ProcessDeferredReleases(fenceValue - 1u, fenceValue);
+        });
+
+    std::vector<std::thread> threads;
+
+    for (uint32_t threadIndex = 0u; threadIndex < threadCount; threadIndex++)
+        threads.emplace_back(ThreadFunction, threadIndex);
+
+    for (auto& thread : threads)
+        thread.join();
+
+    running = false;
+    renderThread.join();
+
+    table.FlushDeferredReleases();
+
+    CHECK(ownershipErrors == 0u);
+    CHECK(staleHandleErrors == 0u);
+    CHECK(table.GetLiveCount() == 0u);
+    CHECK(factory.GetDestroyedCount() == createdCount);
+    CHECK(factory.GetUsedCount(ResourceView::Texture2D) == 0u);
+    CHECK(table.GetMemoryStats().trackedBytes == 0u);
+    CHECK(table.GetDeferredReleaseStats().pendingCount == 0u);
+}
+
+int main()
+{
+    return UnitTest::Run({
+        { "AddAndGet", TestAddAndGet },
+        { "StaleHandles", TestStaleHandles },
+        { "Capacity", TestCapacity },
+        { "DeferredRelease", TestDeferredRelease },
+        { "ReleaseImmediate", TestReleaseImmediate },
+        { "EveryViewCombination", TestEveryViewCombination },
+        { "HandlelessReleases", TestHandlelessReleases },
+        { "MemoryAccounting", TestMemoryAccounting },
+        { "ForEachLive", TestForEachLive },
+        { "ConcurrentAddRelease", TestConcurrentAddRelease },
+    });
+}
@@ -0,0 +1,181 @@
+#include <RingAllocator.h>
+#include <UnitTest.h>
+
+#include <stdexcept>
+
+using namespace ICR;
+
+// Allocation
+// -------------------------------------------------
+
+static void TestAlignment()
+{
+    RingAllocator allocator(1024u);
+
+    CHECK(allocator.Allocate(0u, 16u) == RingAllocator::kInvalidOffset);
+    CHECK(allocator.Allocate(1025u, 16u) == RingAllocator::kInvalidOffset);
+
+    CHECK(allocator.Allocate(10u, 16u) == 0u);
+    CHECK(allocator.Allocate(10u, 256u) == 256u);
+
+    // Padding counts as used.
+    CHECK(allocator.GetUsedSize() == 266u);
+    CHECK(allocator.HasPendingAllocations());
+}
+
+static void TestWrapSkipsTail()
+{
+    RingAllocator allocator(1024u);
+
+    CHECK(allocator.Allocate(600u, 1u) == 0u);
+    allocator.Submit(1u);
+
+    CHECK(allocator.Allocate(300u, 1u) == 600u);
+    allocator.Submit(2u);
+
+    allocator.Reclaim(1u);
+
+    CHECK(allocator.GetUsedSize() == 300u);
+
+    // 124 bytes are left at the end, the allocation restarts at the front and the tail end is skipped.
+    CHECK(allocator.Allocate(200u, 1u) == 0u);
+    CHECK(allocator.GetUsedSize() == 300u + 124u + 200u);
+    allocator.Submit(3u);
+
+    // The skipped tail comes back with the submission that skipped it.
+    allocator.Reclaim(2u);
+
+    CHECK(allocator.GetUsedSize() == 124u + 200u);
+
+    allocator.Reclaim(3u);
+
+    CHECK(allocator.IsIdle());
+}
+
+static void TestExactlyFull()
+{
+    RingAllocator allocator(1024u);
+
+    CHECK(allocator.Allocate(512u, 1u) == 0u);
+    allocator.Submit(1u);
+
+    CHECK(allocator.Allocate(512u, 1u) == 512u);
+    allocator.Submit(2u);
+
+    allocator.Reclaim(1u);
+
+    // Wraps into exactly the reclaimed space: head == tail with every byte used.
+    CHECK(allocator.Allocate(512u, 1u) == 0u);
+    CHECK(allocator.GetUsedSize() == allocator.GetCapacity());
+    CHECK(allocator.Allocate(1u, 1u) == RingAllocator::kInvalidOffset);
+    allocator.Submit(3u);
+
+    // Freed behind the head, the free space is [head, tail) again.
+    allocator.Reclaim(2u);
+
+    CHECK(allocator.Allocate(512u, 1u) == 512u);
+    CHECK(allocator.GetUsedSize() == allocator.GetCapacity());
+}
+
+static void TestResetOnDrain()
+{
+    RingAllocator allocator(1024u);
+
+    CHECK(allocator.Allocate(700u, 1u) == 0u);
+    allocator.Submit(1u);
+    allocator.Reclaim(1u);
+
+    CHECK(allocator.IsIdle());
+
+    // Without the restart at 0, only 324 bytes would be contiguous at the head.
+    CHECK(allocator.Allocate(1024u, 1u) == 0u);
+}
+
+static void TestLargerThanFreeSpace()
+{
+    RingAllocator allocator(1024u);
+
+    CHECK(allocator.Allocate(400u, 1u) == 0u);
+    allocator.Submit(1u);
+
+    CHECK(allocator.Allocate(400u, 1u) == 400u);
+    allocator.Submit(2u);
+
+    allocator.Reclaim(1u);
+
+    // 624 bytes are free in total, split in 224 at the end and 400 at the front, neither fits.
+    CHECK(allocator.Allocate(500u, 1u) == RingAllocator::kInvalidOffset);
+    CHECK(allocator.GetUsedSize() == 400u);
+    CHECK(!allocator.HasPendingAllocations());
+
+    // Fits once the ring drained.
+    allocator.Reclaim(2u);
+
+    CHECK(allocator.Allocate(500u, 1u) == 0u);
+}
+
+// Submissions
+// -------------------------------------------------
+
+static void TestReclaimInOrder()
+{
+    RingAllocator allocator(1024u);
+
+    allocator.Allocate(100u, 1u);
+    allocator.Submit(5u);
+
+    // Nothing pending, nothing submitted.
+    allocator.Submit(6u);
+
+    allocator.Allocate(100u, 1u);
+    allocator.Submit(7u);
+
+    allocator.Reclaim(4u);
+
+    CHECK(allocator.GetUsedSize() == 200u);
+
+    allocator.Reclaim(6u);
+
+    CHECK(allocator.GetUsedSize() == 100u);
+
+    allocator.Reclaim(7u);
+
+    CHECK(allocator.IsIdle());
+}
+
+static void TestDecreasingFenceValues()
+{
+    RingAllocator allocator(1024u);
+
+    allocator.Allocate(100u, 1u);
+    allocator.Submit(5u);
+
+    // Equal fence values are fine (several batches of a submission).
+    allocator.Allocate(100u, 1u);
+    allocator.Submit(5u);
+
+    allocator.Allocate(100u, 1u);
+
+    CHECK_THROWS(allocator.Submit(4u), std::invalid_argument);
+
+    // Still pending, and submitted with a valid fence value.
+    CHECK(allocator.HasPendingAllocations());
+
+    allocator.Submit(6u);
+    allocator.Reclaim(6u);
+
+    CHECK(allocator.IsIdle());
+}
+
+int main()
+{
+    return UnitTest::Run({
+        { "Alignment", TestAlignment },
+        { "WrapSkipsTail", TestWrapSkipsTail },
+        { "ExactlyFull", TestExactlyFull },
+        { "ResetOnDrain", TestResetOnDrain },
+        { "LargerThanFreeSpace", TestLargerThanFreeSpace },
+        { "ReclaimInOrder", TestReclaimInOrder },
+        { "DecreasingFenceValues", TestDecreasingFenceValues },
+    });
+}
@@ -0,0 +1,223 @@
+#include <UploadQueue.h>
+#include <State.h>
+
+namespace ICR
+{
+    UploadQueue::UploadQueue(uint64_t initialStagingCapacity) : mFenceValue(0u), mpCommandList(nullptr), mStats()
+    {
+        D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+        {
+            queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+            queueDesc.Type  = D3D12_COMMAND_LIST_TYPE_COPY;
+        }
+
+        // The copy engine runs next to graphics work, fall back to the graphics queue without one.
+        if (FAILED(gLogicalDevice->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&mQueue))))
+        {
+            spdlog::warn("UploadQueue: No copy queue available, uploading on the graphics queue.");
+
+            queueDesc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+            mQueue         = gCommandQueue;
+        }
+        else
+            SetDebugName(mQueue.Get(), L"UploadQueue");
+
+        mContexts = std::make_unique<ImmediateContextPool>(mQueue.Get(), queueDesc.Type);
+
+        CreateStagingBuffer(initialStagingCapacity);
+    }
+
+    UploadQueue::~UploadQueue()
+    {
+        Finish();
+
+        Reclaim();
+
+        gResourceRegistry->Get(mStagingBuffer.resource)->Unmap(0, nullptr);
+        gResourceRegistry->Release(mStagingBuffer.resource);
+    }
+
+    void UploadQueue::CreateStagingBuffer(uint64_t capacity)
+    {
+        constexpr auto kStaging = ResourceRegistry::MemoryCategory::Staging;
+
+        mStagingBuffer.resource   = gResourceRegistry->Create(CD3DX12_RESOURCE_DESC::Buffer(capacity), 0x0, true, kStaging);
+        mStagingBuffer.fenceValue = 0u;
+
+        SetDebugName(gResourceRegistry->Get(mStagingBuffer.resource), L"UploadQueueStaging");
+
+        // Write-only from the CPU, mapped for its whole life.
+        D3D12_RANGE readRange = { 0, 0 };
+        ThrowIfFailed(gResourceRegistry->Get(mStagingBuffer.resource)->Map(0, &readRange, reinterpret_cast<void**>(&mStagingBuffer.pMappedData)));
+
+        mStagingRing = std::make_unique<RingAllocator>(capacity);
+
+        mStats.stagingCapacity = capacity;
+    }
+
+    uint64_t UploadQueue::AllocateStaging(uint64_t size, uint64_t alignment)
+    {
+        uint64_t offset = mStagingRing->Allocate(size, alignment);
+
+        if (offset != RingAllocator::kInvalidOffset)
+            return offset;
+
+        Reclaim();
+
+        offset = mStagingRing->Allocate(size, alignment);
+
+        if (offset != RingAllocator::kInvalidOffset)
+            return offset;
+
+        // Grow. Copies recorded into the open batch still read from the current buffer, so it is retired with that batch.
+        uint64_t capacity = mStagingRing->GetCapacity() * 2u;
+
+        while (capacity < size)
+            capacity *= 2u;
+
+        mStagingBuffer.fenceValue = mStagingRing->HasPendingAllocations() ? kUntagged : mFenceValue;
+        mRetiredStagingBuffers.push_back(mStagingBuffer);
+
+        CreateStagingBuffer(capacity);
+
+        mStats.stagingGrowCount++;
+
+        spdlog::info("UploadQueue: Grew staging to {:.1f} MB for a {:.1f} MB upload.", capacity / (1024.0f * 1024.0f), size / (1024.0f * 1024.0f));
+
+        return mStagingRing->Allocate(size, alignment);
+    }
+
+    void UploadQueue::Reclaim()
+    {
+        const uint64_t completedFenceValue = mContexts->GetCompletedToken();
+
+        mStagingRing->Reclaim(completedFenceValue);
+
+        for (auto retired = mRetiredStagingBuffers.begin(); retired != mRetiredStagingBuffers.end();)
+        {
+            if (retired->fenceValue == kUntagged || retired->fenceValue > completedFenceValue)
+            {
+                retired++;
+                continue;
+            }
+
+            gResourceRegistry->Get(retired->resource)->Unmap(0, nullptr);
+            gResourceRegistry->Release(retired->resource);
+
+            retired = mRetiredStagingBuffers.erase(retired);
+        }
+    }
+
+    void UploadQueue::OpenBatch()
+    {
+        if (!mpCommandList)
+            mpCommandList = mContexts->Acquire();
+    }
+
+    void UploadQueue::Upload(ID3D12Resource*               pDestination,
+                             uint32_t                      firstSubresource,
+                             const D3D12_SUBRESOURCE_DATA* pSubresources,
+                             uint32_t                      subresourceCount)
+    {
+        if (subresourceCount == 0u)
+            return;
+
+        auto destinationDesc = pDestination->GetDesc();
+
+        // Staging layout: every subresource at a placement-aligned offset with its rows at a 256 byte aligned pitch.
+        std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> footprints(subresourceCount);
+        std::vector<UINT>                               rowCounts(subresourceCount);
+        std::vector<UINT64>                             rowSizes(subresourceCount);
+        UINT64                                          stagingSize = 0u;
+
+        gLogicalDevice->GetCopyableFootprints(&destinationDesc,
+                                              firstSubresource,
+                                              subresourceCount,
+                                              0u,
+                                              footprints.data(),
+                                              rowCounts.data(),
+                                              rowSizes.data(),
+                                              &stagingSize);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        const uint64_t stagingOffset = AllocateStaging(stagingSize, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+
+        OpenBatch();
+
+        auto* pStagingBuffer = gResourceRegistry->Get(mStagingBuffer.resource);
+
+        for (uint32_t subresourceIndex = 0u; subresourceIndex < subresourceCount; subresourceIndex++)
+        {
+            auto& footprint = footprints[subresourceIndex];
+            footprint.Offset += stagingOffset;
+
+            D3D12_MEMCPY_DEST copyDestination = {};
+            {
+                copyDestination.pData      = mStagingBuffer.pMappedData + footprint.Offset;
+                copyDestination.RowPitch   = footprint.Footprint.RowPitch;
+                copyDestination.SlicePitch = static_cast<SIZE_T>(footprint.Footprint.RowPitch) * rowCounts[subresourceIndex];
+            }
+
+            MemcpySubresource(&copyDestination,
+                              &pSubresources[subresourceIndex],
+                              static_cast<SIZE_T>(rowSizes[subresourceIndex]),
+                              rowCounts[subresourceIndex],
+                              footprint.Footprint.Depth);
+
+            if (destinationDesc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+                mpCommandList->CopyBufferRegion(pDestination, 0u, pStagingBuffer, footprint.Offset, footprint.Footprint.Width);
+            else
+            {
+                CD3DX12_TEXTURE_COPY_LOCATION copyDst(pDestination, firstSubresource + subresourceIndex);
+                CD3DX12_TEXTURE_COPY_LOCATION copySrc(pStagingBuffer, footprint);
+
+                mpCommandList->CopyTextureRegion(&copyDst, 0u, 0u, 0u, &copySrc, nullptr);
+            }
+        }
+
+        mStats.uploadCount++;
+        mStats.uploadBytes += stagingSize;
+    }
+
+    uint64_t UploadQueue::Flush()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        if (!mpCommandList)
+            return mFenceValue;
+
+        mFenceValue   = mContexts->Submit(mpCommandList);
+        mpCommandList = nullptr;
+
+        for (auto& retired : mRetiredStagingBuffers)
+        {
+            if (retired.fenceValue == kUntagged)
+                retired.fenceValue = mFenceValue;
+        }
+
+        mStagingRing->Submit(mFenceValue);
+
+        mStats.submissionCount++;
+
+        return mFenceValue;
+    }
+
+    void UploadQueue::Wait(uint64_t token)
+    {
+        if (mContexts->IsComplete(token))
+            return;
+
+        mContexts->Wait(token);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStats.waitCount++;
+    }
+
+    UploadQueue::Stats UploadQueue::GetStats()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        return mStats;
+    }
+} // namespace ICR
@@ -241,61 +241,139 @@ namespace ICR
         return true;
     }
 
-    void ExecuteCommandListAndWait(ID3D12Device*                                   pDevice,
-                                   ID3D12CommandQueue*                             pCommandQueue,
-                                   std::function<void(ID3D12GraphicsCommandList*)> recordCommandsFunc)
+    void LoadShaderByteCodes(std::unordered_map<std::string, ComPtr<ID3DBlob>>& shaderByteCodes)
+    {
+        for (auto& entry : std::filesystem::directory_iterator("Shaders\\"))
+        {
+            std::vector<uint8_t> shaderDXIL;
+            if (!ReadFileBytes(entry.path().string(), shaderDXIL))
+                throw std::runtime_error("Failed to load shader bytecode.");
+
+            auto& shaderByteCode = shaderByteCodes[entry.path().stem().string()];
+            ThrowIfFailed(D3DCreateBlob(shaderDXIL.size(), &shaderByteCode));
+            memcpy(shaderByteCode->GetBufferPointer(), shaderDXIL.data(), shaderDXIL.size());
+        }
+    }
+
+    // Half-float conversion.
+    // --------------------------------------------
+
+    static bool IsF16CSupported()
     {
-        // Create a command allocator
-        ComPtr<ID3D12CommandAllocator> commandAllocator;
-        ThrowIfFailed(pDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&commandAllocator)));
+        static const bool supported = []()
+        {
+            int cpuInfo[4];
+            __cpuid(cpuInfo, 1);
 
-        // Create a command list
-        ComPtr<ID3D12GraphicsCommandList> commandList;
-        ThrowIfFailed(pDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, commandAllocator.Get(), nullptr, IID_PPV_ARGS(&commandList)));
+            bool osxsave = (cpuInfo[2] & (1 << 27)) != 0;
+            bool avx     = (cpuInfo[2] & (1 << 28)) != 0;
+            bool f16c    = (cpuInfo[2] & (1 << 29)) != 0;
 
-        // Record commands
-        recordCommandsFunc(commandList.Get());
+            // The OS also needs to preserve the YMM registers.
+            return osxsave && avx && f16c && (_xgetbv(0) & 0x6) == 0x6;
+        }();
+
+        return supported;
+    }
 
-        // Close the command list
-        ThrowIfFailed(commandList->Close());
+    void ConvertFloatToHalfScalar(const float* pSrc, uint16_t* pDst, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+            pDst[i] = DirectX::PackedVector::XMConvertFloatToHalf(pSrc[i]);
+    }
 
-        // Execute the command list
-        ID3D12CommandList* ppCommandLists[] = { commandList.Get() };
-        pCommandQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
+    static void ConvertFloatToHalfF16C(const float* pSrc, uint16_t* pDst, size_t count)
+    {
+        size_t i = 0;
 
-        // Create a fence for synchronization
-        ComPtr<ID3D12Fence> fence;
-        ThrowIfFailed(pDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence)));
-        HANDLE fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-        if (fenceEvent == nullptr)
+        // 8 floats per iteration.
+        for (; i + 8 <= count; i += 8)
         {
-            ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+            __m256  values = _mm256_loadu_ps(pSrc + i);
+            __m128i halves = _mm256_cvtps_ph(values, _MM_FROUND_TO_NEAREST_INT);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), halves);
         }
 
-        // Signal and wait for the fence
-        const UINT64 fenceValue = 1;
-        ThrowIfFailed(pCommandQueue->Signal(fence.Get(), fenceValue));
-        if (fence->GetCompletedValue() < fenceValue)
+        ConvertFloatToHalfScalar(pSrc + i, pDst + i, count - i);
+    }
+
+    // Below this it isn't worth waking up worker threads.
+    constexpr size_t kFloatToHalfGrainSize = 64u * 1024u;
+
+    void ConvertFloatToHalf(const float* pSrc, uint16_t* pDst, size_t count)
+    {
+        auto ConvertRange = IsF16CSupported() ? ConvertFloatToHalfF16C : ConvertFloatToHalfScalar;
+
+        if (count <= kFloatToHalfGrainSize)
         {
-            ThrowIfFailed(fence->SetEventOnCompletion(fenceValue, fenceEvent));
-            WaitForSingleObject(fenceEvent, INFINITE);
+            ConvertRange(pSrc, pDst, count);
+            return;
         }
 
-        CloseHandle(fenceEvent);
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, count, kFloatToHalfGrainSize),
+                          [&](const tbb::blocked_range<size_t>& range) { ConvertRange(pSrc + range.begin(), pDst + range.begin(), range.size()); });
     }
 
-    void LoadShaderByteCodes(std::unordered_map<std::string, ComPtr<ID3DBlob>>& shaderByteCodes)
+    void BenchmarkFloatToHalf(size_t count)
     {
-        for (auto& entry : std::filesystem::directory_iterator("Shaders\\"))
+        std::vector<float> src(count);
+
+        // Mix of normals, denormals, large values and signs that show up in HDR images.
+        std::mt19937                          generator(1337u);
+        std::uniform_real_distribution<float> exponentDistribution(-24.0f, 16.0f);
+
+        for (auto& value : src)
+            value = std::exp2(exponentDistribution(generator)) * ((generator() & 1u) ? 1.0f : -1.0f);
+
+        std::vector<uint16_t> reference(count);
+        std::vector<uint16_t> result(count);
+
+        auto Time = [](auto&& func)
         {
-            std::vector<uint8_t> shaderDXIL;
-            if (!ReadFileBytes(entry.path().string(), shaderDXIL))
-                throw std::runtime_error("Failed to load shader bytecode.");
+            constexpr int kIterations = 8;
 
-            auto& shaderByteCode = shaderByteCodes[entry.path().stem().string()];
-            ThrowIfFailed(D3DCreateBlob(shaderDXIL.size(), &shaderByteCode));
-            memcpy(shaderByteCode->GetBufferPointer(), shaderDXIL.data(), shaderDXIL.size());
+            // Warm up caches and the thread pool.
+            func();
+
+            auto start = std::chrono::steady_clock::now();
+
+            for (int i = 0; i < kIterations; i++)
+                func();
+
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / kIterations;
+        };
+
+        double scalarMs = Time([&]() { ConvertFloatToHalfScalar(src.data(), reference.data(), count); });
+
+        spdlog::info("Float -> Half ({} values): Scalar {:.3f} ms", count, scalarMs);
+
+        if (IsF16CSupported())
+        {
+            double simdMs = Time([&]() { ConvertFloatToHalfF16C(src.data(), result.data(), count); });
+
+            spdlog::info("Float -> Half ({} values): F16C {:.3f} ms ({:.1f}x)", count, simdMs, scalarMs / simdMs);
+        }
+        else
+        {
+            spdlog::info("Float -> Half: F16C not supported on this CPU.");
         }
+
+        double parallelMs = Time([&]() { ConvertFloatToHalf(src.data(), result.data(), count); });
+
+        spdlog::info("Float -> Half ({} values): Parallel {:.3f} ms ({:.1f}x)", count, parallelMs, scalarMs / parallelMs);
+
+        // Both paths round to nearest, but allow a 1 ULP difference in case the reference rounds ties differently.
+        size_t mismatches = 0;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            if (std::abs(static_cast<int>(result[i]) - static_cast<int>(reference[i])) > 1)
+                mismatches++;
+        }
+
+        if (mismatches != 0)
+            spdlog::error("Float -> Half: {} values differ from the scalar reference.", mismatches);
     }
 
 } // namespace ICR
@@ -0,0 +1,71 @@
+#include <VideoDecoderImageSequence.h>
+
+namespace ICR
+{
+    VideoDecoderImageSequence::VideoDecoderImageSequence(double frameRate) : mFrameIndex(0), mFrameRate(frameRate), mWidth(0), mHeight(0) {}
+
+    bool VideoDecoderImageSequence::Open(const std::string& path)
+    {
+        mFramePaths.clear();
+        mFrameIndex = 0;
+
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(path, error))
+        {
+            if (entry.is_regular_file())
+                mFramePaths.push_back(entry.path());
+        }
+
+        if (mFramePaths.empty())
+            return false;
+
+        std::sort(mFramePaths.begin(), mFramePaths.end());
+
+        // The first frame defines the size of the stream.
+        int channels;
+        if (!stbi_info(mFramePaths[0].string().c_str(), &mWidth, &mHeight, &channels))
+        {
+            spdlog::error("VideoDecoderImageSequence: Failed to read {}.", mFramePaths[0].string());
+            return false;
+        }
+
+        return true;
+    }
+
+    bool VideoDecoderImageSequence::DecodeFrame(uint8_t* pDst, uint32_t rowPitch, double& timestamp)
+    {
+        while (mFrameIndex < mFramePaths.size())
+        {
+            auto frameIndex = mFrameIndex++;
+
+            // Thread-local variant since the media cache decodes on another thread.
+            stbi_set_flip_vertically_on_load_thread(true);
+
+            int  width, height, channels;
+            auto pImage = stbi_load(mFramePaths[frameIndex].string().c_str(), &width, &height, &channels, STBI_rgb_alpha);
+
+            if (!pImage)
+                continue;
+
+            // Skip frames that don't match the stream size rather than resizing the channel mid-stream.
+            if (width != mWidth || height != mHeight)
+            {
+                stbi_image_free(pImage);
+                continue;
+            }
+
+            for (int row = 0; row < height; row++)
+                memcpy(pDst + static_cast<size_t>(row) * rowPitch, pImage + static_cast<size_t>(row) * width * 4, static_cast<size_t>(width) * 4);
+
+            stbi_image_free(pImage);
+
+            timestamp = frameIndex / mFrameRate;
+
+            return true;
+        }
+
+        return false;
+    }
+
+    void VideoDecoderImageSequence::Rewind() { mFrameIndex = 0; }
+} // namespace ICR
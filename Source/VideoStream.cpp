@@ -0,0 +1,239 @@
+#include <VideoStream.h>
+#include <VideoDecoderImageSequence.h>
+#include <ResourceRegistry.h>
+#include <State.h>
+
+namespace ICR
+{
+    std::unique_ptr<VideoDecoder> CreateVideoDecoder(const std::string& path)
+    {
+        std::unique_ptr<VideoDecoder> decoder;
+
+        // Only image sequences for now; container formats plug in here.
+        if (std::filesystem::is_directory(path))
+            decoder = std::make_unique<VideoDecoderImageSequence>();
+
+        if (!decoder || !decoder->Open(path))
+            return nullptr;
+
+        return decoder;
+    }
+
+    VideoStream::VideoStream(std::unique_ptr<VideoDecoder> decoder) :
+        mDecoder(std::move(decoder)),
+        mStopDecoding(false),
+        mTextureState(D3D12_RESOURCE_STATE_COMMON),
+        mpUploadData(nullptr),
+        mStartTime(0.0f),
+        mStarted(false),
+        mCurrentTimestamp(0.0),
+        mCurrentPresentationTime(0.0),
+        mPresentedFrames(0u),
+        mDroppedFrames(0u),
+        mLateFrames(0u)
+    {
+        auto textureInfo = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R8G8B8A8_UNORM, mDecoder->GetWidth(), mDecoder->GetHeight(), 1, 1);
+
+        mTexture = gResourceRegistry->Create(textureInfo, 0x0, false, ResourceRegistry::MemoryCategory::Media);
+
+        SetDebugName(gResourceRegistry->Get(mTexture), L"VideoStreamTexture");
+
+        // One upload slot per ring entry, each laid out to be directly copyable into the texture.
+        gLogicalDevice->GetCopyableFootprints(&textureInfo, 0, 1, 0, &mSlotFootprint, nullptr, nullptr, &mSlotSize);
+
+        mSlotSize = (mSlotSize + D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1) & ~static_cast<uint64_t>(D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1);
+
+        mUploadBuffer =
+            gResourceRegistry->Create(CD3DX12_RESOURCE_DESC::Buffer(mSlotSize * kRingSize), 0x0, true, ResourceRegistry::MemoryCategory::Staging);
+
+        // Persistently mapped, the decode thread writes straight into it.
+        D3D12_RANGE readRange = { 0, 0 };
+        ThrowIfFailed(gResourceRegistry->Get(mUploadBuffer)->Map(0, &readRange, reinterpret_cast<void**>(&mpUploadData)));
+
+        mDecodeThread = std::thread([this]() { DecodeThread(); });
+    }
+
+    VideoStream::~VideoStream()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStopDecoding.store(true);
+        }
+
+        mSlotFreed.notify_all();
+        mDecodeThread.join();
+
+        gResourceRegistry->Get(mUploadBuffer)->Unmap(0, nullptr);
+        gResourceRegistry->Release(mUploadBuffer);
+        gResourceRegistry->Release(mTexture);
+    }
+
+    void VideoStream::DecodeThread()
+    {
+        // Offset applied to the stream timestamps each time the decoder loops.
+        double loopOffset = 0.0;
+
+        while (!mStopDecoding.load())
+        {
+            uint32_t slotIndex = 0u;
+
+            // Wait for the render thread to hand back a slot.
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+
+                auto IsSlotFree = [](const Slot& slot) { return slot.state == Slot::State::Free; };
+
+                mSlotFreed.wait(lock, [&]() { return mStopDecoding.load() || std::any_of(mSlots.begin(), mSlots.end(), IsSlotFree); });
+
+                if (mStopDecoding.load())
+                    return;
+
+                while (mSlots[slotIndex].state != Slot::State::Free)
+                    slotIndex++;
+
+                mSlots[slotIndex].state = Slot::State::Decoding;
+            }
+
+            auto* pSlotData = mpUploadData + slotIndex * mSlotSize;
+            auto  rowPitch  = mSlotFootprint.Footprint.RowPitch;
+
+            double timestamp = 0.0;
+            bool   decoded   = mDecoder->DecodeFrame(pSlotData, rowPitch, timestamp);
+
+            if (!decoded)
+            {
+                // End of stream, loop back to the start.
+                loopOffset += mDecoder->GetDuration();
+
+                mDecoder->Rewind();
+
+                decoded = mDecoder->DecodeFrame(pSlotData, rowPitch, timestamp);
+            }
+
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            if (!decoded)
+            {
+                spdlog::error("VideoStream: Decoder failed to produce any frame, stopping.");
+
+                mSlots[slotIndex].state = Slot::State::Free;
+                return;
+            }
+
+            mSlots[slotIndex].timestamp        = timestamp;
+            mSlots[slotIndex].presentationTime = loopOffset + timestamp;
+            mSlots[slotIndex].state            = Slot::State::Ready;
+        }
+    }
+
+    void VideoStream::Update(float playbackTime, ID3D12GraphicsCommandList* pCmd)
+    {
+        if (!mStarted)
+        {
+            mStartTime = playbackTime;
+            mStarted   = true;
+        }
+
+        double localTime = static_cast<double>(playbackTime) - mStartTime;
+
+        Slot* pDueSlot  = nullptr;
+        int   slotIndex = -1;
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            bool slotFreed = false;
+
+            // Reclaim slots whose upload has completed on the GPU.
+            auto completedFenceValue = gFence->GetCompletedValue();
+
+            for (auto& slot : mSlots)
+            {
+                if (slot.state == Slot::State::InFlight && slot.fenceValue <= completedFenceValue)
+                {
+                    slot.state = Slot::State::Free;
+                    slotFreed  = true;
+                }
+            }
+
+            // Newest frame that is due at the current playback time.
+            for (int i = 0; i < static_cast<int>(kRingSize); i++)
+            {
+                if (mSlots[i].state != Slot::State::Ready || mSlots[i].presentationTime > localTime)
+                    continue;
+
+                if (pDueSlot == nullptr || mSlots[i].presentationTime > pDueSlot->presentationTime)
+                {
+                    pDueSlot  = &mSlots[i];
+                    slotIndex = i;
+                }
+            }
+
+            // Any other due frame was superseded before it could be shown.
+            for (auto& slot : mSlots)
+            {
+                if (&slot == pDueSlot || slot.state != Slot::State::Ready || slot.presentationTime > localTime)
+                    continue;
+
+                slot.state = Slot::State::Free;
+                slotFreed  = true;
+
+                mDroppedFrames++;
+            }
+
+            if (pDueSlot)
+            {
+                // The slot is free again once this frame's fence value has been signaled.
+                pDueSlot->state      = Slot::State::InFlight;
+                pDueSlot->fenceValue = gFenceValue;
+
+                mCurrentTimestamp        = pDueSlot->timestamp;
+                mCurrentPresentationTime = pDueSlot->presentationTime;
+
+                mPresentedFrames++;
+            }
+            else if (mPresentedFrames > 0u && localTime - mCurrentPresentationTime > 2.0 / mDecoder->GetFrameRate())
+            {
+                // The decoder is behind playback, keep showing the previous frame.
+                mLateFrames++;
+            }
+
+            if (slotFreed)
+                mSlotFreed.notify_one();
+        }
+
+        if (!pDueSlot)
+            return;
+
+        // Record the upload.
+        // ------------------------------
+
+        auto* pTexture = gResourceRegistry->Get(mTexture);
+
+        if (mTextureState != D3D12_RESOURCE_STATE_COPY_DEST)
+        {
+            auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(pTexture, mTextureState, D3D12_RESOURCE_STATE_COPY_DEST);
+            pCmd->ResourceBarrier(1, &barrier);
+        }
+
+        D3D12_PLACED_SUBRESOURCE_FOOTPRINT slotFootprint = mSlotFootprint;
+        slotFootprint.Offset                             = slotIndex * mSlotSize;
+
+        CD3DX12_TEXTURE_COPY_LOCATION copyDst(pTexture, 0);
+        CD3DX12_TEXTURE_COPY_LOCATION copySrc(gResourceRegistry->Get(mUploadBuffer), slotFootprint);
+
+        pCmd->CopyTextureRegion(&copyDst, 0, 0, 0, &copySrc, nullptr);
+
+        auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(pTexture, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+        pCmd->ResourceBarrier(1, &barrier);
+
+        mTextureState = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+    }
+
+    VideoStream::Stats VideoStream::GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        return { mPresentedFrames, mDroppedFrames, mLateFrames };
+    }
+} // namespace ICR